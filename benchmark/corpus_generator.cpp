@@ -0,0 +1,237 @@
+#include "corpus_generator.hpp"
+#include <array>
+#include <common/common.hpp>
+#include <random>
+#include <vector>
+
+using namespace std::string_view_literals;
+
+// Used for the contents of comments and strings.
+static constexpr auto words = std::array{
+    "the"sv, "value"sv, "of"sv, "a"sv, "record"sv, "is"sv, "computed"sv, "once"sv, "before"sv, "loop"sv, "starts"sv,
+    "note"sv, "that"sv, "this"sv, "must"sv, "not"sv, "change"sv, "while"sv, "index"sv, "counter"sv, "buffer"sv,
+    "holds"sv, "42"sv, "items,"sv, "see"sv, "below."sv, "todo:"sv, "remove"sv, "after"sv, "release"sv, "Hello,"sv,
+    "World!"sv,
+};
+
+static constexpr auto operators = std::array{
+    "+"sv, "-"sv, "*"sv, "/"sv, "div"sv, "mod"sv, "and"sv, "or"sv, "<"sv, "<="sv, "="sv, "<>"sv, ">="sv, ">"sv,
+};
+
+class Generator final {
+private:
+    std::mt19937_64 m_random;  // The output of the engines is fully specified, unlike the distributions.
+    CorpusKind m_kind;
+    std::string& m_output;
+    std::vector<std::string> m_identifiers;
+
+public:
+    Generator(CorpusKind const kind, u64 const seed, std::string& output)
+        : m_random{ seed },
+          m_kind{ kind },
+          m_output{ output } {
+        static constexpr auto num_identifiers = usize{ 512 };
+        static constexpr auto letters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"sv;
+        static constexpr auto letters_and_digits = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"sv;
+        m_identifiers.reserve(num_identifiers);
+        for (auto i = usize{ 0 }; i < num_identifiers; ++i) {
+            // Mostly short names, but some that are long enough for the vectorized scanners.
+            auto const length = chance(10) ? 16 + uniform(24) : 1 + uniform(12);
+            auto identifier = std::string{ letters.at(uniform(letters.size())) };
+            while (identifier.size() < length) {
+                identifier += letters_and_digits.at(uniform(letters_and_digits.size()));
+            }
+            m_identifiers.push_back(std::move(identifier));
+        }
+    }
+
+    void line() {
+        switch (m_kind) {
+            case CorpusKind::Mixed:
+                if (chance(15)) {
+                    comment();
+                } else if (chance(15)) {
+                    write_statement();
+                } else {
+                    assignment();
+                }
+                break;
+            case CorpusKind::CommentHeavy:
+                if (chance(75)) {
+                    comment();
+                } else {
+                    assignment();
+                }
+                break;
+            case CorpusKind::IdentifierHeavy:
+            case CorpusKind::NumberHeavy:
+                assignment();
+                break;
+            case CorpusKind::StringHeavy:
+                write_statement();
+                break;
+        }
+        m_output += '\n';
+    }
+
+private:
+    [[nodiscard]] usize uniform(usize const bound) {
+        return m_random() % bound;
+    }
+
+    [[nodiscard]] bool chance(usize const percent) {
+        return uniform(100) < percent;
+    }
+
+    void indentation() {
+        m_output.append(4 * (1 + uniform(3)), ' ');
+    }
+
+    void identifier() {
+        m_output += m_identifiers.at(uniform(m_identifiers.size()));
+    }
+
+    void digits(usize const count) {
+        for (auto i = usize{ 0 }; i < count; ++i) {
+            m_output += static_cast<char>('0' + uniform(10));
+        }
+    }
+
+    void integer() {
+        digits(1 + uniform(9));
+    }
+
+    void real() {
+        digits(1 + uniform(5));
+        m_output += '.';
+        digits(1 + uniform(6));
+        if (chance(40)) {
+            m_output += 'E';
+            if (chance(50)) {
+                m_output += chance(50) ? '+' : '-';
+            }
+            digits(1 + uniform(2));
+        }
+    }
+
+    void number() {
+        if (chance(50)) {
+            integer();
+        } else {
+            real();
+        }
+    }
+
+    // Never generates the empty string `''`, which is not a valid character string.
+    void string() {
+        m_output += '\'';
+        m_output += words.at(uniform(words.size()));
+        for (auto num_words = uniform(6); num_words > 0; --num_words) {
+            m_output += chance(10) ? "''"sv : " "sv;
+            m_output += words.at(uniform(words.size()));
+        }
+        m_output += '\'';
+    }
+
+    void comment() {
+        auto const braces = chance(50);
+        m_output += braces ? "{"sv : "(*"sv;
+        for (auto num_lines = 1 + uniform(6); num_lines > 0; --num_lines) {
+            for (auto num_words = 4 + uniform(9); num_words > 0; --num_words) {
+                m_output += ' ';
+                m_output += words.at(uniform(words.size()));
+            }
+            if (num_lines > 1) {
+                m_output += '\n';
+                indentation();
+            }
+        }
+        m_output += braces ? " }"sv : " *)"sv;
+    }
+
+    void operand() {
+        switch (m_kind) {
+            case CorpusKind::IdentifierHeavy:
+                identifier();
+                if (chance(20)) {
+                    m_output += '.';
+                    identifier();
+                } else if (chance(10)) {
+                    m_output += '^';
+                }
+                break;
+            case CorpusKind::NumberHeavy:
+                number();
+                break;
+            case CorpusKind::StringHeavy:
+                string();
+                break;
+            case CorpusKind::Mixed:
+            case CorpusKind::CommentHeavy:
+                if (chance(60)) {
+                    identifier();
+                } else if (chance(85)) {
+                    number();
+                } else {
+                    string();
+                }
+                break;
+        }
+    }
+
+    void assignment() {
+        indentation();
+        identifier();
+        if (m_kind == CorpusKind::NumberHeavy) {
+            m_output += '[';
+            integer();
+            m_output += ']';
+        }
+        m_output += " := "sv;
+        operand();
+        for (auto num_operations = uniform(5); num_operations > 0; --num_operations) {
+            m_output += ' ';
+            m_output += operators.at(uniform(operators.size()));
+            m_output += ' ';
+            operand();
+        }
+        m_output += ';';
+    }
+
+    void write_statement() {
+        indentation();
+        m_output += "writeln("sv;
+        string();
+        for (auto num_arguments = uniform(4); num_arguments > 0; --num_arguments) {
+            m_output += ", "sv;
+            string();
+        }
+        m_output += ");"sv;
+    }
+};
+
+[[nodiscard]] std::string_view to_string(CorpusKind const kind) {
+    switch (kind) {
+        case CorpusKind::Mixed:
+            return "mixed";
+        case CorpusKind::CommentHeavy:
+            return "comment-heavy";
+        case CorpusKind::IdentifierHeavy:
+            return "identifier-heavy";
+        case CorpusKind::NumberHeavy:
+            return "number-heavy";
+        case CorpusKind::StringHeavy:
+            return "string-heavy";
+    }
+    throw_or_abort(InternalCompilerError{ "Unknown corpus kind." });
+}
+
+[[nodiscard]] std::string generate_corpus(CorpusKind const kind, usize const size, u64 const seed) {
+    auto result = std::string{};
+    result.reserve(size + 1024);
+    auto generator = Generator{ kind, seed, result };
+    while (result.size() < size) {
+        generator.line();
+    }
+    return result;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <lib2k/types.hpp>
+#include <string>
+#include <string_view>
+
+// Determines which kind of tokens dominate a generated corpus.
+enum class CorpusKind {
+    Mixed,
+    CommentHeavy,
+    IdentifierHeavy,
+    NumberHeavy,
+    StringHeavy,
+};
+
+inline constexpr auto num_corpus_kinds = 5;
+
+[[nodiscard]] std::string_view to_string(CorpusKind kind);
+
+// Generates Pascal source code of at least `size` bytes that lexes without errors. It ends with the first line break
+// after `size` bytes. The result only depends on the arguments, so it is the same across platforms and standard
+// libraries.
+[[nodiscard]] std::string generate_corpus(CorpusKind kind, usize size, u64 seed = 42);
@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+#include <lexer/keywords.hpp>
+#include <string>
+#include <vector>
+
+// The word classification the lexer used before the perfect hash was introduced. It is kept here as the baseline.
+[[nodiscard]] static TokenType classify_word_linear(std::string_view const lexeme) {
+    for (auto const& [spelling, type] : detail::word_symbols) {
+        if (equals_case_insensitive(lexeme, spelling)) {
+            return type;
+        }
+    }
+    return TokenType::Identifier;
+}
+
+[[nodiscard]] static std::vector<std::string> keywords() {
+    auto result = std::vector<std::string>{};
+    for (auto const& [spelling, type] : detail::word_symbols) {
+        auto lowercase = std::string{ spelling };
+        auto uppercase = lowercase;
+        auto mixed_case = lowercase;
+        for (auto i = usize{ 0 }; i < lowercase.length(); ++i) {
+            uppercase.at(i) = static_cast<char>(std::toupper(static_cast<unsigned char>(uppercase.at(i))));
+            if (i % 2 == 0) {
+                mixed_case.at(i) = uppercase.at(i);
+            }
+        }
+        result.push_back(std::move(lowercase));
+        result.push_back(std::move(uppercase));
+        result.push_back(std::move(mixed_case));
+    }
+    return result;
+}
+
+[[nodiscard]] static std::vector<std::string> identifiers() {
+    return {
+        "i", "j", "x", "n", "count", "index", "value", "result", "Buffer", "MaxSize", "TPerson", "PInteger",
+        "isCool", "myRecord", "ands", "arrays", "beginning", "ending", "fore", "integers", "realm", "charset",
+        "Colors", "Range1", "Array2", "setTest", "scientificValue", "clausKleber", "WG4", "readinteger",
+        "AlterHeatSetting", "InquireWorkstationTransformation",
+    };
+}
+
+template<typename Classify>
+static void classify(benchmark::State& state, std::vector<std::string> const& words, Classify const& classifier) {
+    for (auto _ : state) {
+        for (auto const& word : words) {
+            benchmark::DoNotOptimize(classifier(word));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<benchmark::IterationCount>(words.size()));
+}
+
+static void BM_ClassifyKeywords_Linear(benchmark::State& state) {
+    classify(state, keywords(), classify_word_linear);
+}
+
+static void BM_ClassifyKeywords_PerfectHash(benchmark::State& state) {
+    classify(state, keywords(), classify_word);
+}
+
+static void BM_ClassifyIdentifiers_Linear(benchmark::State& state) {
+    classify(state, identifiers(), classify_word_linear);
+}
+
+static void BM_ClassifyIdentifiers_PerfectHash(benchmark::State& state) {
+    classify(state, identifiers(), classify_word);
+}
+
+BENCHMARK(BM_ClassifyKeywords_Linear);
+BENCHMARK(BM_ClassifyKeywords_PerfectHash);
+BENCHMARK(BM_ClassifyIdentifiers_Linear);
+BENCHMARK(BM_ClassifyIdentifiers_PerfectHash);
@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+#include <lexer/lexer.hpp>
+#include <string>
+#include <string_view>
+#include "corpus_generator.hpp"
+
+// Benchmarks that take a corpus use the arguments `(kind, size)`, where `kind` is a `CorpusKind`.
+static constexpr auto min_corpus_size = i64{ 1 } << 10;
+static constexpr auto max_corpus_size = i64{ 1 } << 28;
+
+[[nodiscard]] static std::string make_corpus(benchmark::State& state) {
+    auto const kind = static_cast<CorpusKind>(state.range(0));
+    state.SetLabel(std::string{ to_string(kind) });
+    return generate_corpus(kind, static_cast<usize>(state.range(1)));
+}
+
+static void set_counters(benchmark::State& state, std::string_view const source, usize const num_tokens) {
+    state.SetBytesProcessed(state.iterations() * static_cast<benchmark::IterationCount>(source.size()));
+    state.counters["tokens_per_second"] =
+        benchmark::Counter{ static_cast<double>(num_tokens), benchmark::Counter::kIsIterationInvariantRate };
+}
+
+static void BM_Tokenize(benchmark::State& state) {
+    auto const source = make_corpus(state);
+    auto num_tokens = usize{ 0 };
+    for (auto _ : state) {
+        auto const tokens = tokenize("benchmark.pas", source);
+        num_tokens = tokens.size();
+        benchmark::DoNotOptimize(tokens.types().data());
+    }
+    set_counters(state, source, num_tokens);
+}
+
+static void BM_TokenStream(benchmark::State& state) {
+    auto const source = make_corpus(state);
+    auto num_tokens = usize{ 0 };
+    for (auto _ : state) {
+        auto stream = TokenStream{ "benchmark.pas", source };
+        num_tokens = 1;
+        while (stream.peek().type() != TokenType::EndOfFile) {
+            stream.advance();
+            ++num_tokens;
+        }
+    }
+    set_counters(state, source, num_tokens);
+}
+
+// Uses the arguments `(size, num_threads)`.
+static void BM_TokenizeParallel(benchmark::State& state) {
+    auto const source = generate_corpus(CorpusKind::Mixed, static_cast<usize>(state.range(0)));
+    auto const file = std::make_shared<SourceFile const>("benchmark.pas", source);
+    auto const options = ParallelLexingOptions{ static_cast<usize>(state.range(1)), usize{ 1 } << 16 };
+    auto num_tokens = usize{ 0 };
+    for (auto _ : state) {
+        auto const tokens = tokenize_parallel(file, std::make_shared<Interner>(), options);
+        num_tokens = tokens.size();
+        benchmark::DoNotOptimize(tokens.types().data());
+    }
+    set_counters(state, source, num_tokens);
+}
+
+// Models a keystroke in the middle of the file: A line is inserted, which leaves all other tokens unchanged.
+static void BM_Relex(benchmark::State& state) {
+    auto const source = generate_corpus(CorpusKind::Mixed, static_cast<usize>(state.range(0)));
+    auto const previous = tokenize(std::make_shared<SourceFile const>("benchmark.pas", source));
+    auto const edit = SourceEdit{ source.find('\n', source.size() / 2) + 1, 0, "    x := 1;\n" };
+    for (auto _ : state) {
+        auto const tokens = relex(previous, edit);
+        benchmark::DoNotOptimize(tokens.types().data());
+    }
+}
+
+BENCHMARK(BM_Tokenize)->ArgsProduct({
+    benchmark::CreateDenseRange(0, num_corpus_kinds - 1, 1),
+    benchmark::CreateRange(min_corpus_size, max_corpus_size, 16),
+});
+BENCHMARK(BM_TokenStream)->ArgsProduct({
+    benchmark::CreateDenseRange(0, num_corpus_kinds - 1, 1),
+    benchmark::CreateRange(min_corpus_size, max_corpus_size, 16),
+});
+BENCHMARK(BM_TokenizeParallel)->ArgsProduct({ { 1 << 20, 1 << 26 }, { 1, 2, 4, 8 } })->UseRealTime();
+BENCHMARK(BM_Relex)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+#include <format>
+#include <lexer/lexer.hpp>
+#include <parser/parser.hpp>
+#include <profiling/allocation_counter.hpp>
+#include <string>
+
+// Generates a program of at least `size` bytes that parses without errors. Every type definition enters the scopes
+// of the parser that record notes.
+[[nodiscard]] static std::string generate_program(usize const size) {
+    auto constants = std::string{ "const\n" };
+    auto types = std::string{ "type\n" };
+    auto variables = std::string{ "var\n" };
+    for (auto i = usize{ 0 }; constants.size() + types.size() + variables.size() < size; ++i) {
+        constants += std::format("    c{} = -{}; s{} = 'text'; r{} = +{}.5;\n", i, i, i, i, i);
+        types += std::format(
+            "    e{} = (red{}, green{}); a{} = packed array [1..c{}, boolean] of set of e{};\n"
+            "    p{} = record x, y: integer; case tag: e{} of red{}: (z: ^p{}); green{}: () end;\n",
+            i, i, i, i, i, i, i, i, i, i, i
+        );
+        variables += std::format("    v{}, w{}: a{}; f{}: file of p{};\n", i, i, i, i, i);
+    }
+    return constants + types + variables;
+}
+
+static void set_counters(benchmark::State& state, std::string_view const source, u64 const allocations) {
+    state.SetBytesProcessed(state.iterations() * static_cast<benchmark::IterationCount>(source.size()));
+    state.counters["allocations"] = benchmark::Counter{
+        static_cast<double>(allocations),
+        benchmark::Counter::kAvgIterations,
+    };
+}
+
+// Parses tokens that have been lexed beforehand, so that only the parser is measured.
+template<typename Parse>
+static void parse_benchmark(benchmark::State& state, Parse const& parse) {
+    auto const source = generate_program(static_cast<usize>(state.range(0)));
+    auto const file = std::make_shared<SourceFile const>("benchmark.pas", source);
+    auto allocations = u64{ 0 };
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tokens = tokenize(file);
+        state.ResumeTiming();
+        auto const before = allocation_counts().num_allocations;
+        auto const ast = parse(std::move(tokens));
+        allocations += allocation_counts().num_allocations - before;
+        benchmark::DoNotOptimize(&ast);
+    }
+    set_counters(state, source, allocations);
+}
+
+static void BM_Parse(benchmark::State& state) {
+    parse_benchmark(state, [](TokenBuffer&& tokens) { return parse(std::move(tokens)); });
+}
+
+static void BM_ParseFlat(benchmark::State& state) {
+    parse_benchmark(state, [](TokenBuffer&& tokens) { return parse_flat(std::move(tokens)); });
+}
+
+// Measures the overhead of error recovery on a program without errors.
+static void BM_ParseWithRecovery(benchmark::State& state) {
+    parse_benchmark(state, [](TokenBuffer&& tokens) {
+        auto diagnostics = Diagnostics{};
+        return parse_with_recovery(diagnostics, std::move(tokens));
+    });
+}
+
+BENCHMARK(BM_Parse)->RangeMultiplier(16)->Range(1 << 10, 1 << 26);
+BENCHMARK(BM_ParseFlat)->RangeMultiplier(16)->Range(1 << 10, 1 << 26);
+BENCHMARK(BM_ParseWithRecovery)->RangeMultiplier(16)->Range(1 << 10, 1 << 26);
@@ -22,11 +22,15 @@ if (PROJECT_IS_TOP_LEVEL)
     option(pasc2k_enable_undefined_behavior_sanitizer "Enable undefined behavior sanitizer" ${supports_ubsan})
     option(pasc2k_enable_address_sanitizer "Enable address sanitizer" ${supports_asan})
     option(pasc2k_build_tests "Build unit tests" ON)
+    option(pasc2k_build_benchmarks "Build benchmarks" OFF)
+    option(pasc2k_enable_exceptions "Enable C++ exceptions (the try_ functions work without them)" ON)
 else ()
     option(pasc2k_warnings_as_errors "Treat warnings as errors" OFF)
     option(pasc2k_enable_undefined_behavior_sanitizer "Enable undefined behavior sanitizer" OFF)
     option(pasc2k_enable_address_sanitizer "Enable address sanitizer" OFF)
     option(pasc2k_build_tests "Build unit tests" OFF)
+    option(pasc2k_build_benchmarks "Build benchmarks" OFF)
+    option(pasc2k_enable_exceptions "Enable C++ exceptions (the try_ functions work without them)" ON)
 endif ()
 
 add_library(pasc2k_warnings INTERFACE)
@@ -35,8 +39,19 @@ pasc2k_set_warnings(pasc2k_warnings ${pasc2k_warnings_as_errors})
 add_library(pasc2k_sanitizers INTERFACE)
 pasc2k_enable_sanitizers(pasc2k_sanitizers ${pasc2k_enable_address_sanitizer} ${pasc2k_enable_undefined_behavior_sanitizer})
 
+add_library(pasc2k_exceptions INTERFACE)
+if (NOT ${pasc2k_enable_exceptions})
+    if (MSVC)
+        target_compile_options(pasc2k_exceptions INTERFACE /EHs-c-)
+        target_compile_definitions(pasc2k_exceptions INTERFACE _HAS_EXCEPTIONS=0)
+    else ()
+        target_compile_options(pasc2k_exceptions INTERFACE -fno-exceptions)
+    endif ()
+endif ()
+
 add_library(pasc2k_project_options INTERFACE)
 target_link_libraries(pasc2k_project_options
         INTERFACE pasc2k_warnings
         INTERFACE pasc2k_sanitizers
+        INTERFACE pasc2k_exceptions
 )
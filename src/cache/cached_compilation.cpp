@@ -0,0 +1,59 @@
+#include <cache/cached_compilation.hpp>
+#include <common/common.hpp>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+void store_compilation(CompilationCache& cache, Hash128 const key, CachedCompilation const& compilation) {
+    if (compilation.ast.has_value()) {
+        cache.store(key, "ast", [&](DumpSink& sink) { compilation.ast->save(sink); });
+    }
+    // The result is stored last, since the entry is incomplete without it.
+    cache.store(key, "result", [&](DumpSink& sink) {
+        sink.write(std::format("{}\n{}\n", compilation.exit_code, compilation.ast.has_value() ? 1 : 0));
+        sink.write(compilation.diagnostics);
+    });
+}
+
+std::optional<CachedCompilation> load_compilation(CompilationCache& cache, Hash128 const key) {
+    auto const result_path = cache.find(key, "result");
+    if (not result_path.has_value()) {
+        return std::nullopt;
+    }
+    auto const discard = [&] {
+        cache.remove(key, "result");
+        cache.remove(key, "ast");
+        return std::nullopt;
+    };
+
+    auto compilation = CachedCompilation{};
+    auto result = std::ifstream{ *result_path, std::ios::binary };
+    auto has_ast = false;
+    if (not (result >> compilation.exit_code >> has_ast) or result.get() != '\n') {
+        return discard();
+    }
+    compilation.diagnostics = std::string{ std::istreambuf_iterator<char>{ result }, std::istreambuf_iterator<char>{} };
+    if (result.bad()) {
+        return discard();
+    }
+    if (not has_ast) {
+        return compilation;
+    }
+
+    // The AST may also be missing if another compilation is just removing the entry to make room.
+    auto const ast_path = cache.find(key, "ast");
+    if (not ast_path.has_value()) {
+        return discard();
+    }
+#if PASC2K_EXCEPTIONS
+    try {
+        compilation.ast = FlatAst::load(*ast_path);
+    } catch (std::runtime_error const&) {
+        return discard();
+    }
+#else
+    compilation.ast = FlatAst::load(*ast_path);
+#endif
+    return compilation;
+}
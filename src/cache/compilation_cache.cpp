@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <cache/compilation_cache.hpp>
+#include <cerrno>
+#include <chrono>
+#include <common/common.hpp>
+#include <concepts>
+#include <cstdio>
+#include <format>
+#include <lib2k/defer.hpp>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <unordered_map>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PASC2K_LOCKED_CACHE_INDEX
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+static constexpr auto temporary_prefix = std::string_view{ "tmp-" };
+static constexpr auto statistics_directory = std::string_view{ "statistics" };
+
+// The directory is scanned at least once per this many stores, to correct the running size of the index.
+static constexpr auto stores_per_scan = u64{ 1000 };
+
+// Temporary files of this age belong to compilations that have been killed while storing an artifact.
+static constexpr auto stale_temporary_age = std::chrono::hours{ 1 };
+
+namespace {
+    // The state that all compilations sharing the cache update together. It is stored as a file of fixed size, which
+    // is locked while it is read and written.
+    struct Index final {
+        // The total size of the entries in bytes. Between two scans, it is the sum of the changes made by `store()` and
+        // `remove()`, so it misses changes made while the directory is scanned, and changes made by hand.
+        u64 size;
+        u64 num_stores;  // Since the last scan.
+        u64 num_hits;
+        u64 num_misses;
+    };
+}  // namespace
+
+// Reads the index, lets `update` change it, and writes it back, while the index is locked. A missing or malformed
+// index is replaced by one that makes the next store scan the directory. Returns nothing if the index cannot be
+// updated, e.g., because the directory is read-only.
+template<std::invocable<Index&> Update>
+[[nodiscard]] static std::optional<Index> update_index(std::filesystem::path const& path, Update const& update) {
+    static constexpr auto unknown = Index{ 0, stores_per_scan, 0, 0 };
+    auto index = unknown;
+#ifdef PASC2K_LOCKED_CACHE_INDEX
+    auto const file_descriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (file_descriptor < 0) {
+        return std::nullopt;
+    }
+    // Closing the file releases the lock.
+    auto const _ = c2k::Defer{ [&] { ::close(file_descriptor); } };
+    auto lock = flock{};
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    while (::fcntl(file_descriptor, F_SETLKW, &lock) != 0) {
+        if (errno != EINTR) {
+            return std::nullopt;
+        }
+    }
+    if (::pread(file_descriptor, &index, sizeof(Index), 0) != static_cast<ssize_t>(sizeof(Index))) {
+        index = unknown;
+    }
+    update(index);
+    if (::pwrite(file_descriptor, &index, sizeof(Index), 0) != static_cast<ssize_t>(sizeof(Index))) {
+        return std::nullopt;
+    }
+#else
+    // Without file locks, concurrent compilations may lose each other's updates until the next scan.
+    if (auto file = std::ifstream{ path, std::ios::binary };
+        not file.read(reinterpret_cast<char*>(&index), sizeof(Index))) {
+        index = unknown;
+    }
+    update(index);
+    auto file = std::ofstream{ path, std::ios::binary | std::ios::trunc };
+    if (not file.write(reinterpret_cast<char const*>(&index), sizeof(Index))) {
+        return std::nullopt;
+    }
+#endif
+    return index;
+}
+
+[[nodiscard]] static u64 file_size_or_zero(std::filesystem::path const& path) {
+    auto error = std::error_code{};
+    auto const size = std::filesystem::file_size(path, error);
+    return error ? 0 : size;
+}
+
+[[nodiscard]] static std::runtime_error cache_error(
+    std::string_view const what,
+    std::filesystem::path const& path,
+    std::error_code const error
+) {
+    return std::runtime_error{ std::format("Failed to {} '{}': {}", what, path.string(), error.message()) };
+}
+
+CompilationCache::CompilationCache(std::filesystem::path directory, u64 const max_size)
+    : m_directory{ std::move(directory) }, m_max_size{ max_size } {
+    auto error = std::error_code{};
+    std::filesystem::create_directories(m_directory / statistics_directory, error);
+    if (error) {
+        throw_or_abort(cache_error("create cache directory", m_directory, error));
+    }
+}
+
+std::optional<std::filesystem::path> CompilationCache::find(Hash128 const key, std::string_view const artifact) const {
+    auto path = this->path(key, artifact);
+    // Marks the entry as recently used. This fails if the artifact does not exist.
+    auto error = std::error_code{};
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+    if (error) {
+        return std::nullopt;
+    }
+    return path;
+}
+
+// Two compilations that store the same artifact at the same time must not write to the same temporary file.
+[[nodiscard]] static std::string unique_name() {
+    auto device = std::random_device{};
+    auto const high = u64{ device() };
+    return std::format("{}{:016x}", temporary_prefix, (high << 32) | u64{ device() });
+}
+
+void CompilationCache::store(
+    Hash128 const key,
+    std::string_view const artifact,
+    std::function<void(DumpSink&)> const& write
+) {
+    auto const temporary_path = m_directory / unique_name();
+    auto const file = std::fopen(temporary_path.string().c_str(), "wb");
+    if (file == nullptr) {
+        throw_or_abort(cache_error("create", temporary_path, std::error_code{ errno, std::generic_category() }));
+    }
+    auto is_open = true;
+    auto is_renamed = false;
+    auto const _ = c2k::Defer{ [&] {
+        if (is_open) {
+            std::fclose(file);
+        }
+        if (not is_renamed) {
+            auto ignored = std::error_code{};
+            std::filesystem::remove(temporary_path, ignored);
+        }
+    } };
+
+    auto sink = FileSink{ file };
+    write(sink);
+    is_open = false;
+    if (std::fclose(file) != 0) {
+        throw_or_abort(cache_error("write", temporary_path, std::error_code{ errno, std::generic_category() }));
+    }
+
+    // Renaming replaces an existing artifact atomically.
+    auto const path = this->path(key, artifact);
+    auto const added_size = file_size_or_zero(temporary_path);
+    auto const replaced_size = file_size_or_zero(path);
+    auto error = std::error_code{};
+    std::filesystem::rename(temporary_path, path, error);
+    if (error) {
+        throw_or_abort(cache_error("write", path, error));
+    }
+    is_renamed = true;
+
+    // Scanning the directory takes time proportional to the number of entries, so it is only done when the cache has
+    // grown too large, and once in a while to correct the running size.
+    auto const index = update_index(index_path(), [&](Index& updated) {
+        updated.size = updated.size + added_size - std::min(replaced_size, updated.size + added_size);
+        ++updated.num_stores;
+    });
+    if (not index.has_value() or index->size > m_max_size or index->num_stores >= stores_per_scan) {
+        trim();
+    }
+}
+
+void CompilationCache::remove(Hash128 const key, std::string_view const artifact) {
+    auto const path = this->path(key, artifact);
+    auto const removed_size = file_size_or_zero(path);
+    auto error = std::error_code{};
+    if (std::filesystem::remove(path, error) and removed_size > 0) {
+        std::ignore = update_index(index_path(), [&](Index& updated) {
+            updated.size -= std::min(removed_size, updated.size);
+        });
+    }
+}
+
+void CompilationCache::record_hit() const {
+    std::ignore = update_index(index_path(), [](Index& updated) { ++updated.num_hits; });
+}
+
+void CompilationCache::record_miss() const {
+    std::ignore = update_index(index_path(), [](Index& updated) { ++updated.num_misses; });
+}
+
+CompilationCache::Statistics CompilationCache::statistics() const {
+    auto const entries = scan().entries;
+    auto size = u64{ 0 };
+    for (auto const& entry : entries) {
+        size += entry.size;
+    }
+    // Reading the index through an update that changes nothing takes the lock, so that the counts are consistent.
+    auto const index = update_index(index_path(), [](Index&) {});
+    return Statistics{
+        index.has_value() ? index->num_hits : 0,
+        index.has_value() ? index->num_misses : 0,
+        entries.size(),
+        size,
+    };
+}
+
+std::filesystem::path CompilationCache::path(Hash128 const key, std::string_view const artifact) const {
+    return m_directory / std::format("{}.{}", key.to_string(), artifact);
+}
+
+std::filesystem::path CompilationCache::index_path() const {
+    return m_directory / statistics_directory / "index";
+}
+
+// Other compilations may add and remove files at the same time, so files that vanish are skipped. Temporary files are
+// not part of any entry, but the ones that are older than `stale_temporary_age` are collected, so that they can be
+// removed.
+CompilationCache::Scan CompilationCache::scan() const {
+    auto entries = std::unordered_map<std::string, Entry>{};
+    auto stale_temporaries = std::vector<std::filesystem::path>{};
+    auto const stale_time = std::filesystem::file_time_type::clock::now() - stale_temporary_age;
+    auto error = std::error_code{};
+    for (auto it = std::filesystem::directory_iterator{ m_directory, error };
+         not error and it != std::filesystem::directory_iterator{};
+         it.increment(error)) {
+        auto const name = it->path().filename().string();
+        auto file_error = std::error_code{};
+        if (not it->is_regular_file(file_error)) {
+            continue;
+        }
+        auto const size = it->file_size(file_error);
+        auto const last_write_time = it->last_write_time(file_error);
+        if (file_error) {
+            continue;
+        }
+        if (name.starts_with(temporary_prefix)) {
+            if (last_write_time < stale_time) {
+                stale_temporaries.push_back(it->path());
+            }
+            continue;
+        }
+        auto& entry = entries[name.substr(0, name.find('.'))];
+        entry.files.push_back(it->path());
+        entry.size += size;
+        entry.last_use = std::max(entry.last_use, last_write_time);
+    }
+    auto result = Scan{ {}, std::move(stale_temporaries) };
+    result.entries.reserve(entries.size());
+    for (auto& [key, entry] : entries) {
+        result.entries.push_back(std::move(entry));
+    }
+    return result;
+}
+
+void CompilationCache::trim() {
+    auto [entries, stale_temporaries] = scan();
+    for (auto const& temporary : stale_temporaries) {
+        auto ignored = std::error_code{};
+        std::filesystem::remove(temporary, ignored);
+    }
+    auto size = u64{ 0 };
+    for (auto const& entry : entries) {
+        size += entry.size;
+    }
+    // Trimming below the limit leaves room for the next entries, so that the directory is not scanned on every store
+    // once the cache is full.
+    if (size > m_max_size) {
+        auto const target_size = m_max_size - m_max_size / 10;
+        std::ranges::sort(entries, {}, &Entry::last_use);
+        for (auto const& entry : entries) {
+            if (size <= target_size) {
+                break;
+            }
+            for (auto const& file : entry.files) {
+                auto ignored = std::error_code{};
+                std::filesystem::remove(file, ignored);
+            }
+            size -= entry.size;
+        }
+    }
+    std::ignore = update_index(index_path(), [&](Index& updated) {
+        updated.size = size;
+        updated.num_stores = 0;
+    });
+}
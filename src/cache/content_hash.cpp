@@ -0,0 +1,78 @@
+#include <bit>
+#include <cache/content_hash.hpp>
+#include <cstring>
+#include <format>
+
+std::string Hash128::to_string() const {
+    return std::format("{:016x}{:016x}", high, low);
+}
+
+[[nodiscard]] static u64 load_u64(char const* const data) {
+    auto result = u64{};
+    std::memcpy(&result, data, sizeof(result));
+    return result;
+}
+
+// The finalization mix, which makes every bit of the result depend on every bit of the input.
+[[nodiscard]] static u64 mix(u64 value) {
+    value ^= value >> 33;
+    value *= u64{ 0xFF51'AFD7'ED55'8CCD };
+    value ^= value >> 33;
+    value *= u64{ 0xC4CE'B9FE'1A85'EC53 };
+    value ^= value >> 33;
+    return value;
+}
+
+static constexpr auto c1 = u64{ 0x87C3'7B91'1142'53D5 };
+static constexpr auto c2 = u64{ 0x4CF5'AD43'2745'937F };
+
+[[nodiscard]] static u64 scramble_first(u64 const value) {
+    return std::rotl(value * c1, 31) * c2;
+}
+
+[[nodiscard]] static u64 scramble_second(u64 const value) {
+    return std::rotl(value * c2, 33) * c1;
+}
+
+Hash128 hash_128(std::string_view const data, u64 const seed) {
+    static constexpr auto block_size = usize{ 16 };
+    auto h1 = seed;
+    auto h2 = seed;
+
+    auto const num_blocks = data.size() / block_size;
+    for (auto i = usize{ 0 }; i < num_blocks; ++i) {
+        auto const block = data.data() + i * block_size;
+        h1 ^= scramble_first(load_u64(block));
+        h1 = (std::rotl(h1, 27) + h2) * 5 + 0x52DC'E729;
+        h2 ^= scramble_second(load_u64(block + 8));
+        h2 = (std::rotl(h2, 31) + h1) * 5 + 0x3849'5AB5;
+    }
+
+    auto const tail = data.substr(num_blocks * block_size);
+    auto k1 = u64{ 0 };
+    auto k2 = u64{ 0 };
+    for (auto i = usize{ 0 }; i < tail.size(); ++i) {
+        auto const byte = u64{ static_cast<unsigned char>(tail[i]) };
+        if (i < 8) {
+            k1 ^= byte << (8 * i);
+        } else {
+            k2 ^= byte << (8 * (i - 8));
+        }
+    }
+    if (tail.size() > 8) {
+        h2 ^= scramble_second(k2);
+    }
+    if (not tail.empty()) {
+        h1 ^= scramble_first(k1);
+    }
+
+    h1 ^= data.size();
+    h2 ^= data.size();
+    h1 += h2;
+    h2 += h1;
+    h1 = mix(h1);
+    h2 = mix(h2);
+    h1 += h2;
+    h2 += h1;
+    return Hash128{ h1, h2 };
+}
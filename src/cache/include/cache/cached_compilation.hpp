@@ -0,0 +1,23 @@
+#pragma once
+
+#include <optional>
+#include <parser/flat_ast.hpp>
+#include <string>
+#include "compilation_cache.hpp"
+
+// The outputs of a compilation, as stored in a `CompilationCache`. They consist of the artifact `result`, which
+// contains the exit code, whether there is an AST, and the diagnostics, and the artifact `ast`, which contains the flat
+// AST if parsing succeeded.
+struct CachedCompilation final {
+    int exit_code = 0;
+    std::string diagnostics;  // Formatted, as they are printed.
+    std::optional<FlatAst> ast;
+};
+
+// Throws `std::runtime_error` if an artifact cannot be written.
+void store_compilation(CompilationCache& cache, Hash128 key, CachedCompilation const& compilation);
+
+// Returns nothing if the compilation is not cached. An entry that cannot be used, e.g., because an artifact has been
+// truncated or cannot be read, is removed and also treated as not cached, so that the compilation is repeated and
+// stored again.
+[[nodiscard]] std::optional<CachedCompilation> load_compilation(CompilationCache& cache, Hash128 key);
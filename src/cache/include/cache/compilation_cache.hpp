@@ -0,0 +1,76 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <lib2k/types.hpp>
+#include <optional>
+#include <parser/ast_dumper.hpp>
+#include <string_view>
+#include <vector>
+#include "content_hash.hpp"
+
+// Stores the outputs of compilations in a directory, so that compiling the same input again can reuse them. The outputs
+// are identified by a key, which has to be the hash of everything the outputs depend on (see `compiler_salt`). Every
+// output is a separate file named `<key>.<artifact>`, and all artifacts of a key form one entry.
+//
+// The cache can be shared by concurrent compilations: Artifacts are written to temporary files, which are renamed when
+// they are complete, so that other compilations never see partially written artifacts. When the total size of the
+// entries exceeds the limit, the least recently used entries are removed until it is 10% below the limit. Finding an
+// artifact counts as a use. The total size is kept in a small, locked index file, so that storing an artifact only
+// scans the directory when the limit is exceeded, and once every thousand stores to correct the index. Scanning also
+// removes temporary files that compilations have left behind when they were killed. The index also holds the counts
+// of hits and misses, so that the statistics take the same space however often the cache is used.
+class CompilationCache final {
+public:
+    // Part of every key. Increment it whenever the lexer, the parser or the formats of the artifacts change, since
+    // otherwise outputs of an older compiler would be reused.
+    static constexpr auto compiler_salt = std::string_view{ "pasc2k-2" };
+
+    struct Statistics final {
+        u64 num_hits;  // Of all compilations, not only of the ones that are still cached.
+        u64 num_misses;
+        usize num_entries;
+        u64 size;  // In bytes.
+    };
+
+private:
+    struct Entry final {
+        std::vector<std::filesystem::path> files;
+        u64 size = 0;
+        std::filesystem::file_time_type last_use{};
+    };
+
+    struct Scan final {
+        std::vector<Entry> entries;
+        std::vector<std::filesystem::path> stale_temporaries;
+    };
+
+    std::filesystem::path m_directory;
+    u64 m_max_size;
+
+public:
+    // Creates the directory if it does not exist. Throws `std::runtime_error` if that fails.
+    [[nodiscard]] explicit CompilationCache(std::filesystem::path directory, u64 max_size);
+
+    // Returns the path of the artifact if it is cached.
+    [[nodiscard]] std::optional<std::filesystem::path> find(Hash128 key, std::string_view artifact) const;
+
+    // Replaces the artifact with the data that `write` writes to the given sink. Afterwards, entries are removed until
+    // the cache is small enough again. Throws `std::runtime_error` if the artifact cannot be written.
+    void store(Hash128 key, std::string_view artifact, std::function<void(DumpSink&)> const& write);
+
+    // Removes the artifact if it is cached, e.g., because it cannot be used anymore. Never fails.
+    void remove(Hash128 key, std::string_view artifact);
+
+    // Counts the outcome of a lookup for `statistics()`. Counting is best-effort and never fails.
+    void record_hit() const;
+    void record_miss() const;
+
+    [[nodiscard]] Statistics statistics() const;
+
+private:
+    [[nodiscard]] std::filesystem::path path(Hash128 key, std::string_view artifact) const;
+    [[nodiscard]] std::filesystem::path index_path() const;
+    [[nodiscard]] Scan scan() const;
+    void trim();
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <lib2k/types.hpp>
+#include <string>
+#include <string_view>
+
+// A 128-bit hash, which is large enough to identify contents without checking for collisions.
+struct Hash128 final {
+    u64 low;
+    u64 high;
+
+    // 32 lowercase hexadecimal digits.
+    [[nodiscard]] std::string to_string() const;
+
+    [[nodiscard]] constexpr bool operator==(Hash128 const& other) const = default;
+};
+
+// MurmurHash3 (x64, 128 bits), but with a 64-bit seed. It processes 16 bytes per step, so hashing is much faster than
+// reading the source from disk. Hashes of the same data differ between little- and big-endian machines.
+[[nodiscard]] Hash128 hash_128(std::string_view data, u64 seed = 0);
@@ -3,6 +3,10 @@
 #include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <concepts>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
 #include <lib2k/types.hpp>
 #include <ranges>
 #include <stdexcept>
@@ -29,6 +33,25 @@ concept IsOptional = requires(T&& t) {
     { t.value() } -> std::convertible_to<Contained>;
 };
 
+// Whether exceptions are enabled (MSVC defines `_CPPUNWIND` instead of `__cpp_exceptions`).
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+#define PASC2K_EXCEPTIONS 1
+#else
+#define PASC2K_EXCEPTIONS 0
+#endif
+
+// Throws `error`. If exceptions are disabled, its message is printed and the program is aborted instead. Code that
+// has to handle errors in both configurations uses the `try_` functions, which report into `Diagnostics`.
+template<std::derived_from<std::exception> Error>
+[[noreturn]] void throw_or_abort(Error const& error) {
+#if PASC2K_EXCEPTIONS
+    throw error;
+#else
+    std::fprintf(stderr, "%s\n", error.what());
+    std::abort();
+#endif
+}
+
 class InternalCompilerError final : public std::runtime_error {
 public:
     [[nodiscard]] explicit InternalCompilerError(std::string const& message)
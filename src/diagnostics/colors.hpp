@@ -1,5 +1,6 @@
 #pragma once
 
+#include <ostream>
 #include <print>
 
 enum class TextColor {
@@ -40,14 +41,14 @@ enum class BackgroundColor {
     BrightWhite = 107,
 };
 
-inline void set_text_color(TextColor const color) {
-    std::print("\x1b[{}m", static_cast<int>(color));
+inline void set_text_color(std::ostream& stream, TextColor const color) {
+    std::print(stream, "\x1b[{}m", static_cast<int>(color));
 }
 
-inline void set_background_color(BackgroundColor const color) {
-    std::print("\x1b[{}m", static_cast<int>(color));
+inline void set_background_color(std::ostream& stream, BackgroundColor const color) {
+    std::print(stream, "\x1b[{}m", static_cast<int>(color));
 }
 
-inline void reset_colors() {
-    std::print("\x1b[0m");
+inline void reset_colors(std::ostream& stream) {
+    std::print(stream, "\x1b[0m");
 }
@@ -24,16 +24,16 @@ static void format_line_to(std::ostream& stream, SourceLocation const& source_lo
         auto const line_number = start_line + static_cast<usize>(i);
         auto const column = i == 0 ? start_column : 1;
         if (use_color) {
-            set_text_color(TextColor::White);
+            set_text_color(stream, TextColor::White);
         }
         std::print(stream, "{:5}", line_number);
         if (use_color) {
-            reset_colors();
+            reset_colors(stream);
         }
         std::println(stream, " | {}", line);
         std::print(stream, "      |");
         if (use_color) {
-            set_text_color(TextColor::Green);
+            set_text_color(stream, TextColor::Green);
         }
         if (i == 0) {
             std::print(stream, "{:>{}}^", "", column);
@@ -46,9 +46,9 @@ static void format_line_to(std::ostream& stream, SourceLocation const& source_lo
             remaining_length -= squiggly_length;
         }
         if (use_color) {
-            reset_colors();
+            reset_colors(stream);
         }
-        std::print("\n");
+        std::print(stream, "\n");
     }
 }
 
@@ -59,7 +59,7 @@ static void format_line_to(std::ostream& stream, SourceLocation const& source_lo
         case DiagnosticsType::Note:
             return TextColor::Blue;
     }
-    throw InternalCompilerError{ "Unknown diagnostics type" };
+    throw_or_abort(InternalCompilerError{ "Unknown diagnostics type" });
 }
 
 static void format_to_with_source_location(
@@ -71,11 +71,11 @@ static void format_to_with_source_location(
 ) {
     format_source_location_to(stream, source_location);
     if (use_color) {
-        set_text_color(color(type));
+        set_text_color(stream, color(type));
     }
     std::print(stream, "{}: ", magic_enum::enum_name(type));
     if (use_color) {
-        reset_colors();
+        reset_colors(stream);
     }
     std::println(stream, "{}", error_message);
     format_line_to(stream, source_location, use_color);
@@ -83,11 +83,11 @@ static void format_to_with_source_location(
 
 void format_to_without_source_location(std::ostream& stream, std::string const& error_message, bool const use_color) {
     if (use_color) {
-        set_text_color(TextColor::Red);
+        set_text_color(stream, TextColor::Red);
     }
     std::print(stream, "Error: ");
     if (use_color) {
-        reset_colors();
+        reset_colors(stream);
     }
     std::println(stream, "{}", error_message);
 }
@@ -116,3 +116,28 @@ void format_error_to(std::ostream& stream, std::exception const& error, bool con
         format_to_without_source_location(stream, error.what(), use_color);
     }
 }
+
+void format_diagnostic_to(
+    std::ostream& stream,
+    Diagnostics const& diagnostics,
+    DiagnosticId const id,
+    bool const use_color
+) {
+    auto const& diagnostic = diagnostics[id];
+    format_to_with_source_location(
+        stream,
+        diagnostic.message(),
+        diagnostic.source_location(),
+        DiagnosticsType::Error,
+        use_color
+    );
+    for (auto const& note : diagnostics.notes(id) | std::views::reverse) {
+        format_to_with_source_location(
+            stream,
+            note.message(),
+            note.source_location(),
+            DiagnosticsType::Note,
+            use_color
+        );
+    }
+}
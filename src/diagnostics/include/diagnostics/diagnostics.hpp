@@ -1,6 +1,11 @@
 #pragma once
 
 #include <iostream>
+#include <lexer/diagnostic.hpp>
 #include <stdexcept>
 
 void format_error_to(std::ostream& stream, std::exception const& error, bool use_color = true);
+
+// Formats an error that has been reported by one of the `try_` functions the same way as `format_error_to()` formats
+// the corresponding exception.
+void format_diagnostic_to(std::ostream& stream, Diagnostics const& diagnostics, DiagnosticId id, bool use_color = true);
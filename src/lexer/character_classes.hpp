@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <lexer/token_type.hpp>
+#include <lib2k/types.hpp>
+
+// Classifies the first character of a token (or of a token separator). The lexer branches once on this class.
+enum class CharacterClass : u8 {
+    Invalid,
+    NonAscii,
+    Whitespace,
+    Letter,
+    Digit,
+    Apostrophe,  // Character strings.
+    LeftCurlyBracket,  // Comments.
+    LeftParenthesis,  // `(`, `(.`, or a comment starting with `(*`.
+    LessThan,  // `<`, `<>`, or `<=`.
+    GreaterThan,  // `>` or `>=`.
+    Dot,  // `.`, `..`, or `.)`.
+    Colon,  // `:` or `:=`.
+    SingleCharacterSymbol,  // All other special symbols, see `single_character_symbols`.
+};
+
+namespace detail {
+    inline constexpr auto single_character_symbol_list = std::array{
+        std::pair{ '+', TokenType::Plus },
+        std::pair{ '-', TokenType::Minus },
+        std::pair{ '*', TokenType::Asterisk },
+        std::pair{ '/', TokenType::Slash },
+        std::pair{ '=', TokenType::Equals },
+        std::pair{ '[', TokenType::LeftSquareBracket },
+        std::pair{ ']', TokenType::RightSquareBracket },
+        std::pair{ ',', TokenType::Comma },
+        std::pair{ ';', TokenType::Semicolon },
+        std::pair{ '^', TokenType::UpArrow },
+        std::pair{ '@', TokenType::UpArrow },  // Alternative token.
+        std::pair{ ')', TokenType::RightParenthesis },
+    };
+
+    [[nodiscard]] constexpr usize table_index(char const c) {
+        return static_cast<usize>(static_cast<unsigned char>(c));
+    }
+
+    [[nodiscard]] constexpr std::array<CharacterClass, 256> build_character_classes() {
+        auto classes = std::array<CharacterClass, 256>{};
+        classes.fill(CharacterClass::Invalid);
+        for (auto i = usize{ 128 }; i < classes.size(); ++i) {
+            classes[i] = CharacterClass::NonAscii;
+        }
+        // The same characters as `std::isspace()` in the "C" locale.
+        for (auto const c : { ' ', '\t', '\n', '\v', '\f', '\r' }) {
+            classes[table_index(c)] = CharacterClass::Whitespace;
+        }
+        for (auto c = 'a'; c <= 'z'; ++c) {
+            classes[table_index(c)] = CharacterClass::Letter;
+            classes[table_index(static_cast<char>(c - 'a' + 'A'))] = CharacterClass::Letter;
+        }
+        for (auto c = '0'; c <= '9'; ++c) {
+            classes[table_index(c)] = CharacterClass::Digit;
+        }
+        classes[table_index('\'')] = CharacterClass::Apostrophe;
+        classes[table_index('{')] = CharacterClass::LeftCurlyBracket;
+        classes[table_index('(')] = CharacterClass::LeftParenthesis;
+        classes[table_index('<')] = CharacterClass::LessThan;
+        classes[table_index('>')] = CharacterClass::GreaterThan;
+        classes[table_index('.')] = CharacterClass::Dot;
+        classes[table_index(':')] = CharacterClass::Colon;
+        for (auto const& [c, type] : single_character_symbol_list) {
+            classes[table_index(c)] = CharacterClass::SingleCharacterSymbol;
+        }
+        return classes;
+    }
+
+    // Only the entries for characters of class `CharacterClass::SingleCharacterSymbol` are meaningful.
+    [[nodiscard]] constexpr std::array<TokenType, 256> build_single_character_symbols() {
+        auto symbols = std::array<TokenType, 256>{};
+        symbols.fill(TokenType::EndOfFile);
+        for (auto const& [c, type] : single_character_symbol_list) {
+            symbols[table_index(c)] = type;
+        }
+        return symbols;
+    }
+
+    inline constexpr auto character_classes = build_character_classes();
+    inline constexpr auto single_character_symbols = build_single_character_symbols();
+}  // namespace detail
+
+[[nodiscard]] constexpr CharacterClass character_class(char const c) {
+    return detail::character_classes[detail::table_index(c)];
+}
+
+// Expects `c` to be of class `CharacterClass::SingleCharacterSymbol`.
+[[nodiscard]] constexpr TokenType single_character_symbol(char const c) {
+    return detail::single_character_symbols[detail::table_index(c)];
+}
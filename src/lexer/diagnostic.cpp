@@ -0,0 +1,34 @@
+#include <cctype>
+#include <format>
+#include <lexer/diagnostic.hpp>
+
+[[nodiscard]] std::string Diagnostic::message() const {
+    switch (m_kind) {
+        case DiagnosticKind::NonAsciiCharacter:
+            return "Non-ASCII character";
+        case DiagnosticKind::InvalidUtf8:
+            return "Invalid UTF-8 sequence";
+        case DiagnosticKind::UnexpectedCharacter:
+            if (std::isprint(static_cast<unsigned char>(m_actual))) {
+                return std::format("Unexpected character: Got '{}', expected {}", m_actual, m_expected);
+            }
+            return std::format(
+                "Unexpected character: Got non-printable character #{}, expected {}",
+                static_cast<int>(m_actual),
+                m_expected
+            );
+        case DiagnosticKind::UnterminatedCharacterString:
+            return "Unterminated character string";
+        case DiagnosticKind::UnterminatedComment:
+            return "Unterminated comment";
+        case DiagnosticKind::SourceFileTooLarge:
+            return "Source file too large (the maximum size is 4 GiB)";
+        case DiagnosticKind::ParserError:
+            return std::string{ m_message };
+    }
+    throw_or_abort(InternalCompilerError{ "Unknown diagnostic kind." });
+}
+
+[[nodiscard]] std::string DiagnosticNote::message() const {
+    return std::vformat(m_message, std::make_format_args(m_argument));
+}
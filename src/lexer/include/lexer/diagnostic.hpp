@@ -0,0 +1,165 @@
+#pragma once
+
+#include <lib2k/types.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "source_location.hpp"
+
+enum class DiagnosticKind {
+    NonAsciiCharacter,
+    InvalidUtf8,
+    UnexpectedCharacter,
+    UnterminatedCharacterString,
+    UnterminatedComment,
+    SourceFileTooLarge,
+    ParserError,
+};
+
+// An error that is reported without throwing an exception. Only the parts of the message that depend on the input are
+// stored, so creating a diagnostic does not allocate. The message is formatted on demand.
+class Diagnostic final {
+private:
+    DiagnosticKind m_kind;
+    SourceLocation m_source_location;
+    std::string_view m_message;  // Only used by parser errors.
+    char m_actual = '\0';  // Only used by unexpected characters.
+    char const* m_expected = nullptr;  // Only used by unexpected characters.
+
+public:
+    // For lexer errors whose message only depends on their kind.
+    [[nodiscard]] explicit Diagnostic(DiagnosticKind const kind, SourceLocation source_location)
+        : m_kind{ kind }, m_source_location{ std::move(source_location) } {
+        assert(kind != DiagnosticKind::UnexpectedCharacter and kind != DiagnosticKind::ParserError);
+    }
+
+    // `expected` describes what would have been valid instead of `actual`. It must be a string literal.
+    [[nodiscard]] static Diagnostic unexpected_character(
+        SourceLocation source_location,
+        char const actual,
+        char const* const expected
+    ) {
+        auto result = Diagnostic{ DiagnosticKind::UnexpectedCharacter, std::move(source_location), "" };
+        result.m_actual = actual;
+        result.m_expected = expected;
+        return result;
+    }
+
+    // `message` must be a string literal.
+    [[nodiscard]] static Diagnostic parser_error(std::string_view const message, SourceLocation source_location) {
+        return Diagnostic{ DiagnosticKind::ParserError, std::move(source_location), message };
+    }
+
+    [[nodiscard]] DiagnosticKind kind() const {
+        return m_kind;
+    }
+
+    [[nodiscard]] SourceLocation const& source_location() const {
+        return m_source_location;
+    }
+
+    // Only meaningful for unexpected characters.
+    [[nodiscard]] char actual() const {
+        return m_actual;
+    }
+
+    // Only meaningful for unexpected characters.
+    [[nodiscard]] char const* expected() const {
+        return m_expected;
+    }
+
+    [[nodiscard]] std::string message() const;
+
+private:
+    [[nodiscard]] explicit Diagnostic(
+        DiagnosticKind const kind,
+        SourceLocation source_location,
+        std::string_view const message
+    )
+        : m_kind{ kind }, m_source_location{ std::move(source_location) }, m_message{ message } {}
+};
+
+// Points at a construct that enclosed the location of an error. `message` is a format string with at most one
+// replacement field, which is replaced by `argument`. Both must outlive the note. Usually, `message` is a string
+// literal and `argument` is part of the source.
+class DiagnosticNote final {
+private:
+    SourceLocation m_source_location;
+    std::string_view m_message;
+    std::string_view m_argument;
+
+public:
+    [[nodiscard]] DiagnosticNote(
+        SourceLocation source_location,
+        std::string_view const message,
+        std::string_view const argument = {}
+    )
+        : m_source_location{ std::move(source_location) }, m_message{ message }, m_argument{ argument } {}
+
+    [[nodiscard]] SourceLocation const& source_location() const {
+        return m_source_location;
+    }
+
+    [[nodiscard]] std::string message() const;
+};
+
+// Identifies a diagnostic within `Diagnostics`.
+enum class DiagnosticId : u32 {};
+
+// Collects the errors of the `try_` functions, which report errors without throwing. Reserving capacity up front keeps
+// reporting free of allocations, and `clear()` keeps the capacity, so that one buffer can be reused for many inputs.
+class Diagnostics final {
+private:
+    struct Entry final {
+        Diagnostic diagnostic;
+        usize notes_begin;
+        usize notes_end;
+    };
+
+    std::vector<Entry> m_entries;
+    std::vector<DiagnosticNote> m_notes;
+
+public:
+    [[nodiscard]] Diagnostics() = default;
+
+    [[nodiscard]] explicit Diagnostics(usize const capacity, usize const notes_capacity = 0) {
+        reserve(capacity, notes_capacity);
+    }
+
+    void reserve(usize const capacity, usize const notes_capacity = 0) {
+        m_entries.reserve(capacity);
+        m_notes.reserve(notes_capacity);
+    }
+
+    // `notes` are listed from the outermost to the innermost construct.
+    [[nodiscard]] DiagnosticId report(Diagnostic diagnostic, std::span<DiagnosticNote const> const notes = {}) {
+        auto const id = DiagnosticId{ static_cast<u32>(m_entries.size()) };
+        auto const notes_begin = m_notes.size();
+        m_notes.insert(m_notes.end(), notes.begin(), notes.end());
+        m_entries.push_back(Entry{ std::move(diagnostic), notes_begin, m_notes.size() });
+        return id;
+    }
+
+    [[nodiscard]] Diagnostic const& operator[](DiagnosticId const id) const {
+        return m_entries.at(static_cast<usize>(id)).diagnostic;
+    }
+
+    [[nodiscard]] std::span<DiagnosticNote const> notes(DiagnosticId const id) const {
+        auto const& entry = m_entries.at(static_cast<usize>(id));
+        return std::span{ m_notes }.subspan(entry.notes_begin, entry.notes_end - entry.notes_begin);
+    }
+
+    [[nodiscard]] usize size() const {
+        return m_entries.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return m_entries.empty();
+    }
+
+    void clear() {
+        m_entries.clear();
+        m_notes.clear();
+    }
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <lib2k/types.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "literal_pool.hpp"
+
+// Identifies an interned identifier spelling. Two identifiers refer to the same name if and only if they have the
+// same symbol (within the same `Interner`).
+enum class Symbol : u32 {
+    None = 0xFFFF'FFFF,  // Used for tokens that are not identifiers.
+};
+
+// Maps case-insensitive identifier spellings to symbols. Each distinct spelling is stored once (in lowercase).
+// One interner is meant to be shared by all source files of a compilation. It also owns the pool of literal values,
+// which is shared the same way.
+class Interner final {
+private:
+    struct Entry final {
+        u32 offset;  // Into `m_spellings`.
+        u32 length;
+        u64 hash;
+    };
+
+    static constexpr auto empty_slot = u32{ 0 };
+
+    std::string m_spellings;
+    std::vector<Entry> m_entries;  // Indexed by symbol.
+    std::vector<u32> m_slots;  // Open addressing with linear probing. Contains symbol + 1, or `empty_slot`.
+    LiteralPool m_literals;
+
+public:
+    [[nodiscard]] Interner();
+
+    // Returns the symbol of the given spelling, which must consist of ASCII letters and digits only. The comparison
+    // is case-insensitive.
+    [[nodiscard]] Symbol intern(std::string_view spelling);
+
+    // Returns the lowercase spelling of the given symbol.
+    [[nodiscard]] std::string_view spelling(Symbol symbol) const;
+
+    [[nodiscard]] usize size() const {
+        return m_entries.size();
+    }
+
+    [[nodiscard]] LiteralPool& literals() {
+        return m_literals;
+    }
+
+    [[nodiscard]] LiteralPool const& literals() const {
+        return m_literals;
+    }
+
+private:
+    [[nodiscard]] bool matches(Entry const& entry, std::string_view spelling, u64 hash) const;
+    void grow();
+};
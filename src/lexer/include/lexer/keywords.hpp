@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <common/common.hpp>
+#include <optional>
+#include <string_view>
+#include "token_type.hpp"
+
+namespace detail {
+    struct WordSymbol final {
+        std::string_view spelling;  // Lowercase.
+        TokenType type;
+    };
+
+    // 6.1.2 Word symbols and the required type identifiers that get their own token types.
+    inline constexpr auto word_symbols = std::array{
+        WordSymbol{ "and", TokenType::And },
+        WordSymbol{ "array", TokenType::Array },
+        WordSymbol{ "begin", TokenType::Begin },
+        WordSymbol{ "case", TokenType::Case },
+        WordSymbol{ "const", TokenType::Const },
+        WordSymbol{ "div", TokenType::Div },
+        WordSymbol{ "do", TokenType::Do },
+        WordSymbol{ "downto", TokenType::DownTo },
+        WordSymbol{ "else", TokenType::Else },
+        WordSymbol{ "end", TokenType::End },
+        WordSymbol{ "file", TokenType::File },
+        WordSymbol{ "for", TokenType::For },
+        WordSymbol{ "function", TokenType::Function },
+        WordSymbol{ "goto", TokenType::Goto },
+        WordSymbol{ "if", TokenType::If },
+        WordSymbol{ "in", TokenType::In },
+        WordSymbol{ "label", TokenType::Label },
+        WordSymbol{ "mod", TokenType::Mod },
+        WordSymbol{ "nil", TokenType::Nil },
+        WordSymbol{ "not", TokenType::Not },
+        WordSymbol{ "of", TokenType::Of },
+        WordSymbol{ "or", TokenType::Or },
+        WordSymbol{ "packed", TokenType::Packed },
+        WordSymbol{ "procedure", TokenType::Procedure },
+        WordSymbol{ "program", TokenType::Program },
+        WordSymbol{ "record", TokenType::Record },
+        WordSymbol{ "repeat", TokenType::Repeat },
+        WordSymbol{ "set", TokenType::Set },
+        WordSymbol{ "then", TokenType::Then },
+        WordSymbol{ "to", TokenType::To },
+        WordSymbol{ "type", TokenType::Type },
+        WordSymbol{ "until", TokenType::Until },
+        WordSymbol{ "var", TokenType::Var },
+        WordSymbol{ "while", TokenType::While },
+        WordSymbol{ "with", TokenType::With },
+        WordSymbol{ "boolean", TokenType::Boolean },
+        WordSymbol{ "integer", TokenType::Integer },
+        WordSymbol{ "real", TokenType::Real },
+        WordSymbol{ "char", TokenType::Char },
+    };
+
+    inline constexpr auto spelling_length = [](WordSymbol const& word_symbol) {
+        return word_symbol.spelling.length();
+    };
+    inline constexpr auto min_word_symbol_length = spelling_length(std::ranges::min(word_symbols, {}, spelling_length));
+    inline constexpr auto max_word_symbol_length = spelling_length(std::ranges::max(word_symbols, {}, spelling_length));
+
+    inline constexpr auto word_symbol_table_size = usize{ 128 };
+    static_assert(std::has_single_bit(word_symbol_table_size));
+
+    // Multipliers for the first, second, and last character of a word.
+    struct WordSymbolHashParameters final {
+        u32 first;
+        u32 second;
+        u32 last;
+    };
+
+    // Folds letters to lowercase. Digits are not affected since they already have bit 5 set.
+    [[nodiscard]] constexpr u32 fold(char const c) {
+        return static_cast<u32>(static_cast<unsigned char>(c)) | 0x20U;
+    }
+
+    // Expects `word` to have at least two characters.
+    [[nodiscard]] constexpr usize word_symbol_hash(std::string_view const word, WordSymbolHashParameters const parameters) {
+        auto const hash = static_cast<u32>(word.length()) + parameters.first * fold(word.front())
+                          + parameters.second * fold(word[1]) + parameters.last * fold(word.back());
+        return static_cast<usize>(hash) & (word_symbol_table_size - 1);
+    }
+
+    [[nodiscard]] constexpr bool is_perfect(WordSymbolHashParameters const parameters) {
+        auto occupied = std::array<bool, word_symbol_table_size>{};
+        for (auto const& word_symbol : word_symbols) {
+            auto const slot = word_symbol_hash(word_symbol.spelling, parameters);
+            if (occupied[slot]) {
+                return false;
+            }
+            occupied[slot] = true;
+        }
+        return true;
+    }
+
+    [[nodiscard]] constexpr std::optional<WordSymbolHashParameters> find_perfect_hash_parameters() {
+        constexpr auto max_multiplier = u32{ 64 };
+        for (auto first = u32{ 1 }; first < max_multiplier; ++first) {
+            for (auto last = u32{ 1 }; last < max_multiplier; ++last) {
+                for (auto second = u32{ 1 }; second < max_multiplier; ++second) {
+                    auto const parameters = WordSymbolHashParameters{ first, second, last };
+                    if (is_perfect(parameters)) {
+                        return parameters;
+                    }
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    inline constexpr auto word_symbol_hash_parameters = find_perfect_hash_parameters();
+    static_assert(word_symbol_hash_parameters.has_value(), "No perfect hash found for the word symbols.");
+
+    [[nodiscard]] constexpr auto build_word_symbol_table() {
+        auto table = std::array<WordSymbol, word_symbol_table_size>{};
+        table.fill(WordSymbol{ "", TokenType::Identifier });
+        for (auto const& word_symbol : word_symbols) {
+            table[word_symbol_hash(word_symbol.spelling, word_symbol_hash_parameters.value())] = word_symbol;
+        }
+        return table;
+    }
+
+    inline constexpr auto word_symbol_table = build_word_symbol_table();
+}  // namespace detail
+
+// Returns the token type of the word symbol (or required type) spelled by `word`, or `TokenType::Identifier` if
+// `word` is no such symbol. The comparison is case-insensitive. `word` must only consist of letters and digits.
+[[nodiscard]] constexpr TokenType classify_word(std::string_view const word) {
+    using namespace detail;
+    if (word.length() < min_word_symbol_length or word.length() > max_word_symbol_length) {
+        return TokenType::Identifier;
+    }
+    auto const& [spelling, type] = word_symbol_table[word_symbol_hash(word, word_symbol_hash_parameters.value())];
+    if (spelling.length() != word.length()) {
+        return TokenType::Identifier;
+    }
+    for (auto i = usize{ 0 }; i < word.length(); ++i) {
+        if (fold(word[i]) != static_cast<u32>(spelling[i])) {
+            return TokenType::Identifier;
+        }
+    }
+    return type;
+}
@@ -1,7 +1,79 @@
 #pragma once
 
 #include <common/common.hpp>
+#include <expected>
+#include "lexer/diagnostic.hpp"
+#include "lexer/lexer_options.hpp"
 #include "lexer/token.hpp"
+#include "lexer/token_buffer.hpp"
+#include "lexer/token_stream.hpp"
 #include "lexer_error.hpp"
 
-[[nodiscard]] std::vector<Token> tokenize(std::string_view path, std::string_view source);
+// `path` and `source` must outlive the returned tokens.
+[[nodiscard]] TokenBuffer tokenize(std::string_view path, std::string_view source);
+
+// Identifiers are interned into `interner`, which can be shared between multiple source files.
+[[nodiscard]] TokenBuffer tokenize(
+    std::shared_ptr<SourceFile const> file,
+    std::shared_ptr<Interner> interner = std::make_shared<Interner>(),
+    LexerOptions const& lexer_options = {}
+);
+
+// Like `tokenize()`, but instead of throwing, lexer errors are reported into `diagnostics`. This is much cheaper for
+// inputs that are likely to be invalid, and it also works when exceptions are disabled.
+[[nodiscard]] std::expected<TokenBuffer, DiagnosticId> try_tokenize(
+    Diagnostics& diagnostics,
+    std::shared_ptr<SourceFile const> file,
+    std::shared_ptr<Interner> interner = std::make_shared<Interner>(),
+    LexerOptions const& lexer_options = {}
+);
+
+struct ParallelLexingOptions final {
+    usize num_threads = 0;  // Zero means one thread per hardware thread.
+    usize min_chunk_size = usize{ 1 } << 20;  // Smaller sources are lexed on the calling thread.
+};
+
+// Splits the source into chunks that are lexed concurrently and stitches the results. The tokens, the symbols, and
+// the error that is thrown (if any) are the same as those of `tokenize()`.
+[[nodiscard]] TokenBuffer tokenize_parallel(
+    std::shared_ptr<SourceFile const> file,
+    std::shared_ptr<Interner> interner = std::make_shared<Interner>(),
+    ParallelLexingOptions const& options = {},
+    LexerOptions const& lexer_options = {}
+);
+
+// Like `tokenize_parallel()`, but reports lexer errors into `diagnostics` (see `try_tokenize()`).
+[[nodiscard]] std::expected<TokenBuffer, DiagnosticId> try_tokenize_parallel(
+    Diagnostics& diagnostics,
+    std::shared_ptr<SourceFile const> file,
+    std::shared_ptr<Interner> interner = std::make_shared<Interner>(),
+    ParallelLexingOptions const& options = {},
+    LexerOptions const& lexer_options = {}
+);
+
+// Replaces `removed_length` characters at `offset` (within the previous source) with `inserted_text`.
+struct SourceEdit final {
+    usize offset;
+    usize removed_length;
+    std::string_view inserted_text;
+};
+
+// Applies `edit` to the source of `previous` and only re-lexes the region whose tokens may have changed: It restarts
+// at the last token that cannot have been affected by the edit and stops as soon as the new tokens line up with the
+// old ones again. The tokens after that are taken over with shifted offsets. The result has the same tokens, symbols,
+// and literal values as tokenizing the edited source with the interner of `previous`, and it owns the edited source.
+// The path of `previous` must outlive the result.
+// `lexer_options` must be the options that `previous` has been lexed with.
+[[nodiscard]] TokenBuffer relex(
+    TokenBuffer const& previous,
+    SourceEdit const& edit,
+    LexerOptions const& lexer_options = {}
+);
+
+// Like `relex()`, but reports lexer errors into `diagnostics` (see `try_tokenize()`).
+[[nodiscard]] std::expected<TokenBuffer, DiagnosticId> try_relex(
+    Diagnostics& diagnostics,
+    TokenBuffer const& previous,
+    SourceEdit const& edit,
+    LexerOptions const& lexer_options = {}
+);
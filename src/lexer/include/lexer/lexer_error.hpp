@@ -1,8 +1,8 @@
 #pragma once
 
-#include <format>
 #include <stdexcept>
 #include <string>
+#include "diagnostic.hpp"
 #include "source_location.hpp"
 
 class LexerError : public std::runtime_error {
@@ -10,8 +10,8 @@ private:
     SourceLocation m_source_location;
 
 protected:
-    [[nodiscard]] explicit LexerError(std::string const& message, SourceLocation const& source_location)
-        : std::runtime_error{ message }, m_source_location{ source_location } {}
+    [[nodiscard]] explicit LexerError(Diagnostic const& diagnostic)
+        : std::runtime_error{ diagnostic.message() }, m_source_location{ diagnostic.source_location() } {}
 
 public:
     [[nodiscard]] SourceLocation const& source_location() const {
@@ -22,7 +22,13 @@ public:
 class NonAsciiCharacter final : public LexerError {
 public:
     [[nodiscard]] explicit NonAsciiCharacter(SourceLocation const& source_location)
-        : LexerError{ "Non-ASCII character", source_location } {}
+        : LexerError{ Diagnostic{ DiagnosticKind::NonAsciiCharacter, source_location } } {}
+};
+
+class InvalidUtf8 final : public LexerError {
+public:
+    [[nodiscard]] explicit InvalidUtf8(SourceLocation const& source_location)
+        : LexerError{ Diagnostic{ DiagnosticKind::InvalidUtf8, source_location } } {}
 };
 
 class UnexpectedCharacter final : public LexerError {
@@ -32,26 +38,26 @@ public:
         char const actual,
         char const* const expected
     )
-        : LexerError{
-              std::isprint(static_cast<unsigned char>(actual))
-                  ? std::format("Unexpected character: Got '{}', expected {}", actual, expected)
-                  : std::format(
-                        "Unexpected character: Got non-printable character #{}, expected {}",
-                        static_cast<int>(actual),
-                        expected
-                    ),
-              source_location,
-          } {}
+        : LexerError{ Diagnostic::unexpected_character(source_location, actual, expected) } {}
 };
 
 class UnterminatedCharacterString final : public LexerError {
 public:
     [[nodiscard]] explicit UnterminatedCharacterString(SourceLocation const& source_location)
-        : LexerError{ "Unterminated character string", source_location } {}
+        : LexerError{ Diagnostic{ DiagnosticKind::UnterminatedCharacterString, source_location } } {}
 };
 
 class UnterminatedComment final : public LexerError {
 public:
     [[nodiscard]] explicit UnterminatedComment(SourceLocation const& source_location)
-        : LexerError{ "Unterminated comment", source_location } {}
+        : LexerError{ Diagnostic{ DiagnosticKind::UnterminatedComment, source_location } } {}
 };
+
+class SourceFileTooLarge final : public LexerError {
+public:
+    [[nodiscard]] explicit SourceFileTooLarge(SourceLocation const& source_location)
+        : LexerError{ Diagnostic{ DiagnosticKind::SourceFileTooLarge, source_location } } {}
+};
+
+// Throws the exception that corresponds to a lexer error reported by one of the `try_` functions.
+[[noreturn]] void throw_lexer_error(Diagnostic const& diagnostic);
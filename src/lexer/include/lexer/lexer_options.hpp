@@ -0,0 +1,17 @@
+#pragma once
+
+// Determines where UTF-8 encoded characters are accepted. Everywhere else, non-ASCII characters are rejected with a
+// `NonAsciiCharacter` error.
+enum class Utf8Mode {
+    // The contents of comments are not checked at all.
+    Off,
+    // The contents of comments must be well-formed UTF-8.
+    Comments,
+    // Additionally, character strings may contain UTF-8 encoded characters. Their values are the UTF-8 encoded bytes,
+    // so a single non-ASCII character within apostrophes is a string and not a character value.
+    CommentsAndStrings,
+};
+
+struct LexerOptions final {
+    Utf8Mode utf8_mode = Utf8Mode::Off;
+};
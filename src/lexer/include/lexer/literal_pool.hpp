@@ -0,0 +1,53 @@
+#pragma once
+
+#include <deque>
+#include <lib2k/types.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+// Identifies the decoded value of a number, character, or string literal within a `LiteralPool`.
+enum class Literal : u32 {
+    None = 0xFFFF'FFFF,  // Used for tokens that are not literals and for numbers that are out of range.
+};
+
+enum class LiteralKind : u8 {
+    Integer,
+    Real,
+    String,  // Also used for characters.
+};
+
+// Stores the values of literals, which the lexer decodes once so that later phases do not have to re-parse their
+// lexemes. Characters are stored as strings of length one. Each distinct value is stored once, so equal literals are
+// identified by the same `Literal`, and re-lexing a source does not make the pool grow. Reals are equal if their bit
+// patterns are, e.g., `0.0` and `-0.0` are distinct.
+class LiteralPool final {
+private:
+    std::vector<std::variant<i64, double, std::string_view>> m_values;  // Indexed by literal.
+    std::deque<std::string> m_strings;  // A deque, since its elements must not move.
+    std::unordered_map<i64, Literal> m_integer_literals;
+    std::unordered_map<u64, Literal> m_real_literals;  // By the bit pattern of the value.
+    std::unordered_map<std::string_view, Literal> m_string_literals;
+
+public:
+    [[nodiscard]] Literal intern_integer(i64 value);
+    [[nodiscard]] Literal intern_real(double value);
+    [[nodiscard]] Literal intern_string(std::string_view value);
+
+    // Adds the value of `literal` from `other` to this pool.
+    [[nodiscard]] Literal add_from(LiteralPool const& other, Literal literal);
+
+    [[nodiscard]] LiteralKind kind(Literal literal) const;
+    [[nodiscard]] i64 integer(Literal literal) const;
+    [[nodiscard]] double real(Literal literal) const;
+    [[nodiscard]] std::string_view string(Literal literal) const;
+
+    [[nodiscard]] usize size() const {
+        return m_values.size();
+    }
+
+private:
+    [[nodiscard]] Literal next_literal() const;
+};
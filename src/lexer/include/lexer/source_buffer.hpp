@@ -0,0 +1,50 @@
+#pragma once
+
+#include <filesystem>
+#include <lib2k/types.hpp>
+#include <string>
+#include <string_view>
+
+// Owns the contents of a source file. Regular files are memory-mapped read-only, everything else (pipes, terminals,
+// standard input, strings) is stored in a `std::string`.
+class SourceBuffer final {
+private:
+    char const* m_mapping = nullptr;
+    usize m_mapping_size = 0;
+    std::string m_contents;  // Only used if there is no mapping.
+
+    SourceBuffer() = default;
+
+public:
+    SourceBuffer(SourceBuffer const& other) = delete;
+    SourceBuffer(SourceBuffer&& other) noexcept;
+    SourceBuffer& operator=(SourceBuffer const& other) = delete;
+    SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+    ~SourceBuffer();
+
+    // Throws `std::runtime_error` if the file cannot be opened or read.
+    [[nodiscard]] static SourceBuffer from_file(std::filesystem::path const& path);
+
+    // Throws `std::runtime_error` if standard input cannot be read.
+    [[nodiscard]] static SourceBuffer from_standard_input();
+
+    [[nodiscard]] static SourceBuffer from_string(std::string contents);
+
+    [[nodiscard]] bool is_memory_mapped() const {
+        return m_mapping != nullptr;
+    }
+
+    // The view is invalidated when the buffer is moved from (unless it is memory-mapped).
+    [[nodiscard]] std::string_view contents() const {
+        if (is_memory_mapped()) {
+            return std::string_view{ m_mapping, m_mapping_size };
+        }
+        return m_contents;
+    }
+
+private:
+    // Maps regular files and reads everything else. Only available on POSIX systems.
+    [[nodiscard]] static SourceBuffer from_file_descriptor(int file_descriptor, std::string_view what);
+
+    void unmap();
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <common/common.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "source_buffer.hpp"
+
+// Source files are always owned by a `std::shared_ptr`. This allows tokens to refer to their source file through a
+// plain pointer and still hand out owning `SourceLocation`s.
+//
+// The line index is built on the first query that needs it, so creating a source file does not read the source. This
+// keeps loading a serialized AST independent of the size of its source.
+class SourceFile final : public std::enable_shared_from_this<SourceFile> {
+private:
+    std::string_view m_path;
+    std::optional<SourceBuffer> m_buffer;  // Empty if the source is owned by the caller.
+    std::shared_ptr<void const> m_owner;   // Keeps the memory of `m_path` and `m_source` alive, if set.
+    std::string_view m_source;
+    mutable std::once_flag m_line_starts_flag;
+    mutable std::vector<usize> m_line_starts;  // Offset of the first character of each line (sorted, starts with 0).
+
+public:
+    // `path` and `source` must outlive this object.
+    [[nodiscard]] explicit SourceFile(std::string_view const path, std::string_view const source)
+        : m_path{ path }, m_source{ source } {}
+
+    // `path` must outlive this object. The contents of `buffer` live as long as this object.
+    [[nodiscard]] explicit SourceFile(std::string_view const path, SourceBuffer buffer)
+        : m_path{ path }, m_buffer{ std::move(buffer) }, m_source{ m_buffer->contents() } {}
+
+    // `path` and `source` point into memory owned by `owner`, e.g., a serialized AST that contains the source. It
+    // lives as long as this object.
+    [[nodiscard]] explicit SourceFile(
+        std::string_view const path,
+        std::string_view const source,
+        std::shared_ptr<void const> owner
+    )
+        : m_path{ path }, m_owner{ std::move(owner) }, m_source{ source } {}
+
+    [[nodiscard]] std::string_view const& path() const {
+        return m_path;
+    }
+
+    [[nodiscard]] std::string_view source() const {
+        return m_source;
+    }
+
+    [[nodiscard]] usize num_lines() const {
+        return line_starts().size();
+    }
+
+    // Returns the zero-based index of the line that contains the given offset.
+    [[nodiscard]] usize line_index(usize const offset) const {
+        auto const& starts = line_starts();
+        auto const next_line = std::ranges::upper_bound(starts, offset);
+        return static_cast<usize>(next_line - starts.cbegin()) - 1;
+    }
+
+    [[nodiscard]] usize line_start(usize const line_index) const {
+        return line_starts().at(line_index);
+    }
+
+    // Returns the zero-based column of the given offset within the given line. Columns count code points, i.e. UTF-8
+    // continuation bytes do not start a new column. For ASCII, this is the distance from the start of the line.
+    [[nodiscard]] usize column_index(usize const line_index, usize const offset) const {
+        auto const start = line_start(line_index);
+        auto const prefix = m_source.substr(start, offset - start);
+        auto const num_continuation_bytes = std::ranges::count_if(prefix, [](char const c) {
+            return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+        });
+        return prefix.size() - static_cast<usize>(num_continuation_bytes);
+    }
+
+    // Returns the contents of the given line without the terminating newline character.
+    [[nodiscard]] std::string_view line(usize const line_index) const {
+        auto const start = line_start(line_index);
+        auto const& starts = line_starts();
+        auto const end = line_index + 1 < starts.size() ? starts.at(line_index + 1) - 1 : m_source.size();
+        return m_source.substr(start, end - start);
+    }
+
+private:
+    // Thread-safe, since source files are shared between the threads of the parallel lexer.
+    [[nodiscard]] std::vector<usize> const& line_starts() const {
+        std::call_once(m_line_starts_flag, [this] { m_line_starts = find_line_starts(m_source); });
+        return m_line_starts;
+    }
+
+    [[nodiscard]] static std::vector<usize> find_line_starts(std::string_view const source) {
+        auto line_starts = std::vector<usize>{ 0 };
+        // `find()` is implemented in terms of `memchr()`, which is vectorized by all major standard libraries.
+        for (auto newline = source.find('\n'); newline != std::string_view::npos;
+             newline = source.find('\n', newline + 1)) {
+            line_starts.push_back(newline + 1);
+        }
+        return line_starts;
+    }
+};
@@ -1,10 +1,11 @@
 #pragma once
 
 #include <common/common.hpp>
+#include <format>
+#include <memory>
+#include "source_file.hpp"
 
 class SourceLocation final {
-    friend class Lexer;
-
 public:
     struct Position final {
         usize start_line;
@@ -24,92 +25,63 @@ public:
     };
 
 private:
-    std::string_view m_path;
-    std::string_view m_source;
+    std::shared_ptr<SourceFile const> m_file;
     usize m_offset;
     usize m_length;
 
 public:
-    [[nodiscard]] explicit constexpr SourceLocation(
-        std::string_view const path,
-        std::string_view const source,
-        usize const offset,
-        usize const length
-    )
-        : m_path{ path }, m_source{ source }, m_offset{ offset }, m_length{ length } {}
+    [[nodiscard]] explicit SourceLocation(std::shared_ptr<SourceFile const> file, usize const offset, usize const length)
+        : m_file{ std::move(file) }, m_offset{ offset }, m_length{ length } {}
 
     [[nodiscard]] Position position() const {
-        auto start_line = usize{ 1 };
-        auto start_column = usize{ 1 };
-        for (auto offset = usize{ 0 }; offset < m_offset; ++offset) {
-            if (m_source.at(offset) == '\n') {
-                ++start_line;
-                start_column = 1;
-            } else {
-                ++start_column;
-            }
-        }
-        auto end_line = start_line;
-        auto end_column = start_column;
-        for (auto offset = m_offset; offset < std::min(m_offset + m_length, m_source.length()); ++offset) {
-            if (m_source.at(offset) == '\n') {
-                ++end_line;
-                end_column = 1;
-            } else {
-                ++end_column;
-            }
-        }
-        return Position{ start_line, start_column, end_line, end_column };
+        auto const end_offset = std::min(m_offset + m_length, m_file->source().length());
+        auto const start_line = m_file->line_index(m_offset);
+        auto const end_line = m_file->line_index(end_offset);
+        return Position{
+            start_line + 1,
+            m_file->column_index(start_line, m_offset) + 1,
+            end_line + 1,
+            m_file->column_index(end_line, end_offset) + 1,
+        };
     }
 
-    [[nodiscard]] constexpr std::string_view text() const {
-        using Difference = decltype(m_source)::difference_type;
-        auto const begin = m_source.cbegin() + static_cast<Difference>(m_offset);
+    [[nodiscard]] std::string_view text() const {
+        auto const source = m_file->source();
+        using Difference = decltype(source)::difference_type;
+        auto const begin = source.cbegin() + static_cast<Difference>(m_offset);
         auto const end = begin + static_cast<Difference>(m_length);
         return std::string_view{ begin, end };
     }
 
-    [[nodiscard]] constexpr std::string_view const& path() const {
-        return m_path;
+    [[nodiscard]] std::string_view const& path() const {
+        return m_file->path();
     }
 
-    [[nodiscard]] constexpr usize length() const {
+    [[nodiscard]] usize length() const {
         return m_length;
     }
 
-    [[nodiscard]] constexpr SourceLocation end() const {
-        return SourceLocation{ m_path, m_source, m_offset + m_length, 0 };
+    [[nodiscard]] SourceLocation end() const {
+        return SourceLocation{ m_file, m_offset + m_length, 0 };
     }
 
-    [[nodiscard]] constexpr SourceLocation join(SourceLocation const& other) const {
+    [[nodiscard]] SourceLocation join(SourceLocation const& other) const {
         auto const begin = std::min(m_offset, other.m_offset);
         auto const end = std::max(m_offset + m_length, other.m_offset + other.m_length);
-        return SourceLocation{ m_path, m_source, begin, end - begin };
+        return SourceLocation{ m_file, begin, end - begin };
     }
 
     [[nodiscard]] std::vector<std::string_view> surrounding_lines() const {
-        auto line_start = m_offset;
-        while (line_start > 0 and m_source.at(line_start - 1) != '\n') {
-            --line_start;
-        }
+        auto const end_offset = std::min(m_offset + m_length, m_file->source().length());
+        auto const first_line = m_file->line_index(m_offset);
+        // The last line is the one containing the last character of this location (not the one after it).
+        auto const last_line = end_offset > m_offset ? m_file->line_index(end_offset - 1) : first_line;
 
         auto lines = std::vector<std::string_view>{};
-
-        auto offset = usize{ 0 };
-        for (offset = m_offset; offset < std::min(m_source.size(), m_offset + m_length); ++offset) {
-            if (m_source.at(offset) == '\n') {
-                lines.emplace_back(m_source.cbegin() + line_start, m_source.cbegin() + offset);
-                line_start = offset + 1;
-            }
-        }
-
-        for (; offset < m_source.size(); ++offset) {
-            if (m_source.at(offset) == '\n') {
-                lines.emplace_back(m_source.cbegin() + line_start, m_source.cbegin() + offset);
-                break;
-            }
+        lines.reserve(last_line - first_line + 1);
+        for (auto line = first_line; line <= last_line; ++line) {
+            lines.push_back(m_file->line(line));
         }
-
         return lines;
     }
 };
@@ -1,28 +1,82 @@
 #pragma once
 
 #include <format>
+#include <lib2k/types.hpp>
+#include "interner.hpp"
 #include "source_location.hpp"
+#include "token_properties.hpp"
 #include "token_type.hpp"
 
+// A lightweight handle to a token. It does not own the source file it refers to, so it must not outlive the
+// `TokenBuffer` (or the `Ast`) it has been taken from.
 class Token final {
 private:
+    SourceFile const* m_file;
+    u32 m_offset;
+    u32 m_length;
+    u32 m_value;  // The symbol of an identifier or the literal of a number, character, or string.
     TokenType m_type;
-    SourceLocation m_source_location;
 
 public:
-    [[nodiscard]] constexpr Token(TokenType const type, SourceLocation const& source_location)
-        : m_type{ type }, m_source_location{ source_location } {}
+    [[nodiscard]] Token(
+        TokenType const type,
+        SourceFile const& file,
+        u32 const offset,
+        u32 const length,
+        Symbol const symbol = Symbol::None
+    )
+        : m_file{ &file },
+          m_offset{ offset },
+          m_length{ length },
+          m_value{ static_cast<u32>(symbol) },
+          m_type{ type } {}
+
+    [[nodiscard]] Token(
+        TokenType const type,
+        SourceFile const& file,
+        u32 const offset,
+        u32 const length,
+        Literal const literal
+    )
+        : m_file{ &file },
+          m_offset{ offset },
+          m_length{ length },
+          m_value{ static_cast<u32>(literal) },
+          m_type{ type } {}
 
     [[nodiscard]] TokenType type() const {
         return m_type;
     }
 
-    [[nodiscard]] SourceLocation const& source_location() const {
-        return m_source_location;
+    // The interned name of an identifier token, `Symbol::None` for all other tokens.
+    [[nodiscard]] Symbol symbol() const {
+        return m_type == TokenType::Identifier ? Symbol{ m_value } : Symbol::None;
+    }
+
+    // The decoded value of a number, character, or string token within the literal pool of the interner.
+    // `Literal::None` for all other tokens and for numbers that are out of range.
+    [[nodiscard]] Literal literal() const {
+        return is_literal(m_type) ? Literal{ m_value } : Literal::None;
+    }
+
+    [[nodiscard]] SourceFile const& file() const {
+        return *m_file;
+    }
+
+    [[nodiscard]] u32 offset() const {
+        return m_offset;
+    }
+
+    [[nodiscard]] u32 length() const {
+        return m_length;
+    }
+
+    [[nodiscard]] SourceLocation source_location() const {
+        return SourceLocation{ m_file->shared_from_this(), m_offset, m_length };
     }
 
     [[nodiscard]] std::string_view lexeme() const {
-        return m_source_location.text();
+        return m_file->source().substr(m_offset, m_length);
     }
 };
 
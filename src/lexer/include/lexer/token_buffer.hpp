@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cassert>
+#include <common/common.hpp>
+#include <cstddef>
+#include <lib2k/types.hpp>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "interner.hpp"
+#include "source_file.hpp"
+#include "token.hpp"
+#include "token_properties.hpp"
+#include "token_type.hpp"
+
+namespace detail {
+    // Default-initializes instead of value-initializing, so that growing a vector via `resize()` does not write
+    // zeros that are overwritten anyway. Not `final`, since standard containers may derive from their allocator.
+    template<typename T>
+    class DefaultInitAllocator : public std::allocator<T> {
+    public:
+        template<typename U>
+        struct rebind final {
+            using other = DefaultInitAllocator<U>;
+        };
+
+        using std::allocator<T>::allocator;
+
+        template<typename U>
+        void construct(U* const pointer) noexcept(std::is_nothrow_default_constructible_v<U>) {
+            ::new (static_cast<void*>(pointer)) U;
+        }
+
+        template<typename U, typename... Args>
+        void construct(U* const pointer, Args&&... args) {
+            std::construct_at(pointer, std::forward<Args>(args)...);
+        }
+    };
+
+    template<typename T>
+    using UninitializedVector = std::vector<T, DefaultInitAllocator<T>>;
+}  // namespace detail
+
+// Stores the tokens of a source file as parallel arrays. The source file and the interner that the symbols of the
+// identifiers belong to are only stored once. Individual tokens can be accessed through `Token` handles.
+class TokenBuffer final {
+private:
+    std::shared_ptr<SourceFile const> m_file;
+    std::shared_ptr<Interner> m_interner;
+    detail::UninitializedVector<TokenType> m_types;
+    detail::UninitializedVector<u32> m_offsets;
+    detail::UninitializedVector<u32> m_lengths;
+    detail::UninitializedVector<u32> m_values;  // Symbols of identifiers and literals of literal tokens.
+
+public:
+    [[nodiscard]] explicit TokenBuffer(std::shared_ptr<SourceFile const> file, std::shared_ptr<Interner> interner)
+        : m_file{ std::move(file) }, m_interner{ std::move(interner) } {}
+
+    [[nodiscard]] std::shared_ptr<SourceFile const> const& file() const {
+        return m_file;
+    }
+
+    [[nodiscard]] std::shared_ptr<Interner> const& interner() const {
+        return m_interner;
+    }
+
+    [[nodiscard]] usize size() const {
+        return m_types.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return m_types.empty();
+    }
+
+    [[nodiscard]] std::span<TokenType const> types() const {
+        return m_types;
+    }
+
+    [[nodiscard]] TokenType type(usize const index) const {
+        assert(index < size());
+        return m_types[index];
+    }
+
+    [[nodiscard]] u32 offset(usize const index) const {
+        assert(index < size());
+        return m_offsets[index];
+    }
+
+    [[nodiscard]] u32 length(usize const index) const {
+        assert(index < size());
+        return m_lengths[index];
+    }
+
+    [[nodiscard]] Symbol symbol(usize const index) const {
+        return type(index) == TokenType::Identifier ? Symbol{ m_values[index] } : Symbol::None;
+    }
+
+    [[nodiscard]] Literal literal(usize const index) const {
+        return is_literal(type(index)) ? Literal{ m_values[index] } : Literal::None;
+    }
+
+    [[nodiscard]] Token operator[](usize const index) const {
+        if (is_literal(type(index))) {
+            return Token{ type(index), *m_file, offset(index), length(index), literal(index) };
+        }
+        return Token{ type(index), *m_file, offset(index), length(index), symbol(index) };
+    }
+
+    [[nodiscard]] Token at(usize const index) const {
+        if (index >= size()) {
+            throw_or_abort(std::out_of_range{ "Token index out of range." });
+        }
+        return (*this)[index];
+    }
+
+    [[nodiscard]] Token back() const {
+        return (*this)[size() - 1];
+    }
+
+    // The number of bytes allocated by the arrays, including their unused capacity.
+    [[nodiscard]] usize memory_usage() const {
+        return m_types.capacity() * sizeof(TokenType) + m_offsets.capacity() * sizeof(u32)
+               + m_lengths.capacity() * sizeof(u32) + m_values.capacity() * sizeof(u32);
+    }
+
+    void reserve(usize const capacity) {
+        m_types.reserve(capacity);
+        m_offsets.reserve(capacity);
+        m_lengths.reserve(capacity);
+        m_values.reserve(capacity);
+    }
+
+    // Tokens added by growing the buffer are uninitialized and must be overwritten via `assign()`.
+    void resize(usize const size) {
+        m_types.resize(size);
+        m_offsets.resize(size);
+        m_lengths.resize(size);
+        m_values.resize(size);
+    }
+
+    void assign(usize const index, Token const& token) {
+        assert(index < size());
+        m_types[index] = token.type();
+        m_offsets[index] = token.offset();
+        m_lengths[index] = token.length();
+        m_values[index] = value_of(token);
+    }
+
+    void push_back(TokenType const type, u32 const offset, u32 const length, Symbol const symbol = Symbol::None) {
+        push_back(type, offset, length, static_cast<u32>(symbol));
+    }
+
+    void push_back(TokenType const type, u32 const offset, u32 const length, Literal const literal) {
+        push_back(type, offset, length, static_cast<u32>(literal));
+    }
+
+    void push_back(Token const& token) {
+        push_back(token.type(), token.offset(), token.length(), value_of(token));
+    }
+
+    // Appends the tokens `[begin, end)` of `other`, which must share the interner, with their offsets moved by
+    // `offset_delta`.
+    void append(TokenBuffer const& other, usize const begin, usize const end, i64 const offset_delta = 0) {
+        assert(begin <= end and end <= other.size() and other.m_interner == m_interner);
+        auto const first = static_cast<std::ptrdiff_t>(begin);
+        auto const last = static_cast<std::ptrdiff_t>(end);
+        m_types.insert(m_types.cend(), other.m_types.cbegin() + first, other.m_types.cbegin() + last);
+        m_lengths.insert(m_lengths.cend(), other.m_lengths.cbegin() + first, other.m_lengths.cbegin() + last);
+        m_values.insert(m_values.cend(), other.m_values.cbegin() + first, other.m_values.cbegin() + last);
+        m_offsets.reserve(m_offsets.size() + (end - begin));
+        for (auto i = begin; i < end; ++i) {
+            m_offsets.push_back(static_cast<u32>(i64{ other.m_offsets[i] } + offset_delta));
+        }
+    }
+
+private:
+    void push_back(TokenType const type, u32 const offset, u32 const length, u32 const value) {
+        m_types.push_back(type);
+        m_offsets.push_back(offset);
+        m_lengths.push_back(length);
+        m_values.push_back(value);
+    }
+
+    [[nodiscard]] static u32 value_of(Token const& token) {
+        return is_literal(token.type()) ? static_cast<u32>(token.literal()) : static_cast<u32>(token.symbol());
+    }
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <lib2k/types.hpp>
+#include <magic_enum.hpp>
+#include "keywords.hpp"
+#include "token_type.hpp"
+
+namespace detail {
+    enum TokenTypeProperty : u8 {
+        WordLike = 1U << 0,
+        NumberLike = 1U << 1,
+        NeedsSeparator = 1U << 2,
+        HasLiteral = 1U << 3,
+    };
+
+    inline constexpr auto num_token_types = magic_enum::enum_count<TokenType>();
+    static_assert(static_cast<usize>(TokenType::EndOfFile) + 1 == num_token_types);
+
+    [[nodiscard]] constexpr std::array<u8, num_token_types> build_token_type_properties() {
+        auto properties = std::array<u8, num_token_types>{};
+        auto const add = [&](TokenType const type, u8 const property) {
+            properties[static_cast<usize>(type)] = static_cast<u8>(properties[static_cast<usize>(type)] | property);
+        };
+        for (auto const& [spelling, type] : word_symbols) {
+            add(type, WordLike | NeedsSeparator);
+        }
+        add(TokenType::Identifier, WordLike | NeedsSeparator);
+        add(TokenType::Directive, WordLike | NeedsSeparator);
+        add(TokenType::IntegerNumber, NumberLike | NeedsSeparator);
+        add(TokenType::RealNumber, NumberLike | NeedsSeparator);
+        add(TokenType::IntegerNumber, HasLiteral);
+        add(TokenType::RealNumber, HasLiteral);
+        add(TokenType::CharValue, HasLiteral);
+        add(TokenType::StringValue, HasLiteral);
+        return properties;
+    }
+
+    inline constexpr auto token_type_properties = build_token_type_properties();
+
+    [[nodiscard]] constexpr bool has_property(TokenType const type, TokenTypeProperty const property) {
+        return (token_type_properties[static_cast<usize>(type)] & property) != 0;
+    }
+}  // namespace detail
+
+// Word symbols, identifiers, directives, and the required type identifiers that have their own token types.
+[[nodiscard]] constexpr bool is_word_like(TokenType const type) {
+    return detail::has_property(type, detail::WordLike);
+}
+
+// Unsigned integers and unsigned reals.
+[[nodiscard]] constexpr bool is_number_like(TokenType const type) {
+    return detail::has_property(type, detail::NumberLike);
+}
+
+// 6.1.9: Two adjacent tokens with this property must be separated by at least one token separator.
+[[nodiscard]] constexpr bool needs_separator(TokenType const type) {
+    return detail::has_property(type, detail::NeedsSeparator);
+}
+
+// Tokens whose values are decoded by the lexer.
+[[nodiscard]] constexpr bool is_literal(TokenType const type) {
+    return detail::has_property(type, detail::HasLiteral);
+}
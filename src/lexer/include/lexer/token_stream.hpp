@@ -0,0 +1,53 @@
+#pragma once
+
+#include <deque>
+#include <lib2k/types.hpp>
+#include <memory>
+#include <string_view>
+#include <tl/optional.hpp>
+#include "diagnostic.hpp"
+#include "interner.hpp"
+#include "lexer_options.hpp"
+#include "source_file.hpp"
+#include "token.hpp"
+
+class Lexer;
+
+// Lexes tokens on demand. Only the tokens that have been peeked at but not consumed yet are kept in memory. Lexer
+// errors are thrown by `peek()` as soon as the offending token is reached.
+class TokenStream final {
+private:
+    std::unique_ptr<Lexer> m_lexer;
+    std::deque<Token> m_lookahead;
+
+public:
+    // `path` and `source` must outlive the stream and all tokens taken from it.
+    [[nodiscard]] TokenStream(std::string_view path, std::string_view source);
+    [[nodiscard]] explicit TokenStream(
+        std::shared_ptr<SourceFile const> file,
+        std::shared_ptr<Interner> interner = std::make_shared<Interner>(),
+        LexerOptions const& lexer_options = {}
+    );
+    TokenStream(TokenStream const& other) = delete;
+    TokenStream(TokenStream&& other) noexcept;
+    TokenStream& operator=(TokenStream const& other) = delete;
+    TokenStream& operator=(TokenStream&& other) noexcept;
+    ~TokenStream();
+
+    [[nodiscard]] std::shared_ptr<SourceFile const> const& file() const;
+    [[nodiscard]] std::shared_ptr<Interner> const& interner() const;
+
+    // Returns the token `offset` tokens after the current one. Past the end of the source, this is the end of file
+    // token.
+    [[nodiscard]] Token peek(usize offset = 0);
+
+    // Like `peek()`, but a lexer error ends the stream instead of being thrown: The offending token is replaced by the
+    // end of file token, and `error()` returns the error.
+    [[nodiscard]] Token peek_or_end(usize offset = 0);
+
+    // Consumes the current token (unless it is the end of file token).
+    void advance();
+
+    // The lexer error that ended the stream, if it has been reached.
+    [[nodiscard]] tl::optional<Diagnostic> const& error() const;
+};
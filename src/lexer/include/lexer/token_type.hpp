@@ -2,10 +2,11 @@
 
 #include <format>
 #include <iostream>
+#include <lib2k/types.hpp>
 #include <magic_enum.hpp>
 
 // 6.1.2
-enum class TokenType {
+enum class TokenType : u8 {
     // Spacial symbols.
     Plus,
     Minus,
@@ -0,0 +1,95 @@
+#include <common/common.hpp>
+#include <lexer/interner.hpp>
+#include <limits>
+#include <stdexcept>
+
+// Lowercases ASCII letters. Digits are not affected since they already have bit 5 set.
+[[nodiscard]] static char fold(char const c) {
+    return static_cast<char>(c | 0x20);
+}
+
+// FNV-1a of the case-folded spelling.
+[[nodiscard]] static u64 hash_folded(std::string_view const spelling) {
+    auto hash = u64{ 0xCBF2'9CE4'8422'2325 };
+    for (auto const c : spelling) {
+        hash ^= static_cast<u64>(static_cast<unsigned char>(fold(c)));
+        hash *= u64{ 0x0000'0100'0000'01B3 };
+    }
+    return hash;
+}
+
+// The slot at which probing starts. `mask` is the number of slots minus one.
+[[nodiscard]] static usize first_slot(u64 const hash, usize const mask) {
+    return hash & mask;
+}
+
+Interner::Interner()
+    : m_slots(usize{ 1024 }, empty_slot) {}
+
+Symbol Interner::intern(std::string_view const spelling) {
+    auto const hash = hash_folded(spelling);
+    auto const mask = m_slots.size() - 1;
+    for (auto slot = first_slot(hash, mask);; slot = (slot + 1) & mask) {
+        auto const entry = m_slots[slot];
+        if (entry == empty_slot) {
+            break;
+        }
+        if (matches(m_entries[entry - 1], spelling, hash)) {
+            return Symbol{ entry - 1 };
+        }
+    }
+
+    if (m_entries.size() >= std::numeric_limits<u32>::max() - 1
+        or m_spellings.size() + spelling.size() > std::numeric_limits<u32>::max()) {
+        throw_or_abort(std::length_error{ "Too many distinct identifiers." });
+    }
+
+    auto const symbol = static_cast<u32>(m_entries.size());
+    m_entries.push_back(Entry{ static_cast<u32>(m_spellings.size()), static_cast<u32>(spelling.size()), hash });
+    for (auto const c : spelling) {
+        m_spellings.push_back(fold(c));
+    }
+
+    // Keep the load factor at or below 1/2.
+    if (m_entries.size() * 2 > m_slots.size()) {
+        grow();
+    } else {
+        auto slot = first_slot(hash, mask);
+        while (m_slots[slot] != empty_slot) {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = symbol + 1;
+    }
+    return Symbol{ symbol };
+}
+
+std::string_view Interner::spelling(Symbol const symbol) const {
+    auto const& entry = m_entries.at(static_cast<usize>(symbol));
+    return std::string_view{ m_spellings }.substr(entry.offset, entry.length);
+}
+
+bool Interner::matches(Entry const& entry, std::string_view const spelling, u64 const hash) const {
+    if (entry.hash != hash or entry.length != spelling.size()) {
+        return false;
+    }
+    auto const stored = m_spellings.data() + entry.offset;
+    for (auto i = usize{ 0 }; i < spelling.size(); ++i) {
+        if (stored[i] != fold(spelling[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Doubles the number of slots and re-inserts all entries (including the one that has just been added).
+void Interner::grow() {
+    m_slots.assign(m_slots.size() * 2, empty_slot);
+    auto const mask = m_slots.size() - 1;
+    for (auto symbol = usize{ 0 }; symbol < m_entries.size(); ++symbol) {
+        auto slot = first_slot(m_entries[symbol].hash, mask);
+        while (m_slots[slot] != empty_slot) {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = static_cast<u32>(symbol + 1);
+    }
+}
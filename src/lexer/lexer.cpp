@@ -1,200 +1,213 @@
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <charconv>
+#include <exception>
+#include <expected>
+#include <lexer/diagnostic.hpp>
+#include <lexer/keywords.hpp>
 #include <lexer/lexer.hpp>
 #include <limits>
+#include <memory>
+#include <string>
+#include <lexer/token_properties.hpp>
+#include <lexer/token_stream.hpp>
 #include <ranges>
+#include <stdexcept>
+#include <thread>
+#include <tl/optional.hpp>
+#include <tracing/trace.hpp>
+#include <utility>
+#include <vector>
+#include "character_classes.hpp"
+#include "scanners.hpp"
+#include "utf8.hpp"
 
 class Lexer final {
 private:
-    std::string_view m_path;
+    std::shared_ptr<SourceFile const> m_file;
+    std::shared_ptr<Interner> m_interner;
+    LexerOptions m_options;
     std::string_view m_source;
     usize m_index = 0;
-    std::vector<Token> m_tokens;
+    TokenType m_previous_type = TokenType::EndOfFile;  // End of file means that there is no previous token.
+    tl::optional<Token> m_next_token;
     bool m_encountered_token_separator = true;
+    tl::optional<Diagnostic> m_error;
 
 public:
-    [[nodiscard]] Lexer(std::string_view const path, std::string_view const source)
-        : m_path{ path }, m_source{ source } {}
+    // Starts lexing at `start` as if the source was preceded by a token separator.
+    [[nodiscard]] explicit Lexer(
+        std::shared_ptr<SourceFile const> file,
+        std::shared_ptr<Interner> interner,
+        LexerOptions const& options = {},
+        usize const start = 0
+    )
+        : m_file{ std::move(file) },
+          m_interner{ std::move(interner) },
+          m_options{ options },
+          m_source{ m_file->source() },
+          m_index{ start } {
+        // Token offsets and lengths are stored as 32-bit integers.
+        if (m_source.size() > std::numeric_limits<u32>::max()) {
+            fail(Diagnostic{
+                DiagnosticKind::SourceFileTooLarge,
+                SourceLocation{ m_file, std::numeric_limits<u32>::max(), 1 },
+            });
+        }
+    }
 
-    void tokenize() {
-        while (not is_at_end()) {
-            if (not is_ascii(current())) {
-                throw NonAsciiCharacter{ current_source_location() };
-            }
+    [[nodiscard]] std::shared_ptr<SourceFile const> const& file() const {
+        return m_file;
+    }
 
-            // 6.1.8 Comments.
-            if (current() == '{' or (current() == '(' and peek() == '*')) {
-                advance();
-                while (not is_at_end()) {
-                    if (current() == '}') {
-                        break;
-                    }
-                    if (current() == '*' and peek() == ')') {
-                        advance();
-                        break;
-                    }
-                    advance();
-                }
-                if (is_at_end()) {
-                    throw UnterminatedComment{ current_source_location() };
-                }
-                advance();
-                m_encountered_token_separator = true;
-                continue;
-            }
+    [[nodiscard]] std::shared_ptr<Interner> const& interner() const {
+        return m_interner;
+    }
 
-            if (std::isspace(static_cast<unsigned char>(current()))) {
-                advance();
-                m_encountered_token_separator = true;
-                continue;
-            }
+    // The error that stopped lexing, if any.
+    [[nodiscard]] tl::optional<Diagnostic> const& error() const {
+        return m_error;
+    }
 
-            // 6.1.2 Special symbols.
-            switch (current_upper()) {
-                case '+':
-                    emit_token(TokenType::Plus);
-                    advance();
-                    break;
-                case '-':
-                    emit_token(TokenType::Minus);
-                    advance();
+    // Lexes the source until the next token has been found. Once the end of the source has been reached or an error
+    // has occurred, every call returns an end of file token.
+    [[nodiscard]] Token next_token() {
+        while (not m_next_token.has_value() and not is_at_end() and not m_error.has_value()) {
+            // The class of the current character alone determines which kind of token (or token separator) starts
+            // here, so every iteration branches only once.
+            switch (character_class(current())) {
+                case CharacterClass::Whitespace:
+                    // Most token separators are a single space or line break, which is not worth calling a scanner.
+                    ++m_index;
+                    if (not is_at_end() and character_class(current()) == CharacterClass::Whitespace) {
+                        m_index = skip_whitespace(m_source, m_index + 1);
+                    }
+                    m_encountered_token_separator = true;
                     break;
-                case '*':
-                    emit_token(TokenType::Asterisk);
-                    advance();
+                case CharacterClass::LeftCurlyBracket:
+                    comment();
                     break;
-                case '/':
-                    emit_token(TokenType::Slash);
-                    advance();
+                case CharacterClass::LeftParenthesis:
+                    switch (peek()) {
+                        case '*':
+                            comment();
+                            break;
+                        case '.':
+                            // (.
+                            emit_token(TokenType::LeftSquareBracket, 2);
+                            m_index += 2;
+                            break;
+                        default:
+                            emit_token(TokenType::LeftParenthesis);
+                            ++m_index;
+                            break;
+                    }
                     break;
-                case '=':
-                    emit_token(TokenType::Equals);
-                    advance();
+                case CharacterClass::SingleCharacterSymbol:
+                    // 6.1.2 Special symbols.
+                    emit_token(single_character_symbol(current()));
+                    ++m_index;
                     break;
-                case '<':
+                case CharacterClass::LessThan:
                     switch (peek()) {
                         case '>':
                             // <>
                             emit_token(TokenType::LessThanGreaterThan, 2);
-                            advance();
+                            m_index += 2;
                             break;
                         case '=':
                             // <=
                             emit_token(TokenType::LessThanEquals, 2);
-                            advance();
+                            m_index += 2;
                             break;
                         default:
                             emit_token(TokenType::LessThan);
+                            ++m_index;
                             break;
                     }
-                    advance();
                     break;
-                case '>':
+                case CharacterClass::GreaterThan:
                     if (peek() == '=') {
                         // >=
                         emit_token(TokenType::GreaterThanEquals, 2);
-                        advance();
+                        m_index += 2;
                     } else {
                         emit_token(TokenType::GreaterThan);
+                        ++m_index;
                     }
-                    advance();
                     break;
-                case '[':
-                    emit_token(TokenType::LeftSquareBracket);
-                    advance();
-                    break;
-                case ']':
-                    emit_token(TokenType::RightSquareBracket);
-                    advance();
-                    break;
-                case '.':
+                case CharacterClass::Dot:
                     switch (peek()) {
                         case ')':
+                            // .)
                             emit_token(TokenType::RightSquareBracket, 2);
-                            advance();
+                            m_index += 2;
                             break;
                         case '.':
                             emit_token(TokenType::DotDot, 2);
-                            advance();
+                            m_index += 2;
                             break;
                         default:
                             emit_token(TokenType::Dot);
+                            ++m_index;
                             break;
                     }
-                    advance();
-                    break;
-                case ',':
-                    emit_token(TokenType::Comma);
-                    advance();
                     break;
-                case ':':
+                case CharacterClass::Colon:
                     if (peek() == '=') {
                         emit_token(TokenType::ColonEquals, 2);
-                        advance();
+                        m_index += 2;
                     } else {
                         emit_token(TokenType::Colon);
+                        ++m_index;
                     }
-                    advance();
                     break;
-                case ';':
-                    emit_token(TokenType::Semicolon);
-                    advance();
+                case CharacterClass::Apostrophe:
+                    character_or_string();
                     break;
-                case '^':
-                case '@':
-                    emit_token(TokenType::UpArrow);
-                    advance();
+                case CharacterClass::Digit:
+                    number();
                     break;
-                case '(':
-                    if (peek() == '.') {
-                        emit_token(TokenType::LeftSquareBracket, 2);
-                        advance();
-                    } else {
-                        emit_token(TokenType::LeftParenthesis);
-                    }
-                    advance();
+                case CharacterClass::Letter:
+                    word_symbol_or_identifier();
                     break;
-                case ')':
-                    emit_token(TokenType::RightParenthesis);
-                    advance();
+                case CharacterClass::NonAscii:
+                    fail(Diagnostic{ DiagnosticKind::NonAsciiCharacter, current_source_location() });
                     break;
-                case '\'':
-                    character_or_string();
+                case CharacterClass::Invalid:
+                    fail(Diagnostic::unexpected_character(
+                        current_source_location(),
+                        current(),
+                        "number, word symbol, or identifier"
+                    ));
                     break;
-                default: {
-                    // Number, word symbol, or identifier.
-                    if (is_digit(current())) {
-                        number();
-                        continue;
-                    }
-                    if (not is_letter(current_upper())) {
-                        throw UnexpectedCharacter{
-                            current_source_location(),
-                            current(),
-                            "number, word symbol, or identifier",
-                        };
-                    }
-                    word_symbol_or_identifier();
-                    break;
-                }
             }
         }
-        emit_token(TokenType::EndOfFile);
+        if (m_error.has_value()) {
+            // The source size may exceed the range of token offsets.
+            auto const end = std::min(m_source.size(), usize{ std::numeric_limits<u32>::max() });
+            return Token{ TokenType::EndOfFile, *m_file, static_cast<u32>(end), 0 };
+        }
+        if (not m_next_token.has_value()) {
+            emit_token(TokenType::EndOfFile);
+        }
+        return *std::exchange(m_next_token, tl::nullopt);
     }
 
-    [[nodiscard]] std::vector<Token> take_tokens() & = delete;
-
-    [[nodiscard]] std::vector<Token> take_tokens() && {
-        return std::move(m_tokens);
+private:
+    // Stops lexing: From now on, `next_token()` only returns end of file tokens. Errors are recorded instead of thrown,
+    // so that the `try_` functions do not depend on exceptions.
+    void fail(Diagnostic diagnostic) {
+        m_error = std::move(diagnostic);
     }
 
-private:
     [[nodiscard]] bool is_at_end() const {
         return m_index >= m_source.size();
     }
 
     [[nodiscard]] char current() const {
-        return is_at_end() ? '\0' : m_source.at(m_index);
+        return is_at_end() ? '\0' : m_source[m_index];
     }
 
     [[nodiscard]] char current_upper() const {
@@ -209,15 +222,7 @@ private:
         if (m_index + 1 >= m_source.size()) {
             return '\0';
         }
-        return m_source.at(m_index + 1);
-    }
-
-    [[nodiscard]] char peek_upper() const {
-        auto const c = peek();
-        if (c >= 'a' and c <= 'z') {
-            return static_cast<char>('A' + (c - 'a'));
-        }
-        return c;
+        return m_source[m_index + 1];
     }
 
     void advance() {
@@ -226,12 +231,6 @@ private:
         }
     }
 
-    [[nodiscard]] static bool is_letter(char const c) {
-        // 6.1.1
-        // We expect the caller to have already converted the character to uppercase.
-        return c >= 'A' and c <= 'Z';
-    }
-
     [[nodiscard]] static bool is_digit(char const c) {
         // 6.1.1
         return c >= '0' and c <= '9';
@@ -241,46 +240,62 @@ private:
         emit_token(type, m_index, length);
     }
 
-    void emit_token(TokenType const type, usize const start, usize const length) {
-        auto token = Token{
-            type,
-            SourceLocation{ m_path, m_source, start, length }
-        };
-        if (not m_tokens.empty()) {
-            auto const& previous_token = m_tokens.back();
-            // clang-format off
-            if (
-                (
-                    previous_token.type() == TokenType::Identifier
-                    or is_word_symbol(previous_token.type())
-                    or previous_token.type() == TokenType::IntegerNumber
-                    or previous_token.type() == TokenType::RealNumber
-                )
-                and (
-                    token.type() == TokenType::Identifier
-                    or is_word_symbol(token.type())
-                    or token.type() == TokenType::IntegerNumber
-                    or token.type() == TokenType::RealNumber
-                )
-                and not m_encountered_token_separator
-            ) {
-                auto const source_location = SourceLocation{
-                    m_path,
-                    m_source,
-                    previous_token.source_location().m_offset
-                    + previous_token.source_location().length(),
-                    1,
-                };
-                throw UnexpectedCharacter{ source_location, source_location.text().front(), "token separator" };
-            }
-            // clang-format on
+    // The source size has been checked in the constructor, so the casts below cannot truncate.
+    void emit_token(TokenType const type, usize const start, usize const length, Symbol const symbol = Symbol::None) {
+        emit_token(Token{ type, *m_file, static_cast<u32>(start), static_cast<u32>(length), symbol });
+    }
+
+    void emit_token(TokenType const type, usize const start, usize const length, Literal const literal) {
+        emit_token(Token{ type, *m_file, static_cast<u32>(start), static_cast<u32>(length), literal });
+    }
+
+    void emit_token(Token const& token) {
+        // 6.1.9: Without a token separator, this token directly follows the previous one.
+        if (not m_encountered_token_separator and needs_separator(token.type()) and needs_separator(m_previous_type)) {
+            auto const start = usize{ token.offset() };
+            return fail(Diagnostic::unexpected_character(
+                SourceLocation{ m_file, start, 1 },
+                m_source[start],
+                "token separator"
+            ));
         }
-        m_tokens.emplace_back(token);
+        m_next_token = token;
+        m_previous_type = token.type();
         m_encountered_token_separator = false;
     }
 
+    // 6.1.8: Expects the current character to be `{` or the `(` of `(*`.
+    void comment() {
+        auto const start = m_index;
+        advance();
+        while (true) {
+            m_index = find_comment_delimiter(m_source, m_index);
+            if (is_at_end() or current() == '}') {
+                break;
+            }
+            if (current() == '*' and peek() == ')') {
+                advance();
+                break;
+            }
+            advance();
+        }
+        if (is_at_end()) {
+            return fail(Diagnostic{ DiagnosticKind::UnterminatedComment, current_source_location() });
+        }
+        advance();
+        if (m_options.utf8_mode != Utf8Mode::Off) {
+            // The delimiters of comments are ASCII characters, which never occur within multibyte UTF-8 sequences, so
+            // the contents can be validated after the end of the comment has been found.
+            auto const invalid = find_invalid_utf8(m_source.substr(0, m_index), start);
+            if (invalid != m_index) {
+                return fail(Diagnostic{ DiagnosticKind::InvalidUtf8, SourceLocation{ m_file, invalid, 1 } });
+            }
+        }
+        m_encountered_token_separator = true;
+    }
+
     [[nodiscard]] SourceLocation current_source_location(usize const length = 1) const {
-        return SourceLocation{ m_path, m_source, m_index, length };
+        return SourceLocation{ m_file, m_index, length };
     }
 
     void number() {
@@ -289,7 +304,7 @@ private:
 
         // Digit sequence.
         if (not is_digit(current())) {
-            throw InternalCompilerError{ "Expected digit." };
+            throw_or_abort(InternalCompilerError{ "Expected digit." });
         }
         advance();
         while (is_digit(current())) {
@@ -298,7 +313,7 @@ private:
 
         if ((current() == '.' and peek() == '.') or (current() != '.' and current_upper() != 'E')) {
             // Integer.
-            emit_token(TokenType::IntegerNumber, start, m_index - start);
+            emit_token(TokenType::IntegerNumber, start, m_index - start, integer_literal(start));
             return;
         }
 
@@ -308,7 +323,7 @@ private:
             // Fractional part (digit sequence, optional).
             advance();
             if (not is_digit(current())) {
-                throw UnexpectedCharacter{ current_source_location(), current(), "digit" };
+                return fail(Diagnostic::unexpected_character(current_source_location(), current(), "digit"));
             }
             while (is_digit(current())) {
                 advance();
@@ -322,224 +337,535 @@ private:
                 advance();
             }
             if (not is_digit(current())) {
-                throw UnexpectedCharacter{ current_source_location(), current(), "digit" };
+                return fail(Diagnostic::unexpected_character(current_source_location(), current(), "digit"));
             }
             while (is_digit(current())) {
                 advance();
             }
         }
 
-        emit_token(TokenType::RealNumber, start, m_index - start);
+        emit_token(TokenType::RealNumber, start, m_index - start, real_literal(start));
     }
 
     void word_symbol_or_identifier() {
         auto const start = m_index;
-        advance();
-        while (is_letter(current_upper()) or is_digit(current())) {
-            advance();
+        // Most words are short, so the vectorized scanner is only used for the rest of longer words.
+        static constexpr auto max_short_word_length = usize{ 16 };
+        auto const short_word_end = std::min(m_source.size(), start + max_short_word_length);
+        ++m_index;
+        while (m_index < short_word_end and is_letter_or_digit(m_source[m_index])) {
+            ++m_index;
+        }
+        if (m_index == short_word_end) {
+            m_index = skip_letters_and_digits(m_source, m_index);
         }
         auto const lexeme = m_source.substr(start, m_index - start);
-
-        // The following code could be optimized, but we don't care about performance for now.
-        // TODO: Optimize!
-        if (equals_case_insensitive(lexeme, "AND")) {
-            emit_token(TokenType::And, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "ARRAY")) {
-            emit_token(TokenType::Array, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "BEGIN")) {
-            emit_token(TokenType::Begin, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "CASE")) {
-            emit_token(TokenType::Case, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "CONST")) {
-            emit_token(TokenType::Const, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "DIV")) {
-            emit_token(TokenType::Div, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "DO")) {
-            emit_token(TokenType::Do, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "DOWNTO")) {
-            emit_token(TokenType::DownTo, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "ELSE")) {
-            emit_token(TokenType::Else, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "END")) {
-            emit_token(TokenType::End, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "FILE")) {
-            emit_token(TokenType::File, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "FOR")) {
-            emit_token(TokenType::For, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "FUNCTION")) {
-            emit_token(TokenType::Function, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "GOTO")) {
-            emit_token(TokenType::Goto, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "IF")) {
-            emit_token(TokenType::If, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "IN")) {
-            emit_token(TokenType::In, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "LABEL")) {
-            emit_token(TokenType::Label, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "MOD")) {
-            emit_token(TokenType::Mod, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "NIL")) {
-            emit_token(TokenType::Nil, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "NOT")) {
-            emit_token(TokenType::Not, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "OF")) {
-            emit_token(TokenType::Of, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "OR")) {
-            emit_token(TokenType::Or, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "PACKED")) {
-            emit_token(TokenType::Packed, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "PROCEDURE")) {
-            emit_token(TokenType::Procedure, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "PROGRAM")) {
-            emit_token(TokenType::Program, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "RECORD")) {
-            emit_token(TokenType::Record, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "REPEAT")) {
-            emit_token(TokenType::Repeat, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "SET")) {
-            emit_token(TokenType::Set, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "THEN")) {
-            emit_token(TokenType::Then, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "TO")) {
-            emit_token(TokenType::To, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "TYPE")) {
-            emit_token(TokenType::Type, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "UNTIL")) {
-            emit_token(TokenType::Until, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "VAR")) {
-            emit_token(TokenType::Var, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "WHILE")) {
-            emit_token(TokenType::While, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "WITH")) {
-            emit_token(TokenType::With, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "BOOLEAN")) {
-            emit_token(TokenType::Boolean, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "INTEGER")) {
-            emit_token(TokenType::Integer, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "REAL")) {
-            emit_token(TokenType::Real, start, m_index - start);
-        } else if (equals_case_insensitive(lexeme, "CHAR")) {
-            emit_token(TokenType::Char, start, m_index - start);
+        auto const type = classify_word(lexeme);
+        if (type == TokenType::Identifier) {
+            emit_token(type, start, lexeme.length(), m_interner->intern(lexeme));
         } else {
-            emit_token(TokenType::Identifier, start, m_index - start);
+            emit_token(type, start, lexeme.length());
         }
     }
 
-    [[nodiscard]] static bool is_valid_string_character(char const current) {
-        return current >= 32 and current <= 126;
-    }
-
     void character_or_string() {
         auto const start = m_index;
         advance();
         auto num_apostrophe_images = usize{ 0 };
         while (true) {
-            if (current() == '\'') {
-                if (peek() == '\'') {
-                    ++num_apostrophe_images;
-                    advance();
-                    advance();
-                    continue;
+            m_index = find_string_delimiter(m_source, m_index);
+            if (m_options.utf8_mode == Utf8Mode::CommentsAndStrings and not is_ascii_character(current())) {
+                auto const length = utf8_sequence_length(m_source, m_index);
+                if (length == 0) {
+                    return fail(Diagnostic{ DiagnosticKind::InvalidUtf8, current_source_location() });
                 }
-                break;
+                m_index += length;
+                continue;
+            }
+            if (current() != '\'') {
+                return fail(Diagnostic::unexpected_character(current_source_location(), current(), "string character"));
             }
-            if (not is_valid_string_character(current())) {
-                throw UnexpectedCharacter{ current_source_location(), current(), "string character" };
+            if (peek() != '\'') {
+                break;
             }
+            ++num_apostrophe_images;
+            advance();
             advance();
         }
         if (current() != '\'') {
-            throw UnterminatedCharacterString{ current_source_location() };
+            return fail(Diagnostic{ DiagnosticKind::UnterminatedCharacterString, current_source_location() });
         }
         advance();
         auto const num_characters = m_index - start - 2 - num_apostrophe_images;
+        auto const literal = string_literal(m_source.substr(start + 1, m_index - start - 2), num_apostrophe_images);
         if (num_characters == 1) {
-            emit_token(TokenType::CharValue, start, m_index - start);
+            emit_token(TokenType::CharValue, start, m_index - start, literal);
         } else {
             assert(num_characters > 1);
-            emit_token(TokenType::StringValue, start, m_index - start);
-        }
-    }
-
-    [[nodiscard]] static bool is_word_symbol(TokenType const type) {
-        switch (type) {
-            case TokenType::Plus:
-            case TokenType::Minus:
-            case TokenType::Asterisk:
-            case TokenType::Slash:
-            case TokenType::Equals:
-            case TokenType::LessThan:
-            case TokenType::GreaterThan:
-            case TokenType::LeftSquareBracket:
-            case TokenType::RightSquareBracket:
-            case TokenType::Dot:
-            case TokenType::Comma:
-            case TokenType::Colon:
-            case TokenType::Semicolon:
-            case TokenType::UpArrow:
-            case TokenType::LeftParenthesis:
-            case TokenType::RightParenthesis:
-            case TokenType::LessThanGreaterThan:
-            case TokenType::LessThanEquals:
-            case TokenType::GreaterThanEquals:
-            case TokenType::ColonEquals:
-            case TokenType::DotDot:
-                return false;
-            case TokenType::And:
-            case TokenType::Array:
-            case TokenType::Begin:
-            case TokenType::Case:
-            case TokenType::Const:
-            case TokenType::Div:
-            case TokenType::Do:
-            case TokenType::DownTo:
-            case TokenType::Else:
-            case TokenType::End:
-            case TokenType::File:
-            case TokenType::For:
-            case TokenType::Function:
-            case TokenType::Goto:
-            case TokenType::If:
-            case TokenType::In:
-            case TokenType::Label:
-            case TokenType::Mod:
-            case TokenType::Nil:
-            case TokenType::Not:
-            case TokenType::Of:
-            case TokenType::Or:
-            case TokenType::Packed:
-            case TokenType::Procedure:
-            case TokenType::Program:
-            case TokenType::Record:
-            case TokenType::Repeat:
-            case TokenType::Set:
-            case TokenType::Then:
-            case TokenType::To:
-            case TokenType::Type:
-            case TokenType::Until:
-            case TokenType::Var:
-            case TokenType::While:
-            case TokenType::With:
-                return true;
-            case TokenType::Identifier:
-            case TokenType::Directive:
-            case TokenType::IntegerNumber:
-            case TokenType::RealNumber:
-            case TokenType::CharValue:
-            case TokenType::StringValue:
-            case TokenType::EndOfFile:
-            case TokenType::Boolean:
-            case TokenType::Char:
-            case TokenType::Integer:
-            case TokenType::Real:
-                return false;
-        }
-        throw InternalCompilerError{ "Unknown TokenType" };
+            emit_token(TokenType::StringValue, start, m_index - start, literal);
+        }
+    }
+
+    // 6.4.2.2: The value of maxint is the maximum value of `i64`. Integers that are out of range are not an error
+    // here, since the parser reports them once it knows where the integer is used.
+    [[nodiscard]] Literal integer_literal(usize const start) const {
+        auto value = i64{ 0 };
+        auto const [end, error] = std::from_chars(m_source.data() + start, m_source.data() + m_index, value);
+        if (error != std::errc{}) {
+            return Literal::None;
+        }
+        assert(end == m_source.data() + m_index);
+        return m_interner->literals().intern_integer(value);
+    }
+
+    // The standard library implements `std::from_chars()` for floating point numbers with the Eisel-Lemire algorithm
+    // (falling back to exact big-number arithmetic for the rare ambiguous cases).
+    [[nodiscard]] Literal real_literal(usize const start) const {
+        auto value = 0.0;
+        auto const [end, error] = std::from_chars(m_source.data() + start, m_source.data() + m_index, value);
+        if (error != std::errc{}) {
+            return Literal::None;
+        }
+        assert(end == m_source.data() + m_index);
+        return m_interner->literals().intern_real(value);
+    }
+
+    // Replaces the apostrophe images within `contents`, which excludes the enclosing apostrophes.
+    [[nodiscard]] Literal string_literal(std::string_view const contents, usize const num_apostrophe_images) const {
+        if (num_apostrophe_images == 0) {
+            return m_interner->literals().intern_string(contents);
+        }
+        auto value = std::string{};
+        value.reserve(contents.length() - num_apostrophe_images);
+        for (auto i = usize{ 0 }; i < contents.length(); ++i) {
+            value += contents[i];
+            if (contents[i] == '\'') {
+                ++i;
+            }
+        }
+        return m_interner->literals().intern_string(value);
     }
 };
 
-[[nodiscard]] std::vector<Token> tokenize(std::string_view const path, std::string_view const source) {
-    auto lexer = Lexer{ path, source };
-    lexer.tokenize();
-    return std::move(lexer).take_tokens();
+[[noreturn]] void throw_lexer_error(Diagnostic const& diagnostic) {
+    auto const& location = diagnostic.source_location();
+    switch (diagnostic.kind()) {
+        case DiagnosticKind::NonAsciiCharacter:
+            throw_or_abort(NonAsciiCharacter{ location });
+        case DiagnosticKind::InvalidUtf8:
+            throw_or_abort(InvalidUtf8{ location });
+        case DiagnosticKind::UnexpectedCharacter:
+            throw_or_abort(UnexpectedCharacter{ location, diagnostic.actual(), diagnostic.expected() });
+        case DiagnosticKind::UnterminatedCharacterString:
+            throw_or_abort(UnterminatedCharacterString{ location });
+        case DiagnosticKind::UnterminatedComment:
+            throw_or_abort(UnterminatedComment{ location });
+        case DiagnosticKind::SourceFileTooLarge:
+            throw_or_abort(SourceFileTooLarge{ location });
+        case DiagnosticKind::ParserError:
+            break;
+    }
+    throw_or_abort(InternalCompilerError{ "Not a lexer error." });
+}
+
+// Implements the throwing functions in terms of the `try_` functions.
+[[nodiscard]] static TokenBuffer value_or_throw(
+    Diagnostics const& diagnostics,
+    std::expected<TokenBuffer, DiagnosticId>&& tokens
+) {
+    if (not tokens.has_value()) {
+        throw_lexer_error(diagnostics[tokens.error()]);
+    }
+    return std::move(*tokens);
+}
+
+[[nodiscard]] TokenBuffer tokenize(std::string_view const path, std::string_view const source) {
+    return tokenize(std::make_shared<SourceFile const>(path, source));
+}
+
+[[nodiscard]] TokenBuffer tokenize(
+    std::shared_ptr<SourceFile const> file,
+    std::shared_ptr<Interner> interner,
+    LexerOptions const& lexer_options
+) {
+    auto diagnostics = Diagnostics{};
+    return value_or_throw(diagnostics, try_tokenize(diagnostics, std::move(file), std::move(interner), lexer_options));
+}
+
+[[nodiscard]] std::expected<TokenBuffer, DiagnosticId> try_tokenize(
+    Diagnostics& diagnostics,
+    std::shared_ptr<SourceFile const> file,
+    std::shared_ptr<Interner> interner,
+    LexerOptions const& lexer_options
+) {
+    auto lexer = Lexer{ std::move(file), std::move(interner), lexer_options };
+    auto tokens = TokenBuffer{ lexer.file(), lexer.interner() };
+    while (true) {
+        auto const token = lexer.next_token();
+        if (token.type() == TokenType::EndOfFile) {
+            // Lexing errors end the source early, so only the end of file token has to be checked.
+            if (auto const& error = lexer.error(); error.has_value()) {
+                return std::unexpected{ diagnostics.report(*error) };
+            }
+            tokens.push_back(token);
+            return tokens;
+        }
+        tokens.push_back(token);
+    }
+}
+
+namespace {
+    // The tokens that start within [start, end). Lexing starts at `start` as if it was preceded by a token separator.
+    struct Chunk final {
+        usize end;
+        TokenBuffer tokens;
+        // The interner may additionally contain the symbol or literal of `first_token_after_end`.
+        usize num_symbols = 0;
+        usize num_literals = 0;
+        tl::optional<Token> first_token_after_end;  // Unset if the end of the file has been reached or lexing failed.
+        tl::optional<Diagnostic> error{};
+#if PASC2K_EXCEPTIONS
+        std::exception_ptr exception{};  // Exceptions other than lexer errors (e.g. allocation failures).
+#endif
+        std::vector<Symbol> symbols{};  // The symbols of the resulting interner, indexed by the chunk's symbols.
+        std::vector<Literal> literals{};  // The same for literals.
+        usize first_index = 0;  // The index of the chunk's first token in the resulting buffer.
+
+        void count_interned_values() {
+            num_symbols = tokens.interner()->size();
+            num_literals = tokens.interner()->literals().size();
+        }
+    };
+
+    [[nodiscard]] Chunk lex_chunk(
+        std::shared_ptr<SourceFile const> const& file,
+        LexerOptions const& lexer_options,
+        usize const start,
+        usize const end
+    ) {
+        auto chunk = Chunk{ end, TokenBuffer{ file, std::make_shared<Interner>() }, 0, 0, tl::nullopt };
+#if PASC2K_EXCEPTIONS
+        try {
+#endif
+            auto lexer = Lexer{ file, chunk.tokens.interner(), lexer_options, start };
+            while (true) {
+                chunk.count_interned_values();
+                auto const token = lexer.next_token();
+                if (token.type() == TokenType::EndOfFile and lexer.error().has_value()) {
+                    // Identifiers and literals are interned before the lexer checks for a token separator.
+                    chunk.count_interned_values();
+                    chunk.error = lexer.error();
+                    break;
+                }
+                if (token.offset() >= end) {
+                    chunk.first_token_after_end = token;
+                    break;
+                }
+                chunk.tokens.push_back(token);
+                if (token.type() == TokenType::EndOfFile) {
+                    break;
+                }
+            }
+#if PASC2K_EXCEPTIONS
+        } catch (...) {
+            chunk.exception = std::current_exception();
+        }
+#endif
+        return chunk;
+    }
+
+    // Since the lexer only depends on the previous token when emitting the next one, two lexers that emitted the same
+    // token produce the same tokens from there on.
+    [[nodiscard]] bool starts_with(Chunk const& chunk, Token const& token) {
+        auto const first_token =
+            chunk.tokens.empty() ? chunk.first_token_after_end : tl::optional<Token>{ chunk.tokens[0] };
+        return first_token.has_value() and first_token->offset() == token.offset()
+               and first_token->length() == token.length() and first_token->type() == token.type();
+    }
+
+    // Tokens never span multiple lines, so a chunk that starts right after a line break only has to be re-lexed if
+    // the line break is part of a comment.
+    [[nodiscard]] std::vector<usize> chunk_starts(std::string_view const source, usize const num_chunks) {
+        auto starts = std::vector{ usize{ 0 } };
+        for (auto i = usize{ 1 }; i < num_chunks; ++i) {
+            auto const line_break = source.find('\n', source.size() / num_chunks * i);
+            if (line_break == std::string_view::npos) {
+                break;
+            }
+            if (line_break + 1 > starts.back() and line_break + 1 < source.size()) {
+                starts.push_back(line_break + 1);
+            }
+        }
+        return starts;
+    }
+
+    // Calls `task(index)` for every index in [0, num_tasks) on up to `num_threads` threads. `task` must not throw.
+    template<typename Task>
+    void run_concurrently(usize const num_threads, usize const num_tasks, Task const& task) {
+        auto next_task = std::atomic<usize>{ 0 };
+        auto workers = std::vector<std::jthread>{};
+        workers.reserve(std::min(num_threads, num_tasks));
+        for (auto i = usize{ 0 }; i < std::min(num_threads, num_tasks); ++i) {
+            workers.emplace_back([&] {
+                for (auto index = next_task++; index < num_tasks; index = next_task++) {
+                    task(index);
+                }
+            });
+        }
+    }
+}  // namespace
+
+[[nodiscard]] TokenBuffer tokenize_parallel(
+    std::shared_ptr<SourceFile const> file,
+    std::shared_ptr<Interner> interner,
+    ParallelLexingOptions const& options,
+    LexerOptions const& lexer_options
+) {
+    auto diagnostics = Diagnostics{};
+    return value_or_throw(
+        diagnostics,
+        try_tokenize_parallel(diagnostics, std::move(file), std::move(interner), options, lexer_options)
+    );
+}
+
+[[nodiscard]] std::expected<TokenBuffer, DiagnosticId> try_tokenize_parallel(
+    Diagnostics& diagnostics,
+    std::shared_ptr<SourceFile const> file,
+    std::shared_ptr<Interner> interner,
+    ParallelLexingOptions const& options,
+    LexerOptions const& lexer_options
+) {
+    auto const source = file->source();
+    auto const num_threads = options.num_threads == 0
+                                 ? std::max(usize{ 1 }, usize{ std::thread::hardware_concurrency() })
+                                 : options.num_threads;
+    auto const num_chunks = std::min(num_threads, source.size() / std::max(usize{ 1 }, options.min_chunk_size));
+    if (num_chunks <= 1) {
+        return try_tokenize(diagnostics, std::move(file), std::move(interner), lexer_options);
+    }
+
+    // Each chunk is lexed speculatively, assuming that it does not start within a comment.
+    auto const starts = chunk_starts(source, num_chunks);
+    auto chunks = std::vector<tl::optional<Chunk>>(starts.size());
+    run_concurrently(num_threads, chunks.size(), [&](usize const index) {
+        auto const trace = TraceScope{ "lex chunk" };
+        auto const end = index + 1 < starts.size() ? starts[index + 1] : std::numeric_limits<usize>::max();
+        chunks[index] = lex_chunk(file, lexer_options, starts[index], end);
+    });
+
+    // The first chunk is always correct. Every following chunk must start with the first token the previous chunk
+    // found after its end. Otherwise, its start was guessed wrong and it is re-lexed from that token on. The symbols
+    // and literals of each chunk have been interned in the order of their first occurrence, so interning them in the
+    // same order yields the same values as lexing serially.
+    auto num_tokens = usize{ 0 };
+    auto expected_first_token = tl::optional<Token>{};
+    for (auto i = usize{ 0 }; i < chunks.size(); ++i) {
+        auto const trace = TraceScope{ "merge chunk" };
+        auto& chunk = *chunks[i];
+        if (i > 0) {
+            assert(expected_first_token.has_value());
+            if (not starts_with(chunk, *expected_first_token)) {
+                auto const relex_trace = TraceScope{ "relex chunk" };
+                chunk = lex_chunk(file, lexer_options, expected_first_token->offset(), chunk.end);
+            }
+        }
+#if PASC2K_EXCEPTIONS
+        if (chunk.exception) {
+            std::rethrow_exception(chunk.exception);
+        }
+#endif
+        chunk.first_index = num_tokens;
+        num_tokens += chunk.tokens.size();
+        auto const& chunk_interner = *chunk.tokens.interner();
+        chunk.symbols.reserve(chunk.num_symbols);
+        for (auto symbol = usize{ 0 }; symbol < chunk.num_symbols; ++symbol) {
+            chunk.symbols.push_back(interner->intern(chunk_interner.spelling(static_cast<Symbol>(symbol))));
+        }
+        chunk.literals.reserve(chunk.num_literals);
+        for (auto literal = usize{ 0 }; literal < chunk.num_literals; ++literal) {
+            auto const value = interner->literals().add_from(chunk_interner.literals(), static_cast<Literal>(literal));
+            chunk.literals.push_back(value);
+        }
+        if (chunk.error.has_value()) {
+            return std::unexpected{ diagnostics.report(*chunk.error) };
+        }
+        expected_first_token = chunk.first_token_after_end;
+    }
+
+    auto tokens = TokenBuffer{ std::move(file), std::move(interner) };
+    tokens.resize(num_tokens);
+    run_concurrently(num_threads, chunks.size(), [&](usize const index) {
+        auto const trace = TraceScope{ "copy chunk" };
+        auto const& chunk = *chunks[index];
+        auto const& file = *tokens.file();
+        for (auto i = usize{ 0 }; i < chunk.tokens.size(); ++i) {
+            auto const type = chunk.tokens.type(i);
+            auto const offset = chunk.tokens.offset(i);
+            auto const length = chunk.tokens.length(i);
+            if (auto const symbol = chunk.tokens.symbol(i); symbol != Symbol::None) {
+                auto const mapped = chunk.symbols[static_cast<usize>(symbol)];
+                tokens.assign(chunk.first_index + i, Token{ type, file, offset, length, mapped });
+            } else if (auto const literal = chunk.tokens.literal(i); literal != Literal::None) {
+                auto const mapped = chunk.literals[static_cast<usize>(literal)];
+                tokens.assign(chunk.first_index + i, Token{ type, file, offset, length, mapped });
+            } else {
+                tokens.assign(chunk.first_index + i, Token{ type, file, offset, length });
+            }
+        }
+        chunks[index].reset();
+    });
+    return tokens;
+}
+
+namespace {
+    // The lexer looks at most this many characters beyond the end of a token before emitting it (e.g. to tell `1..`
+    // from `1.5`).
+    constexpr auto max_lookahead = usize{ 2 };
+
+    // Returns the index of the first token for which `predicate` is false. `predicate` must be true for a (possibly
+    // empty) prefix of the tokens only.
+    template<typename Predicate>
+    [[nodiscard]] usize partition_point(TokenBuffer const& tokens, Predicate const& predicate) {
+        auto low = usize{ 0 };
+        auto high = tokens.size();
+        while (low < high) {
+            auto const middle = low + (high - low) / 2;
+            if (predicate(middle)) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+}  // namespace
+
+[[nodiscard]] TokenBuffer relex(
+    TokenBuffer const& previous,
+    SourceEdit const& edit,
+    LexerOptions const& lexer_options
+) {
+    auto diagnostics = Diagnostics{};
+    return value_or_throw(diagnostics, try_relex(diagnostics, previous, edit, lexer_options));
+}
+
+[[nodiscard]] std::expected<TokenBuffer, DiagnosticId> try_relex(
+    Diagnostics& diagnostics,
+    TokenBuffer const& previous,
+    SourceEdit const& edit,
+    LexerOptions const& lexer_options
+) {
+    auto const previous_source = previous.file()->source();
+    if (edit.offset > previous_source.size() or edit.removed_length > previous_source.size() - edit.offset) {
+        throw_or_abort(std::out_of_range{ "Edit out of range of the source." });
+    }
+    auto const edit_end = edit.offset + edit.removed_length;
+
+    auto contents = std::string{};
+    contents.reserve(previous_source.size() - edit.removed_length + edit.inserted_text.size());
+    contents.append(previous_source.substr(0, edit.offset));
+    contents.append(edit.inserted_text);
+    contents.append(previous_source.substr(edit_end));
+    auto file = std::make_shared<SourceFile const>(
+        previous.file()->path(),
+        SourceBuffer::from_string(std::move(contents))
+    );
+
+    // Tokens that end (including the characters the lexer looked at) before the edit are unaffected. Restarting at
+    // the start of the last of them yields the same state as lexing from the beginning, since the lexer only depends
+    // on the previous token when checking for a token separator, and that check has already passed.
+    auto const num_unaffected = partition_point(previous, [&](usize const index) {
+        return usize{ previous.offset(index) } + usize{ previous.length(index) } + max_lookahead <= edit.offset;
+    });
+    auto const restart_index = num_unaffected == 0 ? usize{ 0 } : num_unaffected - 1;
+    auto const restart_offset = num_unaffected == 0 ? usize{ 0 } : usize{ previous.offset(restart_index) };
+
+    auto tokens = TokenBuffer{ file, previous.interner() };
+    tokens.reserve(previous.size());
+    tokens.append(previous, 0, restart_index);
+
+    // Old tokens that start after the edit are candidates for re-synchronization. Their offsets are shifted by the
+    // difference in length.
+    auto const shifted_offset = [&](usize const index) {
+        return usize{ previous.offset(index) } - edit.removed_length + edit.inserted_text.size();
+    };
+    auto old_index = partition_point(previous, [&](usize const index) {
+        return previous.offset(index) < edit_end;
+    });
+
+    auto lexer = Lexer{ file, previous.interner(), lexer_options, restart_offset };
+    while (true) {
+        auto const token = lexer.next_token();
+        if (auto const& error = lexer.error(); error.has_value()) {
+            return std::unexpected{ diagnostics.report(*error) };
+        }
+        while (old_index < previous.size() and shifted_offset(old_index) < token.offset()) {
+            ++old_index;
+        }
+        if (old_index < previous.size() and shifted_offset(old_index) == token.offset()
+            and previous.length(old_index) == token.length() and previous.type(old_index) == token.type()) {
+            // Both lexers are in the same state from here on.
+            auto const offset_delta =
+                static_cast<i64>(edit.inserted_text.size()) - static_cast<i64>(edit.removed_length);
+            tokens.append(previous, old_index, previous.size(), offset_delta);
+            return tokens;
+        }
+        tokens.push_back(token);
+        if (token.type() == TokenType::EndOfFile) {
+            return tokens;
+        }
+    }
+}
+
+TokenStream::TokenStream(std::string_view const path, std::string_view const source)
+    : TokenStream{ std::make_shared<SourceFile const>(path, source) } {}
+
+TokenStream::TokenStream(
+    std::shared_ptr<SourceFile const> file,
+    std::shared_ptr<Interner> interner,
+    LexerOptions const& lexer_options
+)
+    : m_lexer{ std::make_unique<Lexer>(std::move(file), std::move(interner), lexer_options) } {}
+
+TokenStream::TokenStream(TokenStream&&) noexcept = default;
+
+TokenStream& TokenStream::operator=(TokenStream&&) noexcept = default;
+
+TokenStream::~TokenStream() = default;
+
+[[nodiscard]] std::shared_ptr<SourceFile const> const& TokenStream::file() const {
+    return m_lexer->file();
+}
+
+[[nodiscard]] std::shared_ptr<Interner> const& TokenStream::interner() const {
+    return m_lexer->interner();
+}
+
+[[nodiscard]] Token TokenStream::peek(usize const offset) {
+    auto const token = peek_or_end(offset);
+    // After an error, the last lookahead token is the end of file token that replaces the offending token.
+    if (auto const& error = m_lexer->error(); error.has_value() and offset + 1 >= m_lookahead.size()) {
+        throw_lexer_error(*error);
+    }
+    return token;
+}
+
+[[nodiscard]] Token TokenStream::peek_or_end(usize const offset) {
+    while (m_lookahead.size() <= offset) {
+        if (not m_lookahead.empty() and m_lookahead.back().type() == TokenType::EndOfFile) {
+            return m_lookahead.back();
+        }
+        m_lookahead.push_back(m_lexer->next_token());
+    }
+    return m_lookahead[offset];
+}
+
+void TokenStream::advance() {
+    if (peek_or_end().type() != TokenType::EndOfFile) {
+        m_lookahead.pop_front();
+    }
+}
+
+[[nodiscard]] tl::optional<Diagnostic> const& TokenStream::error() const {
+    return m_lexer->error();
 }
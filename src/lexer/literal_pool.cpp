@@ -0,0 +1,72 @@
+#include <bit>
+#include <common/common.hpp>
+#include <lexer/literal_pool.hpp>
+#include <limits>
+#include <stdexcept>
+
+Literal LiteralPool::intern_integer(i64 const value) {
+    if (auto const it = m_integer_literals.find(value); it != m_integer_literals.end()) {
+        return it->second;
+    }
+    auto const literal = next_literal();
+    m_values.emplace_back(value);
+    m_integer_literals.emplace(value, literal);
+    return literal;
+}
+
+Literal LiteralPool::intern_real(double const value) {
+    auto const bits = std::bit_cast<u64>(value);
+    if (auto const it = m_real_literals.find(bits); it != m_real_literals.end()) {
+        return it->second;
+    }
+    auto const literal = next_literal();
+    m_values.emplace_back(value);
+    m_real_literals.emplace(bits, literal);
+    return literal;
+}
+
+Literal LiteralPool::intern_string(std::string_view const value) {
+    if (auto const it = m_string_literals.find(value); it != m_string_literals.end()) {
+        return it->second;
+    }
+    auto const literal = next_literal();
+    auto const& stored = m_strings.emplace_back(value);
+    m_values.emplace_back(std::string_view{ stored });
+    m_string_literals.emplace(std::string_view{ stored }, literal);
+    return literal;
+}
+
+Literal LiteralPool::add_from(LiteralPool const& other, Literal const literal) {
+    auto const& value = other.m_values.at(static_cast<usize>(literal));
+    if (auto const integer = std::get_if<i64>(&value)) {
+        return intern_integer(*integer);
+    }
+    if (auto const real = std::get_if<double>(&value)) {
+        return intern_real(*real);
+    }
+    return intern_string(std::get<std::string_view>(value));
+}
+
+LiteralKind LiteralPool::kind(Literal const literal) const {
+    // The alternatives of the variant are in the same order as the kinds.
+    return static_cast<LiteralKind>(m_values.at(static_cast<usize>(literal)).index());
+}
+
+i64 LiteralPool::integer(Literal const literal) const {
+    return std::get<i64>(m_values.at(static_cast<usize>(literal)));
+}
+
+double LiteralPool::real(Literal const literal) const {
+    return std::get<double>(m_values.at(static_cast<usize>(literal)));
+}
+
+std::string_view LiteralPool::string(Literal const literal) const {
+    return std::get<std::string_view>(m_values.at(static_cast<usize>(literal)));
+}
+
+Literal LiteralPool::next_literal() const {
+    if (m_values.size() >= std::numeric_limits<u32>::max() - 1) {
+        throw_or_abort(std::length_error{ "Too many literals." });
+    }
+    return Literal{ static_cast<u32>(m_values.size()) };
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <lib2k/types.hpp>
+
+// Architecture-specific implementations of the scanners declared in "scanners.hpp". All of them share the
+// signature `(data, size, offset) -> offset` so that they can be stored in a dispatch table.
+//
+// This header must not contain any inline code: it is included by translation units that are compiled for CPU
+// extensions which may not be available at runtime, and the linker is free to pick their copy of an inline function.
+
+// SSE2 is part of the x86-64 baseline, so these kernels need no runtime check.
+#if defined(__x86_64__) || defined(_M_X64)
+#define PASC2K_SSE2_SCANNERS
+#endif
+
+namespace detail {
+    using Scanner = usize (*)(char const* data, usize size, usize offset);
+
+#ifdef PASC2K_SSE2_SCANNERS
+    namespace sse2 {
+        [[nodiscard]] usize skip_whitespace(char const* data, usize size, usize offset);
+        [[nodiscard]] usize skip_letters_and_digits(char const* data, usize size, usize offset);
+        [[nodiscard]] usize find_comment_delimiter(char const* data, usize size, usize offset);
+        [[nodiscard]] usize find_string_delimiter(char const* data, usize size, usize offset);
+        [[nodiscard]] usize skip_ascii(char const* data, usize size, usize offset);
+    }  // namespace sse2
+#endif
+
+#ifdef PASC2K_AVX2_SCANNERS
+    namespace avx2 {
+        [[nodiscard]] usize skip_whitespace(char const* data, usize size, usize offset);
+        [[nodiscard]] usize skip_letters_and_digits(char const* data, usize size, usize offset);
+        [[nodiscard]] usize find_comment_delimiter(char const* data, usize size, usize offset);
+        [[nodiscard]] usize find_string_delimiter(char const* data, usize size, usize offset);
+        [[nodiscard]] usize skip_ascii(char const* data, usize size, usize offset);
+    }  // namespace avx2
+#endif
+}  // namespace detail
@@ -0,0 +1,198 @@
+#include "scanners.hpp"
+#include <bit>
+#include "scanner_kernels.hpp"
+
+#ifdef PASC2K_SSE2_SCANNERS
+#include <emmintrin.h>
+#endif
+
+#if defined(PASC2K_AVX2_SCANNERS) && defined(_MSC_VER)
+#include <array>
+#include <intrin.h>
+#endif
+
+namespace detail::scalar {
+    template<bool (*predicate)(char), bool continue_while>
+    [[nodiscard]] static usize scan(char const* const data, usize const size, usize offset) {
+        while (offset < size and predicate(data[offset]) == continue_while) {
+            ++offset;
+        }
+        return offset;
+    }
+
+    [[nodiscard]] static usize skip_whitespace(char const* const data, usize const size, usize const offset) {
+        return scan<is_whitespace, true>(data, size, offset);
+    }
+
+    [[nodiscard]] static usize skip_letters_and_digits(char const* const data, usize const size, usize const offset) {
+        return scan<is_letter_or_digit, true>(data, size, offset);
+    }
+
+    [[nodiscard]] static usize find_comment_delimiter(char const* const data, usize const size, usize const offset) {
+        return scan<is_comment_delimiter, false>(data, size, offset);
+    }
+
+    [[nodiscard]] static usize find_string_delimiter(char const* const data, usize const size, usize const offset) {
+        return scan<is_string_delimiter, false>(data, size, offset);
+    }
+
+    [[nodiscard]] static usize skip_ascii(char const* const data, usize const size, usize const offset) {
+        return scan<is_ascii_character, true>(data, size, offset);
+    }
+}  // namespace detail::scalar
+
+#ifdef PASC2K_SSE2_SCANNERS
+namespace detail::sse2 {
+    // Sets all bits of the bytes that are in the range [low, high]. Both bounds must be ASCII characters. Since the
+    // comparisons are signed, non-ASCII bytes (which are negative) never match.
+    [[nodiscard]] static __m128i in_range(__m128i const bytes, char const low, char const high) {
+        return _mm_and_si128(
+            _mm_cmpgt_epi8(bytes, _mm_set1_epi8(static_cast<char>(low - 1))),
+            _mm_cmplt_epi8(bytes, _mm_set1_epi8(static_cast<char>(high + 1)))
+        );
+    }
+
+    [[nodiscard]] static __m128i equals(__m128i const bytes, char const c) {
+        return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c));
+    }
+
+    // Scans 16 bytes at a time until `ends_run` matches any byte of a block. The remaining bytes are handled by
+    // the scalar implementation.
+    template<Scanner scalar_scanner, typename EndsRun>
+    [[nodiscard]] static usize scan(char const* const data, usize const size, usize offset, EndsRun const& ends_run) {
+        static constexpr auto block_size = usize{ 16 };
+        while (size - offset >= block_size) {
+            auto const block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + offset));
+            auto const mask = static_cast<u32>(_mm_movemask_epi8(ends_run(block)));
+            if (mask != 0) {
+                return offset + static_cast<usize>(std::countr_zero(mask));
+            }
+            offset += block_size;
+        }
+        return scalar_scanner(data, size, offset);
+    }
+
+    usize skip_whitespace(char const* const data, usize const size, usize const offset) {
+        return scan<scalar::skip_whitespace>(data, size, offset, [](__m128i const block) {
+            auto const whitespace = _mm_or_si128(equals(block, ' '), in_range(block, '\t', '\r'));
+            return _mm_xor_si128(whitespace, _mm_set1_epi8(-1));
+        });
+    }
+
+    usize skip_letters_and_digits(char const* const data, usize const size, usize const offset) {
+        return scan<scalar::skip_letters_and_digits>(data, size, offset, [](__m128i const block) {
+            auto const lower = _mm_or_si128(block, _mm_set1_epi8(0x20));
+            auto const letters_and_digits = _mm_or_si128(in_range(lower, 'a', 'z'), in_range(block, '0', '9'));
+            return _mm_xor_si128(letters_and_digits, _mm_set1_epi8(-1));
+        });
+    }
+
+    usize find_comment_delimiter(char const* const data, usize const size, usize const offset) {
+        return scan<scalar::find_comment_delimiter>(data, size, offset, [](__m128i const block) {
+            return _mm_or_si128(equals(block, '}'), equals(block, '*'));
+        });
+    }
+
+    usize find_string_delimiter(char const* const data, usize const size, usize const offset) {
+        return scan<scalar::find_string_delimiter>(data, size, offset, [](__m128i const block) {
+            // Signed comparison: Non-ASCII bytes are negative and therefore also less than ' '.
+            auto const invalid = _mm_or_si128(_mm_cmplt_epi8(block, _mm_set1_epi8(' ')), equals(block, '\x7F'));
+            return _mm_or_si128(equals(block, '\''), invalid);
+        });
+    }
+
+    usize skip_ascii(char const* const data, usize const size, usize const offset) {
+        // The mask consists of the most significant bits, which are only set for non-ASCII bytes.
+        return scan<scalar::skip_ascii>(data, size, offset, [](__m128i const block) { return block; });
+    }
+}  // namespace detail::sse2
+#endif
+
+namespace {
+    struct Scanners final {
+        detail::Scanner skip_whitespace;
+        detail::Scanner skip_letters_and_digits;
+        detail::Scanner find_comment_delimiter;
+        detail::Scanner find_string_delimiter;
+        detail::Scanner skip_ascii;
+    };
+
+#ifdef PASC2K_AVX2_SCANNERS
+    [[nodiscard]] bool cpu_supports_avx2() {
+#ifdef _MSC_VER
+        auto info = std::array<int, 4>{};
+        __cpuid(info.data(), 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid(info.data(), 1);
+        auto const os_saves_ymm_registers = (info[2] & (1 << 27)) != 0 and (_xgetbv(0) & 0x6) == 0x6;
+        auto const supports_avx = (info[2] & (1 << 28)) != 0;
+        if (not os_saves_ymm_registers or not supports_avx) {
+            return false;
+        }
+        __cpuidex(info.data(), 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    [[nodiscard]] Scanners select_scanners() {
+#ifdef PASC2K_AVX2_SCANNERS
+        if (cpu_supports_avx2()) {
+            return Scanners{
+                detail::avx2::skip_whitespace,
+                detail::avx2::skip_letters_and_digits,
+                detail::avx2::find_comment_delimiter,
+                detail::avx2::find_string_delimiter,
+                detail::avx2::skip_ascii,
+            };
+        }
+#endif
+#ifdef PASC2K_SSE2_SCANNERS
+        return Scanners{
+            detail::sse2::skip_whitespace,
+            detail::sse2::skip_letters_and_digits,
+            detail::sse2::find_comment_delimiter,
+            detail::sse2::find_string_delimiter,
+            detail::sse2::skip_ascii,
+        };
+#else
+        return Scanners{
+            detail::scalar::skip_whitespace,
+            detail::scalar::skip_letters_and_digits,
+            detail::scalar::find_comment_delimiter,
+            detail::scalar::find_string_delimiter,
+            detail::scalar::skip_ascii,
+        };
+#endif
+    }
+
+    [[nodiscard]] Scanners const& scanners() {
+        static auto const result = select_scanners();
+        return result;
+    }
+}  // namespace
+
+[[nodiscard]] usize skip_whitespace(std::string_view const source, usize const offset) {
+    return scanners().skip_whitespace(source.data(), source.size(), offset);
+}
+
+[[nodiscard]] usize skip_letters_and_digits(std::string_view const source, usize const offset) {
+    return scanners().skip_letters_and_digits(source.data(), source.size(), offset);
+}
+
+[[nodiscard]] usize find_comment_delimiter(std::string_view const source, usize const offset) {
+    return scanners().find_comment_delimiter(source.data(), source.size(), offset);
+}
+
+[[nodiscard]] usize find_string_delimiter(std::string_view const source, usize const offset) {
+    return scanners().find_string_delimiter(source.data(), source.size(), offset);
+}
+
+[[nodiscard]] usize skip_ascii(std::string_view const source, usize const offset) {
+    return scanners().skip_ascii(source.data(), source.size(), offset);
+}
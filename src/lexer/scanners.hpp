@@ -0,0 +1,46 @@
+#pragma once
+
+#include <lib2k/types.hpp>
+#include <string_view>
+
+// Vectorized scanners for the lexer's hot loops. Each of them returns the offset of the first character at or after
+// `offset` that ends the scanned run, or `source.size()` if the run extends to the end of the source. `offset` must
+// not be greater than `source.size()`. The implementation (AVX2, SSE2, or scalar) is chosen once at runtime based
+// on the features of the CPU.
+
+// Finds the first character that is not whitespace (as defined by `std::isspace()` in the "C" locale).
+[[nodiscard]] usize skip_whitespace(std::string_view source, usize offset);
+
+// Finds the first character that is neither an ASCII letter nor a digit.
+[[nodiscard]] usize skip_letters_and_digits(std::string_view source, usize offset);
+
+// Finds the first `}` or `*`, i.e. the first character that may terminate a comment.
+[[nodiscard]] usize find_comment_delimiter(std::string_view source, usize offset);
+
+// Finds the first apostrophe or the first character that is not allowed inside a character string
+// (everything outside the printable ASCII range).
+[[nodiscard]] usize find_string_delimiter(std::string_view source, usize offset);
+
+// Finds the first character outside the ASCII range.
+[[nodiscard]] usize skip_ascii(std::string_view source, usize offset);
+
+[[nodiscard]] constexpr bool is_whitespace(char const c) {
+    return c == ' ' or (c >= '\t' and c <= '\r');
+}
+
+[[nodiscard]] constexpr bool is_letter_or_digit(char const c) {
+    auto const lower = static_cast<char>(c | 0x20);
+    return (lower >= 'a' and lower <= 'z') or (c >= '0' and c <= '9');
+}
+
+[[nodiscard]] constexpr bool is_comment_delimiter(char const c) {
+    return c == '}' or c == '*';
+}
+
+[[nodiscard]] constexpr bool is_string_delimiter(char const c) {
+    return c == '\'' or c < ' ' or c > '~';
+}
+
+[[nodiscard]] constexpr bool is_ascii_character(char const c) {
+    return static_cast<unsigned char>(c) < 0x80;
+}
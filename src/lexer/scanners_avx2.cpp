@@ -0,0 +1,77 @@
+// This translation unit is compiled with AVX2 enabled. Its kernels are only called after the CPU has been checked
+// for AVX2 support (see `select_scanners()`), so it must not define any code that is shared with other translation
+// units (see "scanner_kernels.hpp").
+
+#include <immintrin.h>
+#include "scanner_kernels.hpp"
+
+namespace detail::avx2 {
+    // See `detail::sse2::in_range()`.
+    [[nodiscard]] static __m256i in_range(__m256i const bytes, char const low, char const high) {
+        return _mm256_and_si256(
+            _mm256_cmpgt_epi8(bytes, _mm256_set1_epi8(static_cast<char>(low - 1))),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(high + 1)), bytes)
+        );
+    }
+
+    [[nodiscard]] static __m256i equals(__m256i const bytes, char const c) {
+        return _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(c));
+    }
+
+    // Scans 32 bytes at a time until `ends_run` matches any byte of a block. The remaining bytes are handled by
+    // the SSE2 implementation.
+    template<Scanner sse2_scanner, typename EndsRun>
+    [[nodiscard]] static usize scan(char const* const data, usize const size, usize offset, EndsRun const& ends_run) {
+        static constexpr auto block_size = usize{ 32 };
+        while (size - offset >= block_size) {
+            auto const block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + offset));
+            auto const mask = static_cast<unsigned int>(_mm256_movemask_epi8(ends_run(block)));
+            if (mask != 0) {
+                // Not `std::countr_zero()`, because its inline definition would be compiled for AVX2, too.
+#ifdef _MSC_VER
+                auto index = 0UL;
+                _BitScanForward(&index, mask);
+                return offset + index;
+#else
+                return offset + static_cast<usize>(__builtin_ctz(mask));
+#endif
+            }
+            offset += block_size;
+        }
+        return sse2_scanner(data, size, offset);
+    }
+
+    usize skip_whitespace(char const* const data, usize const size, usize const offset) {
+        return scan<sse2::skip_whitespace>(data, size, offset, [](__m256i const block) {
+            auto const whitespace = _mm256_or_si256(equals(block, ' '), in_range(block, '\t', '\r'));
+            return _mm256_xor_si256(whitespace, _mm256_set1_epi8(-1));
+        });
+    }
+
+    usize skip_letters_and_digits(char const* const data, usize const size, usize const offset) {
+        return scan<sse2::skip_letters_and_digits>(data, size, offset, [](__m256i const block) {
+            auto const lower = _mm256_or_si256(block, _mm256_set1_epi8(0x20));
+            auto const letters_and_digits = _mm256_or_si256(in_range(lower, 'a', 'z'), in_range(block, '0', '9'));
+            return _mm256_xor_si256(letters_and_digits, _mm256_set1_epi8(-1));
+        });
+    }
+
+    usize find_comment_delimiter(char const* const data, usize const size, usize const offset) {
+        return scan<sse2::find_comment_delimiter>(data, size, offset, [](__m256i const block) {
+            return _mm256_or_si256(equals(block, '}'), equals(block, '*'));
+        });
+    }
+
+    usize find_string_delimiter(char const* const data, usize const size, usize const offset) {
+        return scan<sse2::find_string_delimiter>(data, size, offset, [](__m256i const block) {
+            auto const invalid =
+                _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(' '), block), equals(block, '\x7F'));
+            return _mm256_or_si256(equals(block, '\''), invalid);
+        });
+    }
+
+    usize skip_ascii(char const* const data, usize const size, usize const offset) {
+        // See `detail::sse2::skip_ascii()`.
+        return scan<sse2::skip_ascii>(data, size, offset, [](__m256i const block) { return block; });
+    }
+}  // namespace detail::avx2
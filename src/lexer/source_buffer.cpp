@@ -0,0 +1,146 @@
+#include <cerrno>
+#include <common/common.hpp>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <lexer/source_buffer.hpp>
+#include <lib2k/defer.hpp>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PASC2K_MEMORY_MAPPED_SOURCES
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept
+    : m_mapping{ std::exchange(other.m_mapping, nullptr) },
+      m_mapping_size{ std::exchange(other.m_mapping_size, 0) },
+      m_contents{ std::move(other.m_contents) } {}
+
+SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+        m_mapping_size = std::exchange(other.m_mapping_size, 0);
+        m_contents = std::move(other.m_contents);
+    }
+    return *this;
+}
+
+SourceBuffer::~SourceBuffer() {
+    unmap();
+}
+
+#ifdef PASC2K_MEMORY_MAPPED_SOURCES
+
+[[nodiscard]] static std::runtime_error read_error(std::string_view const what, int const error_number) {
+    return std::runtime_error{ std::format("Failed to read {}: {}", what, std::strerror(error_number)) };
+}
+
+// Reads everything until the end of the stream. Used for pipes, terminals and other files that cannot be mapped.
+[[nodiscard]] static std::string read_all(int const file_descriptor, std::string_view const what) {
+    auto contents = std::string{};
+    auto size = usize{ 0 };
+    while (true) {
+        if (size == contents.size()) {
+            contents.resize(std::max(usize{ 64 * 1024 }, contents.size() * 2));
+        }
+        auto const result = ::read(file_descriptor, contents.data() + size, contents.size() - size);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_or_abort(read_error(what, errno));
+        }
+        if (result == 0) {
+            break;
+        }
+        size += static_cast<usize>(result);
+    }
+    contents.resize(size);
+    return contents;
+}
+
+SourceBuffer SourceBuffer::from_file_descriptor(int const file_descriptor, std::string_view const what) {
+    struct stat status {};
+    if (::fstat(file_descriptor, &status) != 0) {
+        throw_or_abort(read_error(what, errno));
+    }
+    // Empty files cannot be mapped.
+    if (not S_ISREG(status.st_mode) or status.st_size == 0) {
+        return from_string(read_all(file_descriptor, what));
+    }
+    auto const size = static_cast<usize>(status.st_size);
+    auto const mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if (mapping == MAP_FAILED) {
+        return from_string(read_all(file_descriptor, what));
+    }
+    // The lexer reads the source front to back.
+    ::posix_madvise(mapping, size, POSIX_MADV_SEQUENTIAL);
+    auto buffer = SourceBuffer{};
+    buffer.m_mapping = static_cast<char const*>(mapping);
+    buffer.m_mapping_size = size;
+    return buffer;
+}
+
+SourceBuffer SourceBuffer::from_file(std::filesystem::path const& path) {
+    auto const what = std::format("file '{}'", path.string());
+    auto const file_descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file_descriptor < 0) {
+        throw_or_abort(read_error(what, errno));
+    }
+    // The mapping stays valid after closing the file.
+    auto const _ = c2k::Defer{ [&] { ::close(file_descriptor); } };
+    return from_file_descriptor(file_descriptor, what);
+}
+
+SourceBuffer SourceBuffer::from_standard_input() {
+    return from_file_descriptor(STDIN_FILENO, "standard input");
+}
+
+void SourceBuffer::unmap() {
+    if (m_mapping != nullptr) {
+        // `munmap()` takes a non-const pointer, but does not write through it.
+        ::munmap(const_cast<char*>(m_mapping), m_mapping_size);
+        m_mapping = nullptr;
+        m_mapping_size = 0;
+    }
+}
+
+#else
+
+SourceBuffer SourceBuffer::from_file(std::filesystem::path const& path) {
+    auto file = std::ifstream{ path, std::ios::binary };
+    if (not file) {
+        throw_or_abort(std::runtime_error{ std::format("Failed to read file '{}'", path.string()) });
+    }
+    auto contents = std::string{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    if (file.bad()) {
+        throw_or_abort(std::runtime_error{ std::format("Failed to read file '{}'", path.string()) });
+    }
+    return from_string(std::move(contents));
+}
+
+SourceBuffer SourceBuffer::from_standard_input() {
+    auto contents = std::string{ std::istreambuf_iterator<char>{ std::cin }, std::istreambuf_iterator<char>{} };
+    if (std::cin.bad()) {
+        throw_or_abort(std::runtime_error{ "Failed to read standard input" });
+    }
+    return from_string(std::move(contents));
+}
+
+void SourceBuffer::unmap() {}
+
+#endif
+
+SourceBuffer SourceBuffer::from_string(std::string contents) {
+    auto buffer = SourceBuffer{};
+    buffer.m_contents = std::move(contents);
+    return buffer;
+}
@@ -0,0 +1,49 @@
+#include "utf8.hpp"
+#include "scanners.hpp"
+
+[[nodiscard]] static bool is_continuation_byte(u8 const byte, u8 const low = 0x80, u8 const high = 0xBF) {
+    return byte >= low and byte <= high;
+}
+
+[[nodiscard]] usize utf8_sequence_length(std::string_view const source, usize const offset) {
+    auto const byte = [&](usize const index) {
+        return static_cast<u8>(source[offset + index]);
+    };
+    auto const available = source.size() - offset;
+    auto const lead = byte(0);
+    if (lead < 0x80) {
+        return 1;
+    }
+    // Table 3-7 of the Unicode Standard: Only the second byte has a restricted range, depending on the lead byte.
+    if (lead >= 0xC2 and lead <= 0xDF) {
+        return available >= 2 and is_continuation_byte(byte(1)) ? 2 : 0;
+    }
+    if (lead >= 0xE0 and lead <= 0xEF) {
+        auto const low = lead == 0xE0 ? u8{ 0xA0 } : u8{ 0x80 };
+        auto const high = lead == 0xED ? u8{ 0x9F } : u8{ 0xBF };
+        return available >= 3 and is_continuation_byte(byte(1), low, high) and is_continuation_byte(byte(2)) ? 3 : 0;
+    }
+    if (lead >= 0xF0 and lead <= 0xF4) {
+        auto const low = lead == 0xF0 ? u8{ 0x90 } : u8{ 0x80 };
+        auto const high = lead == 0xF4 ? u8{ 0x8F } : u8{ 0xBF };
+        return available >= 4 and is_continuation_byte(byte(1), low, high) and is_continuation_byte(byte(2))
+                       and is_continuation_byte(byte(3))
+                   ? 4
+                   : 0;
+    }
+    return 0;
+}
+
+[[nodiscard]] usize find_invalid_utf8(std::string_view const source, usize offset) {
+    while (true) {
+        offset = skip_ascii(source, offset);
+        if (offset == source.size()) {
+            return offset;
+        }
+        auto const length = utf8_sequence_length(source, offset);
+        if (length == 0) {
+            return offset;
+        }
+        offset += length;
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <lib2k/types.hpp>
+#include <string_view>
+
+// Returns the length of the well-formed UTF-8 sequence (as defined by RFC 3629) that starts at `offset`, or zero if
+// there is none. Overlong encodings, surrogates, and code points above U+10FFFF are ill-formed.
+[[nodiscard]] usize utf8_sequence_length(std::string_view source, usize offset);
+
+// Returns the offset of the first byte at or after `offset` that is not part of a well-formed UTF-8 sequence, or
+// `source.size()` if there is none. Runs of ASCII characters are skipped by a vectorized scanner, so only the
+// non-ASCII characters themselves are decoded one by one.
+[[nodiscard]] usize find_invalid_utf8(std::string_view source, usize offset);
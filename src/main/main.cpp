@@ -1,31 +1,535 @@
+#include <algorithm>
+#include <cache/cached_compilation.hpp>
+#include <cache/compilation_cache.hpp>
+#include <cerrno>
+#include <charconv>
+#include <concepts>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <diagnostics/diagnostics.hpp>
-#include <filesystem>
-#include <fstream>
+#include <iostream>
 #include <lexer/lexer.hpp>
+#include <lexer/source_buffer.hpp>
+#include <lib2k/defer.hpp>
+#include <memory>
+#include <optional>
 #include <parser/parser.hpp>
 #include <print>
+#include <profiling/profiler.hpp>
+#include <ranges>
+#include <span>
 #include <sstream>
+#include <stdexcept>
+#include <string>
 #include <string_view>
+#include <type_traits>
+#include <tracing/trace.hpp>
+#include <utility>
+#include <vector>
 
-[[nodiscard]] std::string read_file(std::filesystem::path const& path) {
-    auto file = std::ifstream{ path };
-    auto stream = std::ostringstream{};
-    stream << file.rdbuf();
-    if (not file) {
-        throw std::runtime_error{ "Failed to read file" };
+[[nodiscard]] static std::shared_ptr<SourceFile const> load_source_file(std::string_view const path) {
+    // By convention, `-` stands for standard input.
+    if (path == "-") {
+        return std::make_shared<SourceFile const>("<stdin>", SourceBuffer::from_standard_input());
     }
-    return std::move(stream).str();
+    return std::make_shared<SourceFile const>(path, SourceBuffer::from_file(path));
 }
 
-int main() {
+[[nodiscard]] static DumpFormat parse_dump_format(std::string_view const name) {
+    if (name == "tree") {
+        return DumpFormat::Tree;
+    }
+    if (name == "json") {
+        return DumpFormat::Json;
+    }
+    if (name == "binary") {
+        return DumpFormat::Binary;
+    }
+    throw_or_abort(std::invalid_argument{ std::format("Unknown AST format '{}'.", name) });
+}
+
+static constexpr auto default_cache_size = u64{ 1024 } * 1024 * 1024;
+
+// What to do with the AST.
+struct OutputOptions final {
+    DumpFormat format = DumpFormat::Tree;
+    std::string_view save_path;  // If set, the (flat) AST is saved to this file instead of being dumped.
+};
+
+static void save_ast(FlatAst const& ast, std::string_view const path) {
+    auto const write_error = [&] {
+        return std::runtime_error{ std::format("Failed to write file '{}': {}", path, std::strerror(errno)) };
+    };
+    auto const file = std::fopen(std::string{ path }.c_str(), "wb");
+    if (file == nullptr) {
+        throw_or_abort(write_error());
+    }
+    auto const _ = c2k::Defer{ [&] { std::fclose(file); } };
+    auto sink = FileSink{ file };
+    ast.save(sink);
+    if (std::fflush(file) != 0) {
+        throw_or_abort(write_error());
+    }
+}
+
+template<typename Ast>
+static void write_output(Ast const& ast, OutputOptions const& options, Profiler& profiler) {
+    if constexpr (std::same_as<Ast, FlatAst>) {
+        if (not options.save_path.empty()) {
+            auto phase = profiler.measure("save");
+            save_ast(ast, options.save_path);
+            phase.count_nodes(ast.size());
+            return;
+        }
+    }
+    auto phase = profiler.measure("dump");
+    auto sink = FileSink{ stdout };
+    phase.count_nodes(ast.dump(sink, options.format));
+}
+
+template<typename Ast>
+[[nodiscard]] static int print_or_report(
+    Diagnostics const& diagnostics,
+    std::expected<Ast, DiagnosticId> const& ast,
+    OutputOptions const& options,
+    Profiler& profiler
+) {
+    if (not ast.has_value()) {
+        format_diagnostic_to(std::cout, diagnostics, ast.error());
+        return EXIT_FAILURE;
+    }
+    write_output(*ast, options, profiler);
+    return EXIT_SUCCESS;
+}
+
+// Reports every error, and prints the AST even if there have been errors.
+template<typename Ast>
+[[nodiscard]] static int print_with_errors(
+    Diagnostics const& diagnostics,
+    Ast const& ast,
+    OutputOptions const& options,
+    Profiler& profiler
+) {
+    for (auto i = usize{ 0 }; i < diagnostics.size(); ++i) {
+        format_diagnostic_to(std::cout, diagnostics, DiagnosticId{ static_cast<u32>(i) });
+    }
+    write_output(ast, options, profiler);
+    return diagnostics.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Records the tokens twice for the memory report: as they are stored, and as if they were stored as `Token` objects.
+static void add_token_structures(Profiler& profiler, TokenBuffer const& tokens) {
+    if (not profiler.measures_memory()) {
+        return;
+    }
+    profiler.add_structure("tokens", 0, tokens.size(), tokens.memory_usage());
+    profiler.add_structure(
+        std::format("as Token objects ({} B each)", sizeof(Token)),
+        1,
+        tokens.size(),
+        tokens.size() * sizeof(Token)
+    );
+}
+
+// Records the size of the whole tree and of the nodes of each kind for the memory report, with the largest kinds first.
+static void add_node_structures(
+    Profiler& profiler,
+    std::string_view const name,
+    usize const num_bytes,
+    NodeStatistics const& statistics
+) {
+    auto entries = std::vector<NodeStatistics::Entry>{ statistics.entries().begin(), statistics.entries().end() };
+    std::ranges::sort(entries, std::ranges::greater{}, &NodeStatistics::Entry::num_bytes);
+    auto num_nodes = u64{ 0 };
+    for (auto const& entry : entries) {
+        num_nodes += entry.num_nodes;
+    }
+    profiler.add_structure(std::string{ name }, 0, num_nodes, num_bytes);
+    for (auto const& [kind, num_kind_nodes, num_kind_bytes] : entries) {
+        profiler.add_structure(std::string{ kind }, 1, num_kind_nodes, num_kind_bytes);
+    }
+}
+
+static void add_ast_structures(Profiler& profiler, Ast const& ast) {
+    if (profiler.measures_memory()) {
+        add_node_structures(profiler, "AST arena", ast.arena().bytes_allocated(), ast.node_statistics());
+    }
+}
+
+static void add_ast_structures(Profiler& profiler, FlatAst const& ast) {
+    if (profiler.measures_memory()) {
+        add_node_structures(profiler, "flat AST", ast.memory_usage(), ast.node_statistics());
+    }
+}
+
+template<typename Ast>
+static void add_ast_structures(Profiler& profiler, std::expected<Ast, DiagnosticId> const& ast) {
+    if (ast.has_value()) {
+        add_ast_structures(profiler, *ast);
+    }
+}
+
+// With a report or a trace, the source is lexed completely before it is parsed, so that both phases are measured
+// separately. Returns nothing otherwise, or if there is a lexer error. In the latter case, the source has to be lexed
+// while parsing, so that errors are reported in the same order as without a report.
+[[nodiscard]] static std::optional<TokenBuffer> lex_separately(
+    std::shared_ptr<SourceFile const> const& file,
+    LexerOptions const& lexer_options,
+    Profiler& profiler
+) {
+    if (not profiler.is_enabled() and not is_tracing()) {
+        return std::nullopt;
+    }
+    auto diagnostics = Diagnostics{};
+    auto tokens = [&] {
+        auto phase = profiler.measure("lex");
+        phase.count_bytes(file->source().size());
+        auto result = try_tokenize(diagnostics, file, std::make_shared<Interner>(), lexer_options);
+        phase.count_tokens(result.has_value() ? result->size() : 0);
+        return result;
+    }();
+    if (not tokens.has_value()) {
+        return std::nullopt;
+    }
+    add_token_structures(profiler, *tokens);
+    return std::move(*tokens);
+}
+
+// Calls `compile` with the tokens of `file`, which are either a `TokenBuffer` (see `lex_separately()`) or a
+// `TokenStream`.
+template<typename Compile>
+static auto with_tokens(
+    std::shared_ptr<SourceFile const> const& file,
+    LexerOptions const& lexer_options,
+    Profiler& profiler,
+    Compile const& compile
+) {
+    if (auto tokens = lex_separately(file, lexer_options, profiler); tokens.has_value()) {
+        return compile(std::move(*tokens));
+    }
+    return compile(TokenStream{ file, std::make_shared<Interner>(), lexer_options });
+}
+
+// Calls `parse` in the phase "parse". If `tokens` is a `TokenStream`, this includes lexing.
+template<typename Tokens, std::invocable<Tokens&&> Parse>
+[[nodiscard]] static auto measure_parse(Profiler& profiler, Tokens&& tokens, Parse const& parse) {
+    auto ast = [&] {
+        auto phase = profiler.measure("parse");
+        if constexpr (std::same_as<std::remove_cvref_t<Tokens>, TokenBuffer>) {
+            phase.count_tokens(tokens.size());
+        }
+        auto result = parse(std::forward<Tokens>(tokens));
+        if constexpr (std::same_as<decltype(result), FlatAst>) {
+            phase.count_nodes(result.size());
+        } else if constexpr (std::same_as<decltype(result), std::expected<FlatAst, DiagnosticId>>) {
+            phase.count_nodes(result.has_value() ? result->size() : 0);
+        }
+        return result;
+    }();
+    add_ast_structures(profiler, ast);
+    return ast;
+}
+
+// The key covers everything that the outputs depend on: the compiler, the options, the path (which is part of the
+// diagnostics and of the dumps), and the source itself.
+[[nodiscard]] static Hash128 cache_key(SourceFile const& file, LexerOptions const& lexer_options, bool const recover) {
+    auto const inputs = std::format(
+        "{}\n{}\n{}\n{}\n{}",
+        CompilationCache::compiler_salt,
+        FlatAst::file_version,
+        file.path(),
+        static_cast<int>(lexer_options.utf8_mode),
+        recover
+    );
+    auto const seed = hash_128(inputs);
+    return hash_128(file.source(), seed.low ^ seed.high);
+}
+
+// Writes the outputs of a cached compilation. Returns its exit code, or nothing if it is not cached (see
+// `load_compilation()`).
+[[nodiscard]] static std::optional<int> replay_cached(
+    CompilationCache& cache,
+    Hash128 const key,
+    OutputOptions const& output,
+    Profiler& profiler
+) {
+    auto compilation = std::optional<CachedCompilation>{};
+    {
+        auto phase = profiler.measure("load");
+        compilation = load_compilation(cache, key);
+        if (not compilation.has_value()) {
+            return std::nullopt;
+        }
+        if (compilation->ast.has_value()) {
+            phase.count_nodes(compilation->ast->size());
+        }
+    }
+    std::cout << compilation->diagnostics;
+    if (compilation->ast.has_value()) {
+        write_output(*compilation->ast, output, profiler);
+    }
+    return compilation->exit_code;
+}
+
+// Compiles like `--flat-ast` does, which produces the same outputs as the pointer-based AST, and stores the outputs in
+// the cache.
+[[nodiscard]] static int compile_and_store(
+    CompilationCache& cache,
+    Hash128 const key,
+    std::shared_ptr<SourceFile const> const& file,
+    LexerOptions const& lexer_options,
+    bool const recover,
+    OutputOptions const& output,
+    Profiler& profiler
+) {
+    auto diagnostics = Diagnostics{};
+    auto messages = std::ostringstream{};
+    auto ast = std::optional<FlatAst>{};
+    with_tokens(file, lexer_options, profiler, [&](auto&& tokens) {
+        if (recover) {
+            ast = measure_parse(profiler, std::move(tokens), [&](auto&& parsed_tokens) {
+                return parse_flat_with_recovery(diagnostics, std::move(parsed_tokens));
+            });
+            for (auto i = usize{ 0 }; i < diagnostics.size(); ++i) {
+                format_diagnostic_to(messages, diagnostics, DiagnosticId{ static_cast<u32>(i) });
+            }
+            return;
+        }
+        auto result = measure_parse(profiler, std::move(tokens), [&](auto&& parsed_tokens) {
+            return try_parse_flat(diagnostics, std::move(parsed_tokens));
+        });
+        if (result.has_value()) {
+            ast = std::move(*result);
+        } else {
+            format_diagnostic_to(messages, diagnostics, result.error());
+        }
+    });
+    auto const compilation = CachedCompilation{
+        diagnostics.empty() ? EXIT_SUCCESS : EXIT_FAILURE,
+        std::move(messages).str(),
+        std::move(ast),
+    };
+    {
+        auto const phase = profiler.measure("store");
+        store_compilation(cache, key, compilation);
+    }
+
+    std::cout << compilation.diagnostics;
+    if (compilation.ast.has_value()) {
+        write_output(*compilation.ast, output, profiler);
+    }
+    return compilation.exit_code;
+}
+
+[[nodiscard]] static int run_cached(
+    CompilationCache& cache,
+    std::shared_ptr<SourceFile const> const& file,
+    LexerOptions const& lexer_options,
+    bool const recover,
+    OutputOptions const& output,
+    Profiler& profiler
+) {
+    auto const key = cache_key(*file, lexer_options, recover);
+    if (auto const exit_code = replay_cached(cache, key, output, profiler); exit_code.has_value()) {
+        cache.record_hit();
+        return *exit_code;
+    }
+    cache.record_miss();
+    return compile_and_store(cache, key, file, lexer_options, recover, output, profiler);
+}
+
+// Compiles without a cache.
+[[nodiscard]] static int compile(
+    std::shared_ptr<SourceFile const> const& file,
+    LexerOptions const& lexer_options,
+    bool const flat_ast,
+    bool const recover,
+    OutputOptions const& output,
+    Profiler& profiler
+) {
+    return with_tokens(file, lexer_options, profiler, [&](auto&& tokens) {
+        auto diagnostics = Diagnostics{};
+        auto const parse = [&](auto const& parser) { return measure_parse(profiler, std::move(tokens), parser); };
+        if (recover and flat_ast) {
+            auto const ast = parse([&](auto&& parsed_tokens) {
+                return parse_flat_with_recovery(diagnostics, std::move(parsed_tokens));
+            });
+            return print_with_errors(diagnostics, ast, output, profiler);
+        }
+        if (recover) {
+            auto const ast = parse([&](auto&& parsed_tokens) {
+                return parse_with_recovery(diagnostics, std::move(parsed_tokens));
+            });
+            return print_with_errors(diagnostics, ast, output, profiler);
+        }
+        if (flat_ast) {
+            auto const ast = parse([&](auto&& parsed_tokens) {
+                return try_parse_flat(diagnostics, std::move(parsed_tokens));
+            });
+            return print_or_report(diagnostics, ast, output, profiler);
+        }
+        auto const ast = parse([&](auto&& parsed_tokens) { return try_parse(diagnostics, std::move(parsed_tokens)); });
+        return print_or_report(diagnostics, ast, output, profiler);
+    });
+}
+
+[[nodiscard]] static std::shared_ptr<SourceFile const> read_source_file(std::string_view const path, Profiler& profiler) {
+    auto file = [&] {
+        auto phase = profiler.measure("read");
+        auto result = load_source_file(path);
+        phase.count_bytes(result->source().size());
+        return result;
+    }();
+    profiler.add_structure("source", 0, 0, file->source().size());
+    return file;
+}
+
+[[nodiscard]] static u64 parse_size(std::string_view const text) {
+    auto size = u64{};
+    auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), size);
+    if (error != std::errc{} or end != text.data() + text.size()) {
+        throw_or_abort(std::invalid_argument{ std::format("Invalid size '{}'.", text) });
+    }
+    return size;
+}
+
+struct DriverOptions final {
+    std::string_view path = "test/block.pas";
+    LexerOptions lexer_options;
+    bool flat_ast = false;
+    bool recover = false;
+    bool load_ast = false;
+    OutputOptions output;
+    std::string_view cache_directory;
+    u64 cache_size = default_cache_size;
+    bool print_cache_statistics = false;
+    bool print_time_report = false;
+    bool print_memory_report = false;
+    std::string_view trace_path;
+};
+
+[[nodiscard]] static DriverOptions parse_arguments(std::span<char const* const> const arguments) {
     using namespace std::string_view_literals;
-    static constexpr auto path = "test/block.pas"sv;
-    auto const source = read_file(path);
+    auto options = DriverOptions{};
+    for (auto const argument : arguments | std::views::drop(1)) {
+        if (argument == "--utf8-comments"sv) {
+            options.lexer_options.utf8_mode = Utf8Mode::Comments;
+        } else if (argument == "--utf8"sv) {
+            options.lexer_options.utf8_mode = Utf8Mode::CommentsAndStrings;
+        } else if (argument == "--flat-ast"sv) {
+            options.flat_ast = true;
+        } else if (argument == "--recover"sv) {
+            options.recover = true;
+        } else if (std::string_view{ argument }.starts_with("--ast-format="sv)) {
+            options.output.format = parse_dump_format(std::string_view{ argument }.substr("--ast-format="sv.length()));
+        } else if (std::string_view{ argument }.starts_with("--save-ast="sv)) {
+            options.output.save_path = std::string_view{ argument }.substr("--save-ast="sv.length());
+            options.flat_ast = true;
+        } else if (argument == "--load-ast"sv) {
+            options.load_ast = true;
+        } else if (std::string_view{ argument }.starts_with("--cache-dir="sv)) {
+            options.cache_directory = std::string_view{ argument }.substr("--cache-dir="sv.length());
+        } else if (std::string_view{ argument }.starts_with("--cache-size="sv)) {
+            options.cache_size = parse_size(std::string_view{ argument }.substr("--cache-size="sv.length()));
+        } else if (argument == "--cache-stats"sv) {
+            options.print_cache_statistics = true;
+        } else if (argument == "--time-report"sv) {
+            options.print_time_report = true;
+        } else if (argument == "--mem-report"sv) {
+            options.print_memory_report = true;
+        } else if (std::string_view{ argument }.starts_with("--trace="sv)) {
+            options.trace_path = std::string_view{ argument }.substr("--trace="sv.length());
+        } else if (std::string_view{ argument }.starts_with("--")) {
+            throw_or_abort(std::invalid_argument{ std::format("Unknown option '{}'.", argument) });
+        } else {
+            options.path = argument;
+        }
+    }
+    if (options.print_cache_statistics and options.cache_directory.empty()) {
+        throw_or_abort(std::invalid_argument{ "'--cache-stats' requires '--cache-dir'." });
+    }
+    return options;
+}
+
+[[nodiscard]] static int run(DriverOptions const& options, Profiler& profiler) {
+    auto const trace = TraceScope{ "compile", options.path };
+    if (options.load_ast) {
+        auto ast = std::optional<FlatAst>{};
+        {
+            auto phase = profiler.measure("load");
+            ast = FlatAst::load(options.path);
+            phase.count_nodes(ast->size());
+        }
+        add_ast_structures(profiler, *ast);
+        write_output(*ast, options.output, profiler);
+        return EXIT_SUCCESS;
+    }
+    auto const file = read_source_file(options.path, profiler);
+    if (options.cache_directory.empty()) {
+        return compile(file, options.lexer_options, options.flat_ast, options.recover, options.output, profiler);
+    }
+    auto cache = CompilationCache{ options.cache_directory, options.cache_size };
+    auto const exit_code = run_cached(cache, file, options.lexer_options, options.recover, options.output, profiler);
+    if (options.print_cache_statistics) {
+        auto const [num_hits, num_misses, num_entries, size] = cache.statistics();
+        std::println(
+            stderr,
+            "Cache: {} hits, {} misses, {} entries, {} bytes",
+            num_hits,
+            num_misses,
+            num_entries,
+            size
+        );
+    }
+    return exit_code;
+}
+
+[[nodiscard]] static int run(std::span<char const* const> const arguments) {
+    auto const options = parse_arguments(arguments);
+    auto profiler = Profiler{ Profiler::Options{ options.print_time_report, options.print_memory_report } };
+    auto is_trace_pending = not options.trace_path.empty();
+    if (is_trace_pending) {
+        start_tracing();
+    }
+#if PASC2K_EXCEPTIONS
+    // The trace is also written if compiling throws, since it shows how far compiling got. Failing to write it is
+    // ignored then, so that the original error is reported.
+    auto const _ = c2k::Defer{ [&] {
+        if (is_trace_pending) {
+            try {
+                write_trace(options.trace_path);
+            } catch (std::exception const&) {}
+        }
+    } };
+#endif
+    auto exit_code = EXIT_FAILURE;
+    {
+        auto const total = profiler.measure("total");
+        exit_code = run(options, profiler);
+    }
+    if (is_trace_pending) {
+        is_trace_pending = false;
+        write_trace(options.trace_path);
+    }
+    if (profiler.is_enabled()) {
+        std::cout << std::flush;
+        profiler.format_report_to(std::cerr);
+    }
+    return exit_code;
+}
+
+int main(int const argc, char const* const* const argv) {
+    auto const arguments = std::span{ argv, static_cast<usize>(argc) };
+#if PASC2K_EXCEPTIONS
+    // Lexer and parser errors are handled by `run()`. This is for invalid arguments and I/O errors.
     try {
-        auto const ast = parse(tokenize(path, source));
-        ast.print();
+        return run(arguments);
     } catch (std::exception const& e) {
         format_error_to(std::cout, e);
         return EXIT_FAILURE;
     }
+#else
+    return run(arguments);
+#endif
 }
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <concepts>
+#include <memory>
+#include <memory_resource>
+#include <parser/arena.hpp>
+#include <parser/ast.hpp>
+#include <parser/constant_definition.hpp>
+#include <parser/type_definition.hpp>
+#include <parser/variable_declarations.hpp>
+#include <tl/optional.hpp>
+#include <type_traits>
+#include <vector>
+
+// Creates the nodes of an `Ast` for the `Parser`.
+class AstBuilder final {
+private:
+    std::unique_ptr<Arena> m_arena = std::make_unique<Arena>();  // Handed over to the AST.
+
+public:
+    using Result = Ast;
+
+    // Polymorphic nodes and the root are allocated from the arena. All other nodes are stored within their parents.
+    template<typename T>
+    using Node = std::conditional_t<std::is_abstract_v<T> or std::same_as<T, Block>, ArenaPtr<T>, T>;
+
+    template<typename T>
+    using List = std::pmr::vector<Node<T>>;
+
+    [[nodiscard]] Ast finish(
+        std::shared_ptr<SourceFile const> file,
+        std::shared_ptr<Interner const> interner,
+        ArenaPtr<Block> const block
+    ) {
+        return Ast{ std::move(file), std::move(interner), std::move(m_arena), block };
+    }
+
+    template<typename Element>
+    [[nodiscard]] std::pmr::vector<Element> list(Element first) {
+        auto result = std::pmr::vector<Element>{ m_arena.get() };
+        result.push_back(std::move(first));
+        return result;
+    }
+
+    template<typename Element>
+    void append(std::pmr::vector<Element>& list, std::type_identity_t<Element> element) {
+        list.push_back(std::move(element));
+    }
+
+    [[nodiscard]] ArenaPtr<Block> block(
+        tl::optional<LabelDeclarations>&& label_declarations,
+        tl::optional<ConstantDefinitions>&& constant_definitions,
+        tl::optional<TypeDefinitions>&& type_definitions,
+        tl::optional<VariableDeclarations>&& variable_declarations
+    ) {
+        return m_arena->create<Block>(
+            std::move(label_declarations),
+            std::move(constant_definitions),
+            std::move(type_definitions),
+            std::move(variable_declarations)
+        );
+    }
+
+    [[nodiscard]] LabelDeclarations label_declarations(Token const& label_token, List<LabelDeclaration>&& labels) {
+        return LabelDeclarations{ label_token, std::move(labels) };
+    }
+
+    [[nodiscard]] LabelDeclaration label_declaration(IntegerLiteral const& integer_literal) {
+        return LabelDeclaration{ integer_literal };
+    }
+
+    [[nodiscard]] ConstantDefinitions constant_definitions(
+        Token const& const_token,
+        List<ConstantDefinition>&& definitions
+    ) {
+        return ConstantDefinitions{ const_token, std::move(definitions) };
+    }
+
+    [[nodiscard]] ConstantDefinition constant_definition(
+        Identifier const& identifier,
+        ArenaPtr<Constant> const constant
+    ) {
+        return ConstantDefinition{ identifier, constant };
+    }
+
+    [[nodiscard]] ArenaPtr<Constant> integer_constant(tl::optional<Token> const& sign, IntegerLiteral const& value) {
+        return m_arena->create<IntegerConstant>(sign, value);
+    }
+
+    [[nodiscard]] ArenaPtr<Constant> real_constant(tl::optional<Token> const& sign, RealLiteral const& value) {
+        return m_arena->create<RealConstant>(sign, value);
+    }
+
+    [[nodiscard]] ArenaPtr<Constant> char_constant(Token const& token, LiteralPool const& literals) {
+        return m_arena->create<CharConstant>(CharLiteral{ token, literals });
+    }
+
+    [[nodiscard]] ArenaPtr<Constant> string_constant(Token const& token, LiteralPool const& literals) {
+        return m_arena->create<StringConstant>(StringLiteral{ token, literals });
+    }
+
+    [[nodiscard]] ArenaPtr<Constant> constant_reference(tl::optional<Token> const& sign, Token const& identifier) {
+        return m_arena->create<ConstantReference>(sign, identifier);
+    }
+
+    // The constant that could not be parsed is discarded.
+    [[nodiscard]] ArenaPtr<Constant> error_constant(ArenaPtr<Constant>, SourceFile const& file, SourceSpan const span) {
+        return m_arena->create<ErrorConstant>(file, span);
+    }
+
+    [[nodiscard]] TypeDefinitions type_definitions(Token const& type_token, List<TypeDefinition>&& definitions) {
+        return TypeDefinitions{ type_token, std::move(definitions) };
+    }
+
+    [[nodiscard]] TypeDefinition type_definition(Identifier const& identifier, ArenaPtr<Type> const type) {
+        return TypeDefinition{ identifier, type };
+    }
+
+    // The type that could not be parsed is discarded.
+    [[nodiscard]] ArenaPtr<Type> error_type(ArenaPtr<Type>, SourceFile const& file, SourceSpan const span) {
+        return m_arena->create<ErrorType>(file, span);
+    }
+
+    [[nodiscard]] ArenaPtr<Type> real_type(Token const& token) {
+        return m_arena->create<RealType>(token);
+    }
+
+    [[nodiscard]] ArenaPtr<OrdinalType> boolean_type(Token const& token) {
+        return m_arena->create<BooleanType>(token);
+    }
+
+    [[nodiscard]] ArenaPtr<OrdinalType> char_type(Token const& token) {
+        return m_arena->create<CharType>(token);
+    }
+
+    [[nodiscard]] ArenaPtr<OrdinalType> integer_type(Token const& token) {
+        return m_arena->create<IntegerType>(token);
+    }
+
+    [[nodiscard]] ArenaPtr<OrdinalType> type_alias_definition(Identifier const& referenced_type) {
+        return m_arena->create<TypeAliasDefinition>(referenced_type);
+    }
+
+    [[nodiscard]] ArenaPtr<OrdinalType> enumerated_type_definition(
+        Token const& left_parenthesis,
+        IdentifierList&& identifiers,
+        Token const& right_parenthesis
+    ) {
+        return m_arena->create<EnumeratedTypeDefinition>(left_parenthesis, std::move(identifiers), right_parenthesis);
+    }
+
+    [[nodiscard]] ArenaPtr<OrdinalType> subrange_type_definition(
+        ArenaPtr<Constant> const from,
+        ArenaPtr<Constant> const to
+    ) {
+        return m_arena->create<SubrangeTypeDefinition>(from, to);
+    }
+
+    [[nodiscard]] ArenaPtr<Type> structured_type_definition(
+        tl::optional<Token> const& packed,
+        ArenaPtr<UnpackedStructuredTypeDefinition> const unpacked_structured_type_definition
+    ) {
+        return m_arena->create<StructuredTypeDefinition>(packed, unpacked_structured_type_definition);
+    }
+
+    [[nodiscard]] ArenaPtr<UnpackedStructuredTypeDefinition> array_type_definition(
+        Token const& array_token,
+        List<OrdinalType>&& index_types,
+        ArenaPtr<Type> const component_type
+    ) {
+        return m_arena->create<ArrayTypeDefinition>(array_token, std::move(index_types), component_type);
+    }
+
+    [[nodiscard]] ArenaPtr<UnpackedStructuredTypeDefinition> record_type_definition(
+        Token const& record_token,
+        tl::optional<FieldList>&& field_list,
+        Token const& end_token
+    ) {
+        return m_arena->create<RecordTypeDefinition>(record_token, std::move(field_list), end_token);
+    }
+
+    [[nodiscard]] ArenaPtr<UnpackedStructuredTypeDefinition> set_type_definition(
+        Token const& set_token,
+        ArenaPtr<OrdinalType> const base_type
+    ) {
+        return m_arena->create<SetTypeDefinition>(set_token, base_type);
+    }
+
+    [[nodiscard]] ArenaPtr<UnpackedStructuredTypeDefinition> file_type_definition(
+        Token const& file_token,
+        ArenaPtr<Type> const component_type
+    ) {
+        return m_arena->create<FileTypeDefinition>(file_token, component_type);
+    }
+
+    // `referenced_type` is an identifier or a built-in type.
+    [[nodiscard]] ArenaPtr<Type> pointer_type_definition(Token const& up_arrow_token, Token const& referenced_type) {
+        return m_arena->create<PointerTypeDefinition>(up_arrow_token, pointer_target(referenced_type));
+    }
+
+    [[nodiscard]] FieldList field_list(tl::optional<FixedPart>&& fixed_part, tl::optional<VariantPart>&& variant_part) {
+        return FieldList{ std::move(fixed_part), std::move(variant_part) };
+    }
+
+    [[nodiscard]] FixedPart fixed_part(List<RecordSection>&& record_sections) {
+        return FixedPart{ std::move(record_sections) };
+    }
+
+    [[nodiscard]] RecordSection record_section(IdentifierList&& identifiers, ArenaPtr<Type> const type) {
+        return RecordSection{ std::move(identifiers), type };
+    }
+
+    [[nodiscard]] VariantPart variant_part(
+        Token const& case_token,
+        VariantSelector&& variant_selector,
+        VariantList&& variant_list
+    ) {
+        return VariantPart{ case_token, std::move(variant_selector), std::move(variant_list) };
+    }
+
+    [[nodiscard]] VariantSelector variant_selector(
+        tl::optional<Identifier> const& tag_field,
+        ArenaPtr<OrdinalType> const tag_type
+    ) {
+        return VariantSelector{ tag_field, tag_type };
+    }
+
+    [[nodiscard]] VariantList variant_list(List<Variant>&& variants) {
+        return VariantList{ std::move(variants) };
+    }
+
+    [[nodiscard]] Variant variant(
+        CaseConstantList&& case_constant_list,
+        tl::optional<FieldList>&& field_list,
+        Token const& closing_parenthesis
+    ) {
+        auto field_list_pointer = field_list.map([&](FieldList& value) {
+            return m_arena->create<FieldList>(std::move(value));
+        });
+        return Variant{ std::move(case_constant_list), field_list_pointer, closing_parenthesis };
+    }
+
+    [[nodiscard]] CaseConstantList case_constant_list(List<Constant>&& constants) {
+        return CaseConstantList{ std::move(constants) };
+    }
+
+    [[nodiscard]] VariableDeclarations variable_declarations(
+        Token const& var_token,
+        List<VariableDeclaration>&& declarations
+    ) {
+        return VariableDeclarations{ var_token, std::move(declarations) };
+    }
+
+    [[nodiscard]] VariableDeclaration variable_declaration(IdentifierList&& identifiers, ArenaPtr<Type> const type) {
+        return VariableDeclaration{ std::move(identifiers), type };
+    }
+
+    [[nodiscard]] IdentifierList identifier_list(List<Identifier>&& identifiers) {
+        return IdentifierList{ std::move(identifiers) };
+    }
+
+    [[nodiscard]] Identifier identifier(Token const& token) {
+        return Identifier{ token };
+    }
+
+    [[nodiscard]] IntegerLiteral integer_literal(Token const& token, i64 const value) {
+        return IntegerLiteral{ token, value };
+    }
+
+    [[nodiscard]] RealLiteral real_literal(Token const& token, double const value) {
+        return RealLiteral{ token, value };
+    }
+
+private:
+    [[nodiscard]] static PointerTypeDefinition::ReferencedType pointer_target(Token const& token) {
+        switch (token.type()) {
+            case TokenType::Integer:
+                return IntegerType{ token };
+            case TokenType::Real:
+                return RealType{ token };
+            case TokenType::Char:
+                return CharType{ token };
+            case TokenType::Boolean:
+                return BooleanType{ token };
+            default:
+                return Identifier{ token };
+        }
+    }
+};
@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <common/common.hpp>
+#include <cstring>
+#include <format>
+#include <parser/ast_dumper.hpp>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+[[nodiscard]] static std::runtime_error write_error(int const error_number) {
+    return std::runtime_error{ std::format("Failed to write AST dump: {}", std::strerror(error_number)) };
+}
+
+void FileSink::write(std::string_view const data) {
+    if (std::fwrite(data.data(), 1, data.size(), m_file) != data.size()) {
+        throw_or_abort(write_error(errno));
+    }
+}
+
+void FileDescriptorSink::write(std::string_view data) {
+    while (not data.empty()) {
+#if defined(__unix__) || defined(__APPLE__)
+        auto const written = ::write(m_file_descriptor, data.data(), data.size());
+#else
+        auto const written = ::_write(m_file_descriptor, data.data(), static_cast<unsigned>(data.size()));
+#endif
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_or_abort(write_error(errno));
+        }
+        data.remove_prefix(static_cast<usize>(written));
+    }
+}
+
+AstDumper::AstDumper(DumpSink& sink, DumpFormat const format, SourceFile const& file)
+    : m_sink{ &sink }, m_format{ format }, m_file{ &file } {
+    m_buffer.reserve(chunk_size + chunk_size / 4);
+    switch (m_format) {
+        case DumpFormat::Tree:
+            break;
+        case DumpFormat::Json:
+            m_buffer += R"({"file":)";
+            write_json_string(file.path());
+            m_buffer += R"(,"root":)";
+            break;
+        case DumpFormat::Binary:
+            m_buffer += "P2KD";
+            m_buffer += static_cast<char>(binary_version);
+            write_binary_string(file.path());
+            break;
+    }
+}
+
+void AstDumper::begin_node(SourceSpan const span, std::string_view const kind) {
+    assert(not m_writing_values);
+    assert(m_levels.empty() or m_levels.back().current_child < m_levels.back().num_children);
+    m_writing_values = true;
+    m_num_values = 0;
+    ++m_num_nodes;
+    switch (m_format) {
+        case DumpFormat::Tree: {
+            auto const is_last_child = [](Level const& level) { return level.current_child + 1 == level.num_children; };
+            if (not m_levels.empty()) {
+                for (auto i = usize{ 0 }; i < m_levels.size() - 1; ++i) {
+                    m_buffer += is_last_child(m_levels[i]) ? "  " : "| ";
+                }
+                m_buffer += is_last_child(m_levels.back()) ? "`-" : "|-";
+            }
+            m_buffer += kind;
+            m_buffer += " [";
+            write_location(span.offset);
+            m_buffer += ", ";
+            write_location(span.end());
+            m_buffer += ']';
+            break;
+        }
+        case DumpFormat::Json:
+            if (not m_levels.empty() and m_levels.back().current_child > 0) {
+                m_buffer += ',';
+            }
+            m_buffer += R"({"kind":)";
+            write_json_string(kind);
+            m_buffer += R"(,"offset":)";
+            write_number(span.offset);
+            m_buffer += R"(,"length":)";
+            write_number(span.length);
+            m_buffer += R"(,"begin":)";
+            write_location(span.offset);
+            m_buffer += R"(,"end":)";
+            write_location(span.end());
+            m_buffer += R"(,"values":[)";
+            break;
+        case DumpFormat::Binary: {
+            auto const [entry, is_new] = m_kinds.try_emplace(kind, m_kinds.size());
+            write_varint(entry->second + 1);
+            if (is_new) {
+                write_binary_string(kind);
+            }
+            write_varint(span.offset);
+            write_varint(span.length);
+            break;
+        }
+    }
+}
+
+void AstDumper::end_node() {
+    if (m_writing_values) {
+        end_values();
+    }
+    switch (m_format) {
+        case DumpFormat::Tree:
+            break;
+        case DumpFormat::Json:
+            m_buffer += "]}";
+            break;
+        case DumpFormat::Binary:
+            m_buffer += '\0';
+            break;
+    }
+    if (not m_levels.empty()) {
+        ++m_levels.back().current_child;
+    }
+    flush_if_full();
+}
+
+void AstDumper::begin_children(usize const num_children) {
+    assert(num_children > 0);
+    if (m_writing_values) {
+        end_values();
+    }
+    m_levels.push_back(Level{ num_children });
+}
+
+void AstDumper::end_children() {
+    assert(not m_levels.empty() and m_levels.back().current_child == m_levels.back().num_children);
+    m_levels.pop_back();
+}
+
+void AstDumper::value(i64 const value) {
+    assert(m_writing_values);
+    switch (m_format) {
+        case DumpFormat::Tree:
+            m_buffer += " '";
+            write_signed_number(value);
+            m_buffer += '\'';
+            break;
+        case DumpFormat::Json:
+            if (m_num_values > 0) {
+                m_buffer += ',';
+            }
+            write_signed_number(value);
+            break;
+        case DumpFormat::Binary:
+            m_buffer += 'i';
+            write_varint((static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63));
+            break;
+    }
+    ++m_num_values;
+}
+
+void AstDumper::value(double const value) {
+    assert(m_writing_values);
+    auto characters = std::array<char, 32>{};
+    auto const end = std::to_chars(characters.data(), characters.data() + characters.size(), value).ptr;
+    auto const text = std::string_view{ characters.data(), end };
+    switch (m_format) {
+        case DumpFormat::Tree:
+            m_buffer += " '";
+            m_buffer += text;
+            m_buffer += '\'';
+            break;
+        case DumpFormat::Json:
+            if (m_num_values > 0) {
+                m_buffer += ',';
+            }
+            // JSON cannot represent infinity and NaN.
+            m_buffer += std::isfinite(value) ? text : "null";
+            break;
+        case DumpFormat::Binary: {
+            auto const bits = std::bit_cast<u64>(value);
+            m_buffer += 'r';
+            for (auto i = 0; i < 8; ++i) {
+                m_buffer += static_cast<char>((bits >> (8 * i)) & 0xFF);
+            }
+            break;
+        }
+    }
+    ++m_num_values;
+}
+
+void AstDumper::value(char const value) {
+    this->value(std::string_view{ &value, 1 });
+}
+
+void AstDumper::value(std::string_view const value) {
+    assert(m_writing_values);
+    switch (m_format) {
+        case DumpFormat::Tree:
+            m_buffer += " '";
+            m_buffer += value;
+            m_buffer += '\'';
+            break;
+        case DumpFormat::Json:
+            if (m_num_values > 0) {
+                m_buffer += ',';
+            }
+            write_json_string(value);
+            break;
+        case DumpFormat::Binary:
+            m_buffer += 's';
+            write_binary_string(value);
+            break;
+    }
+    ++m_num_values;
+}
+
+void AstDumper::finish() {
+    assert(m_levels.empty() and not m_writing_values);
+    if (m_format == DumpFormat::Json) {
+        m_buffer += "}\n";
+    }
+    if (not m_buffer.empty()) {
+        m_sink->write(m_buffer);
+        m_buffer.clear();
+    }
+}
+
+void AstDumper::end_values() {
+    assert(m_writing_values);
+    m_writing_values = false;
+    switch (m_format) {
+        case DumpFormat::Tree:
+            m_buffer += '\n';
+            break;
+        case DumpFormat::Json:
+            m_buffer += R"(],"children":[)";
+            break;
+        case DumpFormat::Binary:
+            m_buffer += '\0';
+            break;
+    }
+}
+
+void AstDumper::flush_if_full() {
+    if (m_buffer.size() >= chunk_size) {
+        m_sink->write(m_buffer);
+        m_buffer.clear();
+    }
+}
+
+// Like `SourceFile::column_index()`, but counts the columns of `text`.
+[[nodiscard]] static usize num_columns(std::string_view const text) {
+    auto const num_continuation_bytes = std::ranges::count_if(text, [](char const c) {
+        return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+    });
+    return text.size() - static_cast<usize>(num_continuation_bytes);
+}
+
+// Nodes are mostly written in the order of their offsets, so the lookup continues from the previous location if it
+// is in the same line and not after `offset`.
+void AstDumper::write_location(usize const offset) {
+    auto const& file = *m_file;
+    auto const is_in_line = file.line_start(m_line) <= offset
+                            and (m_line + 1 == file.num_lines() or offset < file.line_start(m_line + 1));
+    if (not is_in_line) {
+        m_line = file.line_index(offset);
+    }
+    if (not is_in_line or offset < m_column_offset) {
+        m_column = 0;
+        m_column_offset = file.line_start(m_line);
+    }
+    m_column += num_columns(file.source().substr(m_column_offset, offset - m_column_offset));
+    m_column_offset = offset;
+    auto const line = m_line + 1;
+    auto const column = m_column + 1;
+    if (m_format == DumpFormat::Tree) {
+        m_buffer += file.path();
+        m_buffer += ':';
+        write_number(line);
+        m_buffer += ':';
+        write_number(column);
+    } else {
+        m_buffer += '[';
+        write_number(line);
+        m_buffer += ',';
+        write_number(column);
+        m_buffer += ']';
+    }
+}
+
+void AstDumper::write_json_string(std::string_view string) {
+    static constexpr auto hex_digits = std::string_view{ "0123456789abcdef" };
+    auto const needs_escaping = [](char const c) {
+        return c == '"' or c == '\\' or static_cast<unsigned char>(c) < 0x20;
+    };
+    m_buffer += '"';
+    // Most strings do not need escaping, so they are copied in as few pieces as possible.
+    while (not string.empty()) {
+        auto const plain_length = static_cast<usize>(std::ranges::find_if(string, needs_escaping) - string.begin());
+        m_buffer += string.substr(0, plain_length);
+        if (plain_length == string.size()) {
+            break;
+        }
+        switch (auto const c = string[plain_length]) {
+            case '"':
+                m_buffer += R"(\")";
+                break;
+            case '\\':
+                m_buffer += R"(\\)";
+                break;
+            case '\n':
+                m_buffer += R"(\n)";
+                break;
+            case '\t':
+                m_buffer += R"(\t)";
+                break;
+            default:
+                m_buffer += R"(\u00)";
+                m_buffer += hex_digits[static_cast<unsigned char>(c) >> 4];
+                m_buffer += hex_digits[static_cast<unsigned char>(c) & 0xF];
+                break;
+        }
+        string.remove_prefix(plain_length + 1);
+    }
+    m_buffer += '"';
+}
+
+void AstDumper::write_number(u64 const number) {
+    auto characters = std::array<char, 20>{};
+    auto const end = std::to_chars(characters.data(), characters.data() + characters.size(), number).ptr;
+    m_buffer.append(characters.data(), end);
+}
+
+void AstDumper::write_signed_number(i64 const number) {
+    auto characters = std::array<char, 20>{};
+    auto const end = std::to_chars(characters.data(), characters.data() + characters.size(), number).ptr;
+    m_buffer.append(characters.data(), end);
+}
+
+void AstDumper::write_varint(u64 number) {
+    while (number >= 0x80) {
+        m_buffer += static_cast<char>((number & 0x7F) | 0x80);
+        number >>= 7;
+    }
+    m_buffer += static_cast<char>(number);
+}
+
+void AstDumper::write_binary_string(std::string_view const string) {
+    write_varint(string.size());
+    m_buffer += string;
+}
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <magic_enum.hpp>
+#include <memory>
+#include <parser/ast_node.hpp>
+#include <parser/flat_ast.hpp>
+#include <vector>
+
+FlatAst::FlatAst(
+    std::shared_ptr<SourceFile const> file,
+    std::shared_ptr<Interner const> interner,
+    std::vector<NodeKind> kinds,
+    std::vector<SourceSpan> spans,
+    std::vector<u32> data
+)
+    : m_file{ std::move(file) }, m_interner{ std::move(interner) } {
+    struct Arrays final {
+        std::vector<NodeKind> kinds;
+        std::vector<SourceSpan> spans;
+        std::vector<u32> data;
+    };
+    auto const arrays = std::make_shared<Arrays const>(Arrays{ std::move(kinds), std::move(spans), std::move(data) });
+    m_kinds = arrays->kinds;
+    m_spans = arrays->spans;
+    m_data = arrays->data;
+    m_storage = arrays;
+    assert(not m_kinds.empty());
+    assert(m_spans.size() == m_kinds.size() and m_data.size() == m_kinds.size());
+    assert(subtree_size(root()) == size());
+}
+
+FlatAst::FlatAst(
+    std::shared_ptr<SourceFile const> file,
+    std::shared_ptr<Interner const> interner,
+    std::shared_ptr<void const> storage,
+    std::span<NodeKind const> const kinds,
+    std::span<SourceSpan const> const spans,
+    std::span<u32 const> const data
+)
+    : m_file{ std::move(file) },
+      m_interner{ std::move(interner) },
+      m_storage{ std::move(storage) },
+      m_kinds{ kinds },
+      m_spans{ spans },
+      m_data{ data } {}
+
+// Only valid for nodes with exactly one child, which directly precedes its parent.
+[[nodiscard]] static NodeIndex only_child(NodeIndex const node) {
+    return NodeIndex{ static_cast<u32>(node) - 1 };
+}
+
+// Signs and `packed` are not nodes of their own. They are the text between the start of a node and its content, i.e.,
+// its first child or the name of a constant reference.
+[[nodiscard]] static std::string_view prefix(
+    std::string_view const source,
+    SourceSpan const span,
+    u32 const content_offset,
+    usize const length
+) {
+    if (span.offset == content_offset) {
+        return {};
+    }
+    return source.substr(span.offset, length);
+}
+
+[[nodiscard]] std::string_view FlatAst::sign(NodeIndex const node) const {
+    switch (kind(node)) {
+        case NodeKind::IntegerConstant:
+        case NodeKind::RealConstant:
+            return prefix(m_file->source(), span(node), span(only_child(node)).offset, 1);
+        case NodeKind::ConstantReference: {
+            auto const name_length = static_cast<u32>(referenced_constant(node).length());
+            return prefix(m_file->source(), span(node), span(node).end() - name_length, 1);
+        }
+        default:
+            return {};
+    }
+}
+
+// The name is at the end of the span. It is preceded by the sign and possibly by comments, which cannot end with a
+// letter or digit.
+[[nodiscard]] std::string_view FlatAst::referenced_constant(NodeIndex const node) const {
+    assert(kind(node) == NodeKind::ConstantReference);
+    auto const text = m_file->source().substr(span(node).offset, span(node).length);
+    auto begin = text.length();
+    while (begin > 0 and std::isalnum(static_cast<unsigned char>(text[begin - 1]))) {
+        --begin;
+    }
+    return text.substr(begin);
+}
+
+[[nodiscard]] std::string_view FlatAst::packed(NodeIndex const node) const {
+    if (kind(node) != NodeKind::StructuredTypeDefinition) {
+        return {};
+    }
+    static constexpr auto keyword_length = std::string_view{ "packed" }.length();
+    return prefix(m_file->source(), span(node), span(only_child(node)).offset, keyword_length);
+}
+
+[[nodiscard]] usize FlatAst::memory_usage() const {
+    return m_kinds.size_bytes() + m_spans.size_bytes() + m_data.size_bytes();
+}
+
+[[nodiscard]] NodeStatistics FlatAst::node_statistics() const {
+    static constexpr auto bytes_per_node = sizeof(NodeKind) + sizeof(SourceSpan) + sizeof(u32);
+    auto statistics = NodeStatistics{};
+    for (auto const kind : m_kinds) {
+        statistics.add(magic_enum::enum_name(kind), bytes_per_node);
+    }
+    return statistics;
+}
+
+// `children` holds the children of the ancestors of `node`, so that it can be reused by all nodes.
+static void print_node(
+    FlatAst const& ast,
+    AstNode::PrintContext& context,
+    NodeIndex const node,
+    std::vector<NodeIndex>& children
+) {
+    auto const kind = ast.kind(node);
+    auto const name = magic_enum::enum_name(kind);
+    auto const span = ast.span(node);
+    auto const& literals = ast.interner().literals();
+    switch (kind) {
+        case NodeKind::IntegerConstant:
+        case NodeKind::RealConstant:
+            if (auto const sign = ast.sign(node); not sign.empty()) {
+                context.print(span, name, sign);
+            } else {
+                context.print(span, name);
+            }
+            break;
+        case NodeKind::ConstantReference:
+            if (auto const sign = ast.sign(node); not sign.empty()) {
+                context.print(span, name, sign, ast.referenced_constant(node));
+            } else {
+                context.print(span, name, ast.referenced_constant(node));
+            }
+            break;
+        case NodeKind::StructuredTypeDefinition:
+            if (auto const packed = ast.packed(node); not packed.empty()) {
+                context.print(span, name, packed);
+            } else {
+                context.print(span, name);
+            }
+            break;
+        case NodeKind::Identifier:
+            context.print(span, name, ast.text(node));
+            break;
+        // After an error, literals may be out of range or missing. Like `Ast`, they are printed as zero.
+        case NodeKind::IntegerLiteral: {
+            auto const literal = ast.literal(node);
+            context.print(span, name, literal == Literal::None ? i64{ 0 } : literals.integer(literal));
+            break;
+        }
+        case NodeKind::RealLiteral: {
+            auto const literal = ast.literal(node);
+            context.print(span, name, literal == Literal::None ? 0.0 : literals.real(literal));
+            break;
+        }
+        case NodeKind::CharLiteral:
+            context.print(span, name, literals.string(ast.literal(node)).front());
+            break;
+        case NodeKind::StringLiteral:
+            context.print(span, name, literals.string(ast.literal(node)));
+            break;
+        default:
+            context.print(span, name);
+            break;
+    }
+    auto const first_child = children.size();
+    std::ranges::copy(ast.reverse_children(node), std::back_inserter(children));
+    std::ranges::reverse(children.begin() + static_cast<std::ptrdiff_t>(first_child), children.end());
+    context.print_children(children.size() - first_child, [&](usize const i) {
+        print_node(ast, context, children[first_child + i], children);
+    });
+    children.resize(first_child);
+}
+
+usize FlatAst::dump(DumpSink& sink, DumpFormat const format) const {
+    auto dumper = AstDumper{ sink, format, *m_file };
+    auto context = AstNode::PrintContext{ dumper };
+    auto children = std::vector<NodeIndex>{};
+    print_node(*this, context, root(), children);
+    dumper.end_node();
+    dumper.finish();
+    return dumper.num_nodes();
+}
+
+void FlatAst::print() const {
+    auto sink = FileSink{ stdout };
+    dump(sink, DumpFormat::Tree);
+}
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>
+#include <lexer/literal_pool.hpp>
+#include <lexer/token.hpp>
+#include <lib2k/types.hpp>
+#include <limits>
+#include <memory>
+#include <parser/flat_ast.hpp>
+#include <tl/optional.hpp>
+#include <vector>
+
+// Creates the nodes of a `FlatAst` for the `Parser`. Nodes are appended as soon as they are complete, which is after
+// their children, so they end up in post-order. The parser creates the children of a node in source order, and every
+// node it creates becomes a child of the next node that is completed. So the subtree of a new node consists of all
+// nodes since the start of the subtree of its first child.
+class FlatAstBuilder final {
+public:
+    // The elements of a list are the subtrees since the start of the subtree of its first element.
+    struct PendingList final {
+        u32 begin;
+        NodeIndex first;
+    };
+
+private:
+    std::vector<NodeKind> m_kinds;
+    std::vector<SourceSpan> m_spans;
+    std::vector<u32> m_data;
+
+public:
+    using Result = FlatAst;
+
+    template<typename>
+    using Node = NodeIndex;
+
+    template<typename>
+    using List = PendingList;
+
+    [[nodiscard]] FlatAst finish(
+        std::shared_ptr<SourceFile const> file,
+        std::shared_ptr<Interner const> interner,
+        [[maybe_unused]] NodeIndex const block
+    ) {
+        assert(block == last_node());
+        // Nodes are never added afterwards.
+        m_kinds.shrink_to_fit();
+        m_spans.shrink_to_fit();
+        m_data.shrink_to_fit();
+        return FlatAst{
+            std::move(file),
+            std::move(interner),
+            std::move(m_kinds),
+            std::move(m_spans),
+            std::move(m_data),
+        };
+    }
+
+    [[nodiscard]] PendingList list(NodeIndex const first) const {
+        return PendingList{ subtree_begin(first), first };
+    }
+
+    void append([[maybe_unused]] PendingList const& list, [[maybe_unused]] NodeIndex const element) const {
+        assert(list.begin <= subtree_begin(element) and element == last_node());
+    }
+
+    [[nodiscard]] NodeIndex block(
+        tl::optional<NodeIndex> const label_declarations,
+        tl::optional<NodeIndex> const constant_definitions,
+        tl::optional<NodeIndex> const type_definitions,
+        tl::optional<NodeIndex> const variable_declarations
+    ) {
+        // An empty block does not have a source location. It gets an empty span at the start of the file instead.
+        auto span = tl::optional<SourceSpan>{};
+        for (auto const child : { label_declarations, constant_definitions, type_definitions, variable_declarations }) {
+            span = join(span, child);
+        }
+        return parent(
+            NodeKind::Block,
+            span.value_or(SourceSpan{ 0, 0 }),
+            label_declarations,
+            constant_definitions,
+            type_definitions,
+            variable_declarations
+        );
+    }
+
+    [[nodiscard]] NodeIndex label_declarations(Token const& label_token, PendingList&& labels) {
+        return parent(NodeKind::LabelDeclarations, SourceSpan::of(label_token).join(last_span(labels)), labels);
+    }
+
+    [[nodiscard]] NodeIndex label_declaration(NodeIndex const integer_literal) {
+        return parent(NodeKind::LabelDeclaration, span(integer_literal), integer_literal);
+    }
+
+    [[nodiscard]] NodeIndex constant_definitions(Token const& const_token, PendingList&& definitions) {
+        auto const span = SourceSpan::of(const_token).join(last_span(definitions));
+        return parent(NodeKind::ConstantDefinitions, span, definitions);
+    }
+
+    [[nodiscard]] NodeIndex constant_definition(NodeIndex const identifier, NodeIndex const constant) {
+        return parent(NodeKind::ConstantDefinition, span(identifier).join(span(constant)), identifier, constant);
+    }
+
+    [[nodiscard]] NodeIndex integer_constant(tl::optional<Token> const& sign, NodeIndex const value) {
+        return parent(NodeKind::IntegerConstant, with_prefix(sign, span(value)), value);
+    }
+
+    [[nodiscard]] NodeIndex real_constant(tl::optional<Token> const& sign, NodeIndex const value) {
+        return parent(NodeKind::RealConstant, with_prefix(sign, span(value)), value);
+    }
+
+    [[nodiscard]] NodeIndex char_constant(Token const& token, LiteralPool const&) {
+        auto const literal = add(NodeKind::CharLiteral, SourceSpan::of(token), literal_data(token));
+        return parent(NodeKind::CharConstant, span(literal), literal);
+    }
+
+    [[nodiscard]] NodeIndex string_constant(Token const& token, LiteralPool const&) {
+        auto const literal = add(NodeKind::StringLiteral, SourceSpan::of(token), literal_data(token));
+        return parent(NodeKind::StringConstant, span(literal), literal);
+    }
+
+    [[nodiscard]] NodeIndex constant_reference(tl::optional<Token> const& sign, Token const& identifier) {
+        auto const symbol = static_cast<u32>(identifier.symbol());
+        return add(NodeKind::ConstantReference, with_prefix(sign, SourceSpan::of(identifier)), symbol);
+    }
+
+    // The constant that could not be parsed is discarded.
+    [[nodiscard]] NodeIndex error_constant(NodeIndex const constant, SourceFile const&, SourceSpan const span) {
+        discard(constant);
+        return add(NodeKind::ErrorConstant, span, 0);
+    }
+
+    [[nodiscard]] NodeIndex type_definitions(Token const& type_token, PendingList&& definitions) {
+        auto const span = SourceSpan::of(type_token).join(last_span(definitions));
+        return parent(NodeKind::TypeDefinitions, span, definitions);
+    }
+
+    [[nodiscard]] NodeIndex type_definition(NodeIndex const identifier, NodeIndex const type) {
+        return parent(NodeKind::TypeDefinition, span(identifier).join(span(type)), identifier, type);
+    }
+
+    // The type that could not be parsed is discarded.
+    [[nodiscard]] NodeIndex error_type(NodeIndex const type, SourceFile const&, SourceSpan const span) {
+        discard(type);
+        return add(NodeKind::ErrorType, span, 0);
+    }
+
+    [[nodiscard]] NodeIndex real_type(Token const& token) {
+        return add(NodeKind::RealType, SourceSpan::of(token), 0);
+    }
+
+    [[nodiscard]] NodeIndex boolean_type(Token const& token) {
+        return add(NodeKind::BooleanType, SourceSpan::of(token), 0);
+    }
+
+    [[nodiscard]] NodeIndex char_type(Token const& token) {
+        return add(NodeKind::CharType, SourceSpan::of(token), 0);
+    }
+
+    [[nodiscard]] NodeIndex integer_type(Token const& token) {
+        return add(NodeKind::IntegerType, SourceSpan::of(token), 0);
+    }
+
+    [[nodiscard]] NodeIndex type_alias_definition(NodeIndex const referenced_type) {
+        return parent(NodeKind::TypeAliasDefinition, span(referenced_type), referenced_type);
+    }
+
+    [[nodiscard]] NodeIndex enumerated_type_definition(
+        Token const& left_parenthesis,
+        NodeIndex const identifiers,
+        Token const& right_parenthesis
+    ) {
+        auto const span = SourceSpan::of(left_parenthesis).join(SourceSpan::of(right_parenthesis));
+        return parent(NodeKind::EnumeratedTypeDefinition, span, identifiers);
+    }
+
+    [[nodiscard]] NodeIndex subrange_type_definition(NodeIndex const from, NodeIndex const to) {
+        return parent(NodeKind::SubrangeTypeDefinition, span(from).join(span(to)), from, to);
+    }
+
+    [[nodiscard]] NodeIndex structured_type_definition(tl::optional<Token> const& packed, NodeIndex const unpacked) {
+        return parent(NodeKind::StructuredTypeDefinition, with_prefix(packed, span(unpacked)), unpacked);
+    }
+
+    [[nodiscard]] NodeIndex array_type_definition(
+        Token const& array_token,
+        PendingList&& index_types,
+        NodeIndex const component_type
+    ) {
+        auto const span = SourceSpan::of(array_token).join(this->span(component_type));
+        return parent(NodeKind::ArrayTypeDefinition, span, index_types, component_type);
+    }
+
+    [[nodiscard]] NodeIndex record_type_definition(
+        Token const& record_token,
+        tl::optional<NodeIndex> const field_list,
+        Token const& end_token
+    ) {
+        auto const span = SourceSpan::of(record_token).join(SourceSpan::of(end_token));
+        return parent(NodeKind::RecordTypeDefinition, span, field_list);
+    }
+
+    [[nodiscard]] NodeIndex set_type_definition(Token const& set_token, NodeIndex const base_type) {
+        return parent(NodeKind::SetTypeDefinition, SourceSpan::of(set_token).join(span(base_type)), base_type);
+    }
+
+    [[nodiscard]] NodeIndex file_type_definition(Token const& file_token, NodeIndex const component_type) {
+        auto const span = SourceSpan::of(file_token).join(this->span(component_type));
+        return parent(NodeKind::FileTypeDefinition, span, component_type);
+    }
+
+    // `referenced_type` is an identifier or a built-in type.
+    [[nodiscard]] NodeIndex pointer_type_definition(Token const& up_arrow_token, Token const& referenced_type) {
+        auto const referenced = [&] {
+            switch (referenced_type.type()) {
+                case TokenType::Integer:
+                    return integer_type(referenced_type);
+                case TokenType::Real:
+                    return real_type(referenced_type);
+                case TokenType::Char:
+                    return char_type(referenced_type);
+                case TokenType::Boolean:
+                    return boolean_type(referenced_type);
+                default:
+                    return identifier(referenced_type);
+            }
+        }();
+        auto const span = SourceSpan::of(up_arrow_token).join(this->span(referenced));
+        return parent(NodeKind::PointerTypeDefinition, span, referenced);
+    }
+
+    [[nodiscard]] NodeIndex field_list(
+        tl::optional<NodeIndex> const fixed_part,
+        tl::optional<NodeIndex> const variant_part
+    ) {
+        // Only empty after an error, when the tree is discarded anyway.
+        auto const span = join(join(tl::nullopt, fixed_part), variant_part).value_or(SourceSpan{ 0, 0 });
+        return parent(NodeKind::FieldList, span, fixed_part, variant_part);
+    }
+
+    [[nodiscard]] NodeIndex fixed_part(PendingList&& record_sections) {
+        return parent(NodeKind::FixedPart, list_span(record_sections), record_sections);
+    }
+
+    [[nodiscard]] NodeIndex record_section(NodeIndex const identifiers, NodeIndex const type) {
+        return parent(NodeKind::RecordSection, span(identifiers).join(span(type)), identifiers, type);
+    }
+
+    [[nodiscard]] NodeIndex variant_part(
+        Token const& case_token,
+        NodeIndex const variant_selector,
+        NodeIndex const variant_list
+    ) {
+        auto const span = SourceSpan::of(case_token).join(this->span(variant_list));
+        return parent(NodeKind::VariantPart, span, variant_selector, variant_list);
+    }
+
+    [[nodiscard]] NodeIndex variant_selector(tl::optional<NodeIndex> const tag_field, NodeIndex const tag_type) {
+        auto const span = *join(this->span(tag_type), tag_field);
+        return parent(NodeKind::VariantSelector, span, tag_field, tag_type);
+    }
+
+    [[nodiscard]] NodeIndex variant_list(PendingList&& variants) {
+        return parent(NodeKind::VariantList, list_span(variants), variants);
+    }
+
+    [[nodiscard]] NodeIndex variant(
+        NodeIndex const case_constant_list,
+        tl::optional<NodeIndex> const field_list,
+        Token const& closing_parenthesis
+    ) {
+        auto const span = this->span(case_constant_list).join(SourceSpan::of(closing_parenthesis));
+        return parent(NodeKind::Variant, span, case_constant_list, field_list);
+    }
+
+    [[nodiscard]] NodeIndex case_constant_list(PendingList&& constants) {
+        return parent(NodeKind::CaseConstantList, list_span(constants), constants);
+    }
+
+    [[nodiscard]] NodeIndex variable_declarations(Token const& var_token, PendingList&& declarations) {
+        auto const span = SourceSpan::of(var_token).join(last_span(declarations));
+        return parent(NodeKind::VariableDeclarations, span, declarations);
+    }
+
+    [[nodiscard]] NodeIndex variable_declaration(NodeIndex const identifiers, NodeIndex const type) {
+        return parent(NodeKind::VariableDeclaration, span(identifiers).join(span(type)), identifiers, type);
+    }
+
+    [[nodiscard]] NodeIndex identifier_list(PendingList&& identifiers) {
+        return parent(NodeKind::IdentifierList, list_span(identifiers), identifiers);
+    }
+
+    [[nodiscard]] NodeIndex identifier(Token const& token) {
+        return add(NodeKind::Identifier, SourceSpan::of(token), static_cast<u32>(token.symbol()));
+    }
+
+    [[nodiscard]] NodeIndex integer_literal(Token const& token, i64) {
+        return add(NodeKind::IntegerLiteral, SourceSpan::of(token), literal_data(token));
+    }
+
+    [[nodiscard]] NodeIndex real_literal(Token const& token, double) {
+        return add(NodeKind::RealLiteral, SourceSpan::of(token), literal_data(token));
+    }
+
+private:
+    [[nodiscard]] SourceSpan span(NodeIndex const node) const {
+        return m_spans[static_cast<usize>(node)];
+    }
+
+    [[nodiscard]] NodeIndex last_node() const {
+        return NodeIndex{ static_cast<u32>(m_kinds.size() - 1) };
+    }
+
+    [[nodiscard]] u32 subtree_begin(NodeIndex const node) const {
+        auto const index = static_cast<u32>(node);
+        return is_leaf(m_kinds[index]) ? index : index + 1 - m_data[index];
+    }
+
+    // Lists are completed by the parser when their last element has been parsed.
+    [[nodiscard]] SourceSpan last_span([[maybe_unused]] PendingList const& list) const {
+        assert(list.begin <= static_cast<u32>(last_node()));
+        return span(last_node());
+    }
+
+    [[nodiscard]] SourceSpan list_span(PendingList const& list) const {
+        return span(list.first).join(last_span(list));
+    }
+
+    [[nodiscard]] tl::optional<SourceSpan> join(
+        tl::optional<SourceSpan> const& span,
+        tl::optional<NodeIndex> const node
+    ) const {
+        if (not node.has_value()) {
+            return span;
+        }
+        if (not span.has_value()) {
+            return this->span(*node);
+        }
+        return span->join(this->span(*node));
+    }
+
+    // Signs and `packed` are not stored. They can be recovered from the span of the node.
+    [[nodiscard]] static SourceSpan with_prefix(tl::optional<Token> const& prefix, SourceSpan const span) {
+        if (prefix.has_value()) {
+            return SourceSpan::of(*prefix).join(span);
+        }
+        return span;
+    }
+
+    [[nodiscard]] static u32 literal_data(Token const& token) {
+        return static_cast<u32>(token.literal());
+    }
+
+    [[nodiscard]] NodeIndex add(NodeKind const kind, SourceSpan const span, u32 const data) {
+        auto const result = NodeIndex{ static_cast<u32>(m_kinds.size()) };
+        m_kinds.push_back(kind);
+        m_spans.push_back(span);
+        m_data.push_back(data);
+        return result;
+    }
+
+    // Removes the subtree of `node`, which must be the last one.
+    void discard(NodeIndex const node) {
+        assert(node == last_node());
+        auto const begin = subtree_begin(node);
+        m_kinds.resize(begin);
+        m_spans.resize(begin);
+        m_data.resize(begin);
+    }
+
+    // Where the subtree of a child starts. Missing optional children are ignored.
+    [[nodiscard]] u32 child_begin(NodeIndex const child) const {
+        return subtree_begin(child);
+    }
+
+    [[nodiscard]] u32 child_begin(tl::optional<NodeIndex> const child) const {
+        return child.has_value() ? subtree_begin(*child) : std::numeric_limits<u32>::max();
+    }
+
+    [[nodiscard]] u32 child_begin(PendingList const& list) const {
+        return list.begin;
+    }
+
+    template<typename... Children>
+    [[nodiscard]] NodeIndex parent(NodeKind const kind, SourceSpan const span, Children const&... children) {
+        auto const index = static_cast<u32>(m_kinds.size());
+        auto const begin = std::min({ index, child_begin(children)... });
+        return add(kind, span, index + 1 - begin);
+    }
+};
@@ -0,0 +1,341 @@
+#include <array>
+#include <bit>
+#include <common/common.hpp>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <parser/flat_ast.hpp>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    // The sections of a file, in the order in which they are stored.
+    enum class SectionKind : u8 {
+        Path,
+        Source,
+        Kinds,
+        Spans,
+        Data,
+        Symbols,
+        Spellings,
+        Literals,
+        Strings,
+    };
+
+    constexpr auto num_sections = usize{ 9 };
+    constexpr auto section_alignment = usize{ 8 };
+    constexpr auto magic = std::array{ 'P', '2', 'K', 'A' };
+
+    struct Section final {
+        u64 offset;
+        u64 size;
+    };
+
+    struct FileHeader final {
+        std::array<char, 4> magic;
+        u32 version;
+        u32 num_nodes;
+        u32 num_symbols;
+        u32 num_literals;
+        u32 padding;
+        std::array<Section, num_sections> sections;
+
+        [[nodiscard]] Section section(SectionKind const kind) const {
+            return sections[static_cast<usize>(kind)];
+        }
+    };
+
+    struct SymbolRecord final {
+        u32 offset;  // Into the spellings.
+        u32 length;
+    };
+
+    struct LiteralRecord final {
+        u32 kind;
+        u32 length;  // Only used for strings.
+        u64 value;
+    };
+
+    // The arrays of the tree are used in place, so their layout is part of the format.
+    static_assert(sizeof(FileHeader) == 168);
+    static_assert(sizeof(NodeKind) == 1 and sizeof(SourceSpan) == 8 and sizeof(SymbolRecord) == 8);
+    static_assert(sizeof(LiteralRecord) == 16);
+}  // namespace
+
+[[nodiscard]] static std::runtime_error invalid_file(std::string_view const reason) {
+    return std::runtime_error{ std::format("Invalid AST file: {}", reason) };
+}
+
+// The format is little endian, and the arrays are used in place without converting them.
+static void check_byte_order() {
+    if constexpr (std::endian::native != std::endian::little) {
+        throw_or_abort(std::runtime_error{ "AST files are only supported on little-endian machines." });
+    }
+}
+
+template<typename T>
+[[nodiscard]] static std::string_view bytes_of(std::span<T const> const values) {
+    return std::string_view{ reinterpret_cast<char const*>(values.data()), values.size_bytes() };
+}
+
+template<typename T>
+[[nodiscard]] static std::string_view bytes_of(T const& value) {
+    return bytes_of(std::span{ &value, 1 });
+}
+
+[[nodiscard]] static u64 align(u64 const offset) {
+    return (offset + section_alignment - 1) / section_alignment * section_alignment;
+}
+
+void FlatAst::save(DumpSink& sink) const {
+    check_byte_order();
+
+    auto symbols = std::vector<SymbolRecord>{};
+    auto spellings = std::string{};
+    symbols.reserve(m_interner->size());
+    for (auto i = usize{ 0 }; i < m_interner->size(); ++i) {
+        auto const spelling = m_interner->spelling(Symbol{ static_cast<u32>(i) });
+        symbols.push_back(SymbolRecord{ static_cast<u32>(spellings.size()), static_cast<u32>(spelling.size()) });
+        spellings += spelling;
+    }
+
+    auto const& pool = m_interner->literals();
+    auto literals = std::vector<LiteralRecord>{};
+    auto strings = std::string{};
+    literals.reserve(pool.size());
+    for (auto i = usize{ 0 }; i < pool.size(); ++i) {
+        auto const literal = Literal{ static_cast<u32>(i) };
+        auto const kind = pool.kind(literal);
+        auto record = LiteralRecord{ static_cast<u32>(kind), 0, 0 };
+        switch (kind) {
+            case LiteralKind::Integer:
+                record.value = std::bit_cast<u64>(pool.integer(literal));
+                break;
+            case LiteralKind::Real:
+                record.value = std::bit_cast<u64>(pool.real(literal));
+                break;
+            case LiteralKind::String:
+                record.length = static_cast<u32>(pool.string(literal).size());
+                record.value = strings.size();
+                strings += pool.string(literal);
+                break;
+        }
+        literals.push_back(record);
+    }
+
+    auto const contents = std::array<std::string_view, num_sections>{
+        m_file->path(),
+        m_file->source(),
+        bytes_of(m_kinds),
+        bytes_of(m_spans),
+        bytes_of(m_data),
+        bytes_of(std::span<SymbolRecord const>{ symbols }),
+        spellings,
+        bytes_of(std::span<LiteralRecord const>{ literals }),
+        strings,
+    };
+
+    auto header = FileHeader{
+        magic,
+        file_version,
+        static_cast<u32>(size()),
+        static_cast<u32>(symbols.size()),
+        static_cast<u32>(literals.size()),
+        0,
+        {},
+    };
+    auto offset = u64{ sizeof(FileHeader) };
+    for (auto i = usize{ 0 }; i < num_sections; ++i) {
+        header.sections[i] = Section{ offset, contents[i].size() };
+        offset = align(offset + contents[i].size());
+    }
+
+    static constexpr auto padding = std::array<char, section_alignment>{};
+    sink.write(bytes_of(header));
+    for (auto i = usize{ 0 }; i < num_sections; ++i) {
+        sink.write(contents[i]);
+        auto const end = header.sections[i].offset + header.sections[i].size;
+        sink.write(std::string_view{ padding.data(), align(end) - end });
+    }
+}
+
+// Whether the node refers to its only child, which directly precedes it, to find its sign or the keyword `packed`.
+[[nodiscard]] static bool requires_only_child(NodeKind const kind) {
+    return kind == NodeKind::IntegerConstant or kind == NodeKind::RealConstant
+           or kind == NodeKind::StructuredTypeDefinition;
+}
+
+// Checks everything that the accessors of `FlatAst` rely on, so that a corrupted file cannot make them read out of
+// bounds: The kinds are known, the subtrees are nested, the spans lie within the source, and leaves refer to existing
+// symbols and to literals of the right kind. This takes one pass over the arrays, but does not read the source.
+static void validate_nodes(
+    std::span<NodeKind const> const kinds,
+    std::span<SourceSpan const> const spans,
+    std::span<u32 const> const data,
+    usize const source_size,
+    Interner const& interner
+) {
+    auto const& literals = interner.literals();
+    auto const is_literal = [&](u32 const payload, LiteralKind const kind) {
+        return payload < literals.size() and literals.kind(Literal{ payload }) == kind;
+    };
+    // The first nodes of the subtrees that do not have a parent yet. Together, they cover all nodes so far.
+    auto subtrees = std::vector<u32>{};
+    for (auto i = u32{ 0 }; i < kinds.size(); ++i) {
+        auto const kind = kinds[i];
+        if (static_cast<u8>(kind) > static_cast<u8>(NodeKind::IntegerType)) {
+            throw_or_abort(invalid_file("A node has an unknown kind."));
+        }
+        if (u64{ spans[i].offset } + spans[i].length > source_size) {
+            throw_or_abort(invalid_file("A node lies outside of the source."));
+        }
+
+        auto const payload = data[i];
+        auto is_valid_payload = true;
+        switch (kind) {
+            case NodeKind::Identifier:
+            case NodeKind::ConstantReference:
+                is_valid_payload = payload < interner.size() or Symbol{ payload } == Symbol::None;
+                break;
+            case NodeKind::IntegerLiteral:
+                is_valid_payload = Literal{ payload } == Literal::None or is_literal(payload, LiteralKind::Integer);
+                break;
+            case NodeKind::RealLiteral:
+                is_valid_payload = Literal{ payload } == Literal::None or is_literal(payload, LiteralKind::Real);
+                break;
+            case NodeKind::CharLiteral:
+                is_valid_payload =
+                    is_literal(payload, LiteralKind::String) and literals.string(Literal{ payload }).size() == 1;
+                break;
+            case NodeKind::StringLiteral:
+                is_valid_payload = is_literal(payload, LiteralKind::String);
+                break;
+            default:
+                break;
+        }
+        if (not is_valid_payload) {
+            throw_or_abort(invalid_file("A node refers to a symbol or literal that does not exist."));
+        }
+
+        // The children of a node are the subtrees that directly precede it, and they have to fill its subtree.
+        auto const size = is_leaf(kind) ? u32{ 1 } : payload;
+        if (size == 0 or size > i + 1) {
+            throw_or_abort(invalid_file("A subtree is out of bounds."));
+        }
+        auto const start = i + 1 - size;
+        auto children_start = i;
+        while (not subtrees.empty() and subtrees.back() >= start) {
+            children_start = subtrees.back();
+            subtrees.pop_back();
+        }
+        if (children_start != start) {
+            throw_or_abort(invalid_file("A subtree overlaps with another one."));
+        }
+        if (size == 1 and requires_only_child(kind)) {
+            throw_or_abort(invalid_file("A node is missing its child."));
+        }
+        subtrees.push_back(start);
+    }
+    if (subtrees.size() != 1) {
+        throw_or_abort(invalid_file("The root does not span the whole tree."));
+    }
+}
+
+FlatAst FlatAst::load(std::filesystem::path const& path) {
+    return load(SourceBuffer::from_file(path));
+}
+
+FlatAst FlatAst::load(SourceBuffer buffer) {
+    check_byte_order();
+
+    // The buffer must not move anymore, since the arrays point into it.
+    auto const storage = std::make_shared<SourceBuffer const>(std::move(buffer));
+    auto const contents = storage->contents();
+    if (contents.size() < sizeof(FileHeader)) {
+        throw_or_abort(invalid_file("The file is too small."));
+    }
+    if (reinterpret_cast<std::uintptr_t>(contents.data()) % section_alignment != 0) {
+        throw_or_abort(invalid_file("The contents are not aligned."));
+    }
+    auto header = FileHeader{};
+    std::memcpy(&header, contents.data(), sizeof(FileHeader));
+    if (header.magic != magic) {
+        throw_or_abort(invalid_file("The file does not contain an AST."));
+    }
+    if (header.version != file_version) {
+        throw_or_abort(invalid_file(std::format("Expected version {}, got {}.", file_version, header.version)));
+    }
+
+    auto const section = [&](SectionKind const kind, usize const element_size, usize const num_elements) {
+        auto const [offset, size] = header.section(kind);
+        if (offset % section_alignment != 0 or offset > contents.size() or size > contents.size() - offset) {
+            throw_or_abort(invalid_file("A section is out of bounds."));
+        }
+        if (element_size != 0 and size != element_size * num_elements) {
+            throw_or_abort(invalid_file("A section does not match the number of its elements."));
+        }
+        return contents.substr(offset, size);
+    };
+    auto const num_nodes = usize{ header.num_nodes };
+    auto const path = section(SectionKind::Path, 0, 0);
+    auto const source = section(SectionKind::Source, 0, 0);
+    auto const kinds = section(SectionKind::Kinds, sizeof(NodeKind), num_nodes);
+    auto const spans = section(SectionKind::Spans, sizeof(SourceSpan), num_nodes);
+    auto const data = section(SectionKind::Data, sizeof(u32), num_nodes);
+    auto const symbols = section(SectionKind::Symbols, sizeof(SymbolRecord), header.num_symbols);
+    auto const spellings = section(SectionKind::Spellings, 0, 0);
+    auto const literals = section(SectionKind::Literals, sizeof(LiteralRecord), header.num_literals);
+    auto const strings = section(SectionKind::Strings, 0, 0);
+    if (num_nodes == 0) {
+        throw_or_abort(invalid_file("The tree is empty."));
+    }
+
+    // The interner is rebuilt in the same order, so that the symbols and literals of the nodes stay valid.
+    auto const substring = [](std::string_view const text, u64 const offset, u64 const length) {
+        if (offset > text.size() or length > text.size() - offset) {
+            throw_or_abort(invalid_file("A symbol or literal is out of bounds."));
+        }
+        return text.substr(offset, length);
+    };
+    auto interner = std::make_shared<Interner>();
+    for (auto i = u32{ 0 }; i < header.num_symbols; ++i) {
+        auto record = SymbolRecord{};
+        std::memcpy(&record, symbols.data() + i * sizeof(SymbolRecord), sizeof(SymbolRecord));
+        if (interner->intern(substring(spellings, record.offset, record.length)) != Symbol{ i }) {
+            throw_or_abort(invalid_file("A symbol is stored more than once."));
+        }
+    }
+    auto& pool = interner->literals();
+    for (auto i = u32{ 0 }; i < header.num_literals; ++i) {
+        auto record = LiteralRecord{};
+        std::memcpy(&record, literals.data() + i * sizeof(LiteralRecord), sizeof(LiteralRecord));
+        auto literal = Literal::None;
+        switch (record.kind) {
+            case static_cast<u32>(LiteralKind::Integer):
+                literal = pool.intern_integer(std::bit_cast<i64>(record.value));
+                break;
+            case static_cast<u32>(LiteralKind::Real):
+                literal = pool.intern_real(std::bit_cast<double>(record.value));
+                break;
+            case static_cast<u32>(LiteralKind::String):
+                literal = pool.intern_string(substring(strings, record.value, record.length));
+                break;
+            default:
+                throw_or_abort(invalid_file("A literal has an unknown kind."));
+        }
+        if (literal != Literal{ i }) {
+            throw_or_abort(invalid_file("A literal is stored more than once."));
+        }
+    }
+
+    auto const node_kinds = std::span{ reinterpret_cast<NodeKind const*>(kinds.data()), num_nodes };
+    auto const node_spans = std::span{ reinterpret_cast<SourceSpan const*>(spans.data()), num_nodes };
+    auto const node_data = std::span{ reinterpret_cast<u32 const*>(data.data()), num_nodes };
+    validate_nodes(node_kinds, node_spans, node_data, source.size(), *interner);
+
+    auto file = std::make_shared<SourceFile const>(path, source, storage);
+    return FlatAst{ std::move(file), std::move(interner), storage, node_kinds, node_spans, node_data };
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cassert>
+#include <concepts>
+#include <lib2k/types.hpp>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+class Arena;
+
+// Refers to a node that lives in an `Arena`. The arena owns the node, so the pointer is never null and destroying it
+// does nothing.
+template<typename T>
+class ArenaPtr final {
+    template<typename>
+    friend class ArenaPtr;
+    friend class Arena;
+
+private:
+    T* m_pointer;
+
+    [[nodiscard]] explicit ArenaPtr(T* const pointer)
+        : m_pointer{ pointer } {
+        assert(pointer != nullptr);
+    }
+
+public:
+    // Converts to a pointer to a base class.
+    template<std::derived_from<T> U>
+    [[nodiscard]] ArenaPtr(ArenaPtr<U> const& other)
+        : m_pointer{ other.m_pointer } {}
+
+    [[nodiscard]] T& operator*() const {
+        return *m_pointer;
+    }
+
+    [[nodiscard]] T* operator->() const {
+        return m_pointer;
+    }
+
+    [[nodiscard]] T* get() const {
+        return m_pointer;
+    }
+};
+
+// Monotonic allocator for the nodes of an `Ast` and the containers within them. Memory is only released when the
+// arena is destroyed, and the destructors of the nodes are never run. Therefore, nodes must not own any memory that
+// has not been allocated from the arena, i.e., containers within nodes must be `std::pmr` containers that use the
+// arena.
+class Arena final : public std::pmr::memory_resource {
+private:
+    std::pmr::monotonic_buffer_resource m_resource;
+    usize m_bytes_allocated = 0;
+
+public:
+    static constexpr auto default_initial_size = usize{ 4096 };
+
+    // The blocks are requested with `new`, independently of the default memory resource.
+    [[nodiscard]] explicit Arena(usize const initial_size = default_initial_size)
+        : m_resource{ initial_size, std::pmr::new_delete_resource() } {}
+
+    // Containers refer to their arena, so it must not be moved.
+    Arena(Arena const& other) = delete;
+    Arena(Arena&& other) noexcept = delete;
+    Arena& operator=(Arena const& other) = delete;
+    Arena& operator=(Arena&& other) noexcept = delete;
+    ~Arena() override = default;
+
+    template<typename T, typename... Args>
+    [[nodiscard]] ArenaPtr<T> create(Args&&... args) {
+        auto const memory = allocate(sizeof(T), alignof(T));
+        return ArenaPtr<T>{ ::new (memory) T(std::forward<Args>(args)...) };
+    }
+
+    // The number of bytes handed out so far, without the unused parts of the blocks requested from the system.
+    [[nodiscard]] usize bytes_allocated() const {
+        return m_bytes_allocated;
+    }
+
+private:
+    [[nodiscard]] void* do_allocate(usize const bytes, usize const alignment) override {
+        m_bytes_allocated += bytes;
+        return m_resource.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, usize, usize) override {}
+
+    [[nodiscard]] bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+        return this == &other;
+    }
+};
@@ -1,26 +1,71 @@
 #pragma once
 
-#include <lexer/token.hpp>
+#include <cstdio>
+#include <lexer/interner.hpp>
+#include <lexer/source_file.hpp>
 #include <memory>
 #include <vector>
+#include "arena.hpp"
+#include "ast_dumper.hpp"
 #include "block.hpp"
-#include <print>
+#include "node_statistics.hpp"
 
+// Owns all nodes of the syntax tree. They are allocated from a single arena, so destroying the tree releases a few
+// large blocks of memory instead of freeing every node separately.
 class Ast final {
 private:
-    std::vector<Token> m_tokens;
-    Block m_block;
+    std::shared_ptr<SourceFile const> m_file;  // Keeps the tokens referenced by the nodes valid.
+    std::shared_ptr<Interner const> m_interner;
+    std::unique_ptr<Arena> m_arena;
+    ArenaPtr<Block> m_block;
 
 public:
-    [[nodiscard]] explicit Ast(std::vector<Token>&& tokens, Block block)
-        : m_tokens{ std::move(tokens) }, m_block{ std::move(block) } {}
+    // `block` and all nodes within it must have been allocated from `arena`.
+    [[nodiscard]] explicit Ast(
+        std::shared_ptr<SourceFile const> file,
+        std::shared_ptr<Interner const> interner,
+        std::unique_ptr<Arena> arena,
+        ArenaPtr<Block> const block
+    )
+        : m_file{ std::move(file) }, m_interner{ std::move(interner) }, m_arena{ std::move(arena) }, m_block{ block } {}
+
+    // The interner that the symbols of all identifiers in this AST belong to.
+    [[nodiscard]] Interner const& interner() const {
+        return *m_interner;
+    }
 
     [[nodiscard]] Block const& block() const {
-        return m_block;
+        return *m_block;
+    }
+
+    [[nodiscard]] Arena const& arena() const {
+        return *m_arena;
+    }
+
+    // Writes the tree to `sink`. Unlike `print()`, this works for all formats and any destination. Returns the number
+    // of nodes.
+    usize dump(DumpSink& sink, DumpFormat const format) const {
+        auto dumper = AstDumper{ sink, format, *m_file };
+        auto context = AstNode::PrintContext{ dumper };
+        m_block->print(context);
+        dumper.end_node();
+        dumper.finish();
+        return dumper.num_nodes();
+    }
+
+    // Counts the nodes by class, including the nodes that are stored within lists of their parents. The sizes are those
+    // of the node objects, so the arena holds more than their sum (see `Arena::bytes_allocated()`): the lists of
+    // tokens, and the buffers that lists have outgrown while they were built.
+    [[nodiscard]] NodeStatistics node_statistics() const {
+        auto statistics = NodeStatistics{};
+        auto context = AstNode::PrintContext{ statistics };
+        m_block->print(context);
+        return statistics;
     }
 
+    // Prints the tree to the standard output.
     void print() const {
-        auto context = AstNode::PrintContext{};
-        m_block.print(context);
+        auto sink = FileSink{ stdout };
+        dump(sink, DumpFormat::Tree);
     }
 };
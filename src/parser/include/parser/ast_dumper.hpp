@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdio>
+#include <lexer/source_file.hpp>
+#include <lib2k/types.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "source_span.hpp"
+
+enum class DumpFormat {
+    Tree,    // The indented tree that `Ast::print()` writes.
+    Json,    // One JSON object per node.
+    Binary,  // A compact encoding for tools, see `AstDumper`.
+};
+
+// Receives the output of an `AstDumper` in large chunks.
+class DumpSink {
+public:
+    DumpSink() = default;
+    DumpSink(DumpSink const& other) = default;
+    DumpSink(DumpSink&& other) noexcept = default;
+    DumpSink& operator=(DumpSink const& other) = default;
+    DumpSink& operator=(DumpSink&& other) noexcept = default;
+    virtual ~DumpSink() = default;
+
+    virtual void write(std::string_view data) = 0;
+};
+
+// Appends to a string, which grows as needed.
+class StringSink final : public DumpSink {
+private:
+    std::string* m_buffer;
+
+public:
+    [[nodiscard]] explicit StringSink(std::string& buffer)
+        : m_buffer{ &buffer } {}
+
+    void write(std::string_view const data) override {
+        m_buffer->append(data);
+    }
+};
+
+// Writes to a C stream, e.g., `stdout`. The stream is neither flushed nor closed.
+class FileSink final : public DumpSink {
+private:
+    std::FILE* m_file;
+
+public:
+    [[nodiscard]] explicit FileSink(std::FILE* const file)
+        : m_file{ file } {}
+
+    void write(std::string_view data) override;
+};
+
+// Writes to a file descriptor, bypassing any buffering of C streams. The descriptor is not closed.
+class FileDescriptorSink final : public DumpSink {
+private:
+    int m_file_descriptor;
+
+public:
+    [[nodiscard]] explicit FileDescriptorSink(int const file_descriptor)
+        : m_file_descriptor{ file_descriptor } {}
+
+    void write(std::string_view data) override;
+};
+
+// Writes the nodes of a syntax tree in one of the `DumpFormat`s. The output is collected in a buffer that is handed to
+// the sink in large chunks, so that dumping large trees is not dominated by many small writes.
+//
+// Every node is written by `begin_node()`, followed by its values, its children and `end_node()`. The children of a
+// node are enclosed by `begin_children()` and `end_children()`. `finish()` has to be called after the root node.
+//
+// The JSON format is `{"file":"<path>","root":<node>}`, where every node looks like this:
+//     {"kind":"Identifier","offset":4,"length":1,"begin":[1,5],"end":[1,6],"values":["x"],"children":[]}
+// Lines and columns start at 1. Integer and real values are numbers, all other values are strings.
+//
+// In the binary format, all numbers are unsigned LEB128 unless noted otherwise:
+//     dump   := "P2KD" version:u8 path:string node
+//     node   := kind offset length value* 0 node* 0
+//     kind   := index + 1 into the table of kinds; the first use of an index is followed by the name as a string
+//     value  := 'i' zigzag-encoded integer | 'r' IEEE 754 double as u64 little endian | 's' string
+//     string := length byte*
+class AstDumper final {
+public:
+    static constexpr auto binary_version = u8{ 1 };
+    static constexpr auto chunk_size = usize{ 64 * 1024 };
+
+private:
+    // The children of a node that are being written.
+    struct Level final {
+        usize num_children;
+        usize current_child = 0;
+    };
+
+    DumpSink* m_sink;
+    DumpFormat m_format;
+    SourceFile const* m_file;
+    std::string m_buffer;
+    std::vector<Level> m_levels;
+    bool m_writing_values = false;
+    usize m_num_values = 0;
+    usize m_num_nodes = 0;
+    usize m_line = 0;  // The previous location, which speeds up the lookup of nearby offsets.
+    usize m_column = 0;
+    usize m_column_offset = 0;
+    std::unordered_map<std::string_view, usize> m_kinds;  // Only for the binary format.
+
+public:
+    [[nodiscard]] explicit AstDumper(DumpSink& sink, DumpFormat format, SourceFile const& file);
+
+    AstDumper(AstDumper const& other) = delete;
+    AstDumper(AstDumper&& other) noexcept = default;
+    AstDumper& operator=(AstDumper const& other) = delete;
+    AstDumper& operator=(AstDumper&& other) noexcept = default;
+    ~AstDumper() = default;
+
+    // `kind` must outlive the dumper.
+    void begin_node(SourceSpan span, std::string_view kind);
+    void end_node();
+    void begin_children(usize num_children);
+    void end_children();
+
+    void value(i64 value);
+    void value(double value);
+    void value(char value);
+    void value(std::string_view value);
+
+    // Writes everything that is still buffered to the sink.
+    void finish();
+
+    // The number of nodes that have been begun so far.
+    [[nodiscard]] usize num_nodes() const {
+        return m_num_nodes;
+    }
+
+private:
+    void end_values();
+    void flush_if_full();
+    void write_location(usize offset);
+    void write_json_string(std::string_view string);
+    void write_number(u64 number);
+    void write_signed_number(i64 number);
+    void write_varint(u64 number);
+    void write_binary_string(std::string_view string);
+};
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <array>
 #include <lexer/source_location.hpp>
+#include <lexer/token.hpp>
 #include <lib2k/types.hpp>
-#include <print>
-#include <vector>
+#include <memory_resource>
 #include <tl/optional.hpp>
+#include <vector>
+#include "ast_dumper.hpp"
+#include "node_statistics.hpp"
+#include "source_span.hpp"
 
 class AstNode;
 
@@ -12,147 +17,161 @@ template<typename T>
 concept MaybeAstNode = std::derived_from<T, AstNode> or IsOptional<T, AstNode const&>;
 
 class AstNode {
+private:
+    SourceFile const* m_file = nullptr;  // Only null for nodes without any tokens, see `source_location()`.
+    SourceSpan m_span{ 0, 0 };
+
+protected:
+    // Spans the given tokens and nodes, which may be optional. The span is computed once, so that querying the source
+    // location of a node does not have to visit its subtree.
+    template<typename... Parts>
+    [[nodiscard]] explicit AstNode(Parts const&... parts) {
+        (include(parts), ...);
+    }
+
+    // For nodes that do not correspond to any tokens, e.g., the error nodes that replace constructs that could not be
+    // parsed.
+    [[nodiscard]] AstNode(SourceFile const& file, SourceSpan const span)
+        : m_file{ &file }, m_span{ span } {}
+
 public:
-    AstNode() = default;
     AstNode(AstNode const& other) = default;
     AstNode(AstNode&& other) noexcept = default;
     AstNode& operator=(AstNode const& other) = default;
     AstNode& operator=(AstNode&& other) noexcept = default;
     virtual ~AstNode() = default;
 
-    [[nodiscard]] virtual SourceLocation source_location() const = 0;
+    // Empty blocks and, after a parser error, empty field lists have no source location.
+    [[nodiscard]] SourceLocation source_location() const {
+        if (m_file == nullptr) {
+            throw_or_abort(InternalCompilerError{ "Node has no source location." });
+        }
+        return m_span.source_location(*m_file);
+    }
 
+    [[nodiscard]] SourceSpan span() const {
+        return m_span;
+    }
+
+    // Hands the nodes to an `AstDumper`, or counts them. Every node prints itself and then its children.
     struct PrintContext {
     private:
-        std::vector<bool> indents;
-        bool just_indented = false;
-        bool is_last_child = false;
+        AstDumper* m_dumper;  // Null if the nodes are counted.
+        NodeStatistics* m_statistics;  // Null if the nodes are printed.
 
     public:
-        template<typename... Ts>
-        void print(AstNode const& node, std::string_view const name, Ts const&... args) {
-            print_indentation();
-            std::print("{} [{}, {}]", name, node.source_location(), node.source_location().end());
-            if constexpr (sizeof...(args) > 0) {
-                (std::print(" '{}'", args), ...);
+        [[nodiscard]] explicit PrintContext(AstDumper& dumper)
+            : m_dumper{ &dumper }, m_statistics{ nullptr } {}
+
+        // Counts the nodes by name, and adds the size of their classes, which is known because nodes pass themselves
+        // with their most derived type.
+        [[nodiscard]] explicit PrintContext(NodeStatistics& statistics)
+            : m_dumper{ nullptr }, m_statistics{ &statistics } {}
+
+        template<std::derived_from<AstNode> Node, typename... Ts>
+        void print(Node const& node, std::string_view const name, Ts const&... args) {
+            if (m_statistics != nullptr) {
+                m_statistics->add(name, sizeof(Node));
+                return;
+            }
+            if (node.m_file == nullptr) {
+                throw_or_abort(InternalCompilerError{ "Node has no source location." });
             }
-            std::print("\n");
+            print(node.m_span, name, args...);
+        }
+
+        template<typename... Ts>
+        void print(SourceSpan const span, std::string_view const name, Ts const&... args) {
+            m_dumper->begin_node(span, name);
+            (m_dumper->value(args), ...);
         }
 
         void print_children(MaybeAstNode auto const&... children) {
-            auto vector = std::vector<AstNode const*>{};
+            auto nodes = std::array<AstNode const*, sizeof...(children)>{};
+            auto num_nodes = usize{ 0 };
 
             // clang-format off
             ([&] {
                 if constexpr (IsOptional<decltype(children), AstNode const&>) {
                     if (children.has_value()) {
-                        vector.push_back(static_cast<AstNode const*>(&children.value()));
+                        nodes[num_nodes++] = &*children;
                     }
                 } else {
-                    vector.push_back(&children);
+                    nodes[num_nodes++] = &children;
                 }
             }(), ...);
             // clang-format on
-            print_children(vector);
+            print_children(num_nodes, [&](usize const i) { nodes[i]->print(*this); });
         }
 
         template<std::derived_from<AstNode> T>
-        void print_children(std::vector<T> const& children) {
-            using std::views::transform, std::views::filter, std::ranges::to;
-            // clang-format off
-            print_children(
-                children
-                    | transform([](auto const& child) { return static_cast<AstNode const*>(&child); })
-                    | to<std::vector>()
-            );
-            // clang-format on
+        void print_children(std::pmr::vector<T> const& children) {
+            print_children(children.size(), [&](usize const i) { children[i].print(*this); });
         }
 
-        void print_children(std::vector<AstNode const*> const children) {
-            if (children.empty()) {
+        // Calls `print_child` with the index of every child, which has to print the child using this context.
+        void print_children(usize const num_children, std::invocable<usize> auto const& print_child) {
+            if (num_children == 0) {
                 return;
             }
-
-            begin_children(children.size() == 1);
-            for (auto i = usize{ 0 }; i < children.size(); ++i) {
-                if (i == children.size() - 1) {
-                    is_last_child = true;
+            if (m_statistics != nullptr) {
+                for (auto i = usize{ 0 }; i < num_children; ++i) {
+                    print_child(i);
                 }
-                children[i]->print(*this);
+                return;
             }
-            end_children();
-        }
 
-    private:
-        void indent(bool const only_one_child) {
-            indents.push_back(only_one_child);
-            just_indented = true;
+            m_dumper->begin_children(num_children);
+            for (auto i = usize{ 0 }; i < num_children; ++i) {
+                print_child(i);
+                m_dumper->end_node();
+            }
+            m_dumper->end_children();
         }
+    };
 
-        void dedent() {
-            indents.pop_back();
-            just_indented = false;
-        }
+    virtual void print(PrintContext& context) const = 0;
 
-        void begin_children(bool const only_one_child) {
-            indent(only_one_child);
-        }
+protected:
+    // Only valid for nodes that have a source location.
+    [[nodiscard]] SourceFile const& source_file() const {
+        return *m_file;
+    }
 
-        void end_children() {
-            dedent();
+private:
+    void include(SourceFile const& file, SourceSpan const span) {
+        if (m_file == nullptr) {
+            m_file = &file;
+            m_span = span;
+        } else {
+            m_span = m_span.join(span);
         }
+    }
 
-        void print_indentation() {
-            if (indents.empty()) {
-                return;
-            }
-            for (auto i = usize{ 0 }; i < indents.size() - 1; ++i) {
-                if (indents.at(i)) {
-                    std::print("  ");
-                } else {
-                    std::print("| ");
-                }
-            }
-            if (indents.back() or is_last_child) {
-                std::print("`-");
-                if (is_last_child) {
-                    indents.back() = true;
-                }
-            } else {
-                std::print("|-");
-            }
-            just_indented = false;
-            is_last_child = false;
+    void include(Token const& token) {
+        include(token.file(), SourceSpan::of(token));
+    }
+
+    void include(AstNode const& node) {
+        if (node.m_file != nullptr) {
+            include(*node.m_file, node.m_span);
         }
-    };
+    }
 
-    virtual void print(PrintContext& context) const = 0;
+    template<typename T>
+    void include(tl::optional<T> const& part) {
+        if (part.has_value()) {
+            include(*part);
+        }
+    }
 };
 
-template<MaybeAstNode... Nodes>
-[[nodiscard]] SourceLocation join_source_locations(Nodes const&... nodes) {
-    auto result = tl::optional<SourceLocation>{};
-    // clang-format off
-    ([&] {
-        if constexpr (IsOptional<Nodes, AstNode const&>) {
-            if (nodes.has_value()) {
-                if (result.has_value()) {
-                    result = result.value().join(nodes.value().source_location());
-                } else {
-                    result = nodes.value().source_location();
-                }
-            }
-        } else {
-            if (result.has_value()) {
-                result = result.value().join(nodes.source_location());
-            } else {
-                result = nodes.source_location();
-            }
-        }
-    }(), ...);
-    // clang-format on
-    if (not result.has_value()) {
-        throw InternalCompilerError{ "Expected at least one source location." };
+// For the constructors of nodes that span their first or last element, which have to check the list before it is
+// moved into the node.
+template<typename Error = InternalCompilerError, typename List>
+[[nodiscard]] List const& expect_not_empty(List const& list, char const* const message) {
+    if (list.empty()) {
+        throw_or_abort(Error{ message });
     }
-    return result.value();
+    return list;
 }
@@ -2,27 +2,44 @@
 
 #include <lexer/token.hpp>
 #include <lib2k/types.hpp>
-#include <memory>
 #include <tl/optional.hpp>
 #include <variant>
+#include "arena.hpp"
 #include "ast_node.hpp"
 #include "identifier.hpp"
 #include "literals.hpp"
 
-class Constant : public AstNode {};
+class Constant : public AstNode {
+protected:
+    using AstNode::AstNode;
+};
+
+// Stands in for a constant that could not be parsed. It spans the tokens that have been skipped.
+class ErrorConstant final : public Constant {
+public:
+    [[nodiscard]] explicit ErrorConstant(SourceFile const& file, SourceSpan const span)
+        : Constant{ file, span } {}
+
+    void print(PrintContext& context) const override {
+        context.print(*this, "ErrorConstant");
+    }
+};
 
 class ConstantDefinition final : public AstNode {
 protected:
     Identifier m_identifier;
-    std::unique_ptr<Constant> m_constant;
+    ArenaPtr<Constant> m_constant;
 
 public:
-    [[nodiscard]] explicit ConstantDefinition(Identifier const& identifier, std::unique_ptr<Constant> constant)
-        : m_identifier{ identifier }, m_constant{ std::move(constant) } {}
+    [[nodiscard]] explicit ConstantDefinition(Identifier const& identifier, ArenaPtr<Constant> constant)
+        : AstNode{ identifier, *constant }, m_identifier{ identifier }, m_constant{ constant } {}
 
-public:
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_identifier.source_location().join(m_constant->source_location());
+    [[nodiscard]] Identifier const& identifier() const {
+        return m_identifier;
+    }
+
+    [[nodiscard]] Constant const& constant() const {
+        return *m_constant;
     }
 
     void print(PrintContext& context) const override {
@@ -33,28 +50,20 @@ public:
 
 class IntegerConstant final : public Constant {
 private:
-    tl::optional<Token const&> m_sign;
+    tl::optional<Token> m_sign;
     IntegerLiteral m_integer_literal;
 
 public:
-    template<std::same_as<Token const> T>
-    [[nodiscard]] explicit IntegerConstant(tl::optional<T&> const& sign, IntegerLiteral const& integer_literal)
-        : m_sign{ sign }, m_integer_literal{ integer_literal } {}
+    [[nodiscard]] explicit IntegerConstant(tl::optional<Token> const& sign, IntegerLiteral const& integer_literal)
+        : Constant{ sign, integer_literal }, m_sign{ sign }, m_integer_literal{ integer_literal } {}
 
     [[nodiscard]] IntegerLiteral const& integer_literal() const {
         return m_integer_literal;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        if (m_sign.has_value()) {
-            return m_sign.value().source_location().join(integer_literal().source_location());
-        }
-        return integer_literal().source_location();
-    }
-
     void print(PrintContext& context) const override {
         if (m_sign.has_value()) {
-            context.print(*this, "IntegerConstant", m_sign.value().lexeme());
+            context.print(*this, "IntegerConstant", m_sign->lexeme());
         } else {
             context.print(*this, "IntegerConstant");
         }
@@ -64,28 +73,20 @@ public:
 
 class RealConstant final : public Constant {
 private:
-    tl::optional<Token const&> m_sign;
+    tl::optional<Token> m_sign;
     RealLiteral m_real_literal;
 
 public:
-    template<std::same_as<Token const> T>
-    [[nodiscard]] explicit RealConstant(tl::optional<T&> const& sign, RealLiteral const& real_literal)
-        : m_sign{ sign }, m_real_literal{ real_literal } {}
+    [[nodiscard]] explicit RealConstant(tl::optional<Token> const& sign, RealLiteral const& real_literal)
+        : Constant{ sign, real_literal }, m_sign{ sign }, m_real_literal{ real_literal } {}
 
     [[nodiscard]] RealLiteral const& real_literal() const {
         return m_real_literal;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        if (m_sign.has_value()) {
-            return m_sign.value().source_location().join(real_literal().source_location());
-        }
-        return real_literal().source_location();
-    }
-
     void print(PrintContext& context) const override {
         if (m_sign.has_value()) {
-            context.print(*this, "RealConstant", m_sign.value().lexeme());
+            context.print(*this, "RealConstant", m_sign->lexeme());
         } else {
             context.print(*this, "RealConstant");
         }
@@ -99,16 +100,12 @@ private:
 
 public:
     [[nodiscard]] explicit CharConstant(CharLiteral const& char_literal)
-        : m_char_literal{ char_literal } {}
+        : Constant{ char_literal }, m_char_literal{ char_literal } {}
 
     [[nodiscard]] CharLiteral const& char_literal() const {
         return m_char_literal;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return char_literal().source_location();
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "CharConstant");
         context.print_children(char_literal());
@@ -121,16 +118,12 @@ private:
 
 public:
     [[nodiscard]] explicit StringConstant(StringLiteral const& string_literal)
-        : m_string_literal{ string_literal } {}
+        : Constant{ string_literal }, m_string_literal{ string_literal } {}
 
     [[nodiscard]] StringLiteral const& string_literal() const {
         return m_string_literal;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return string_literal().source_location();
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "StringConstant");
         context.print_children(string_literal());
@@ -139,34 +132,24 @@ public:
 
 class ConstantReference final : public Constant {
 private:
-    tl::optional<Token const&> m_sign;
-    Token const* m_referenced_constant;
+    tl::optional<Token> m_sign;
+    Token m_referenced_constant;
 
 public:
-    template<std::same_as<Token const> T>
-    [[nodiscard]] explicit ConstantReference(
-        tl::optional<T&> const& sign,
-        std::same_as<Token const> auto& referenced_constant
-    ) : m_sign{ sign }, m_referenced_constant{ &referenced_constant } {}
+    [[nodiscard]] explicit ConstantReference(tl::optional<Token> const& sign, Token const& referenced_constant)
+        : Constant{ sign, referenced_constant }, m_sign{ sign }, m_referenced_constant{ referenced_constant } {}
 
-    [[nodiscard]] tl::optional<Token const&> const& sign() const {
+    [[nodiscard]] tl::optional<Token> const& sign() const {
         return m_sign;
     }
 
     [[nodiscard]] Token const& referenced_constant() const {
-        return *m_referenced_constant;
-    }
-
-    [[nodiscard]] SourceLocation source_location() const override {
-        if (m_sign.has_value()) {
-            return m_sign.value().source_location().join(referenced_constant().source_location());
-        }
-        return referenced_constant().source_location();
+        return m_referenced_constant;
     }
 
     void print(PrintContext& context) const override {
         if (m_sign.has_value()) {
-            context.print(*this, "ConstantReference", m_sign.value().lexeme(), referenced_constant().lexeme());
+            context.print(*this, "ConstantReference", m_sign->lexeme(), referenced_constant().lexeme());
         } else {
             context.print(*this, "ConstantReference", referenced_constant().lexeme());
         }
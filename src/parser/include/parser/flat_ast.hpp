@@ -0,0 +1,278 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <filesystem>
+#include <lexer/interner.hpp>
+#include <lexer/source_buffer.hpp>
+#include <lexer/source_file.hpp>
+#include <lib2k/types.hpp>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "ast_dumper.hpp"
+#include "node_statistics.hpp"
+#include "source_span.hpp"
+
+// Identifies a node within a `FlatAst`.
+enum class NodeIndex : u32 {};
+
+// There is one kind for every class of the pointer-based `Ast`, and the nodes have the same children in the same
+// order. Optional children that are missing are left out. Leaves store their payload in the data of the node.
+enum class NodeKind : u8 {
+    Block,                     // LabelDeclarations?, ConstantDefinitions?, TypeDefinitions?, VariableDeclarations?
+    LabelDeclarations,         // LabelDeclaration...
+    LabelDeclaration,          // IntegerLiteral
+    ConstantDefinitions,       // ConstantDefinition...
+    ConstantDefinition,        // Identifier, constant
+    IntegerConstant,           // IntegerLiteral (preceded by the sign, if any)
+    RealConstant,              // RealLiteral (preceded by the sign, if any)
+    CharConstant,              // CharLiteral
+    StringConstant,            // StringLiteral
+    ConstantReference,         // Leaf: symbol (preceded by the sign, if any)
+    ErrorConstant,             // Leaf
+    TypeDefinitions,           // TypeDefinition...
+    TypeDefinition,            // Identifier, type
+    ErrorType,                 // Leaf
+    TypeAliasDefinition,       // Identifier
+    EnumeratedTypeDefinition,  // IdentifierList
+    SubrangeTypeDefinition,    // constant, constant
+    StructuredTypeDefinition,  // unpacked structured type (preceded by `packed`, if any)
+    ArrayTypeDefinition,       // ordinal type..., type
+    RecordTypeDefinition,      // FieldList?
+    SetTypeDefinition,         // ordinal type
+    FileTypeDefinition,        // type
+    PointerTypeDefinition,     // Identifier or built-in type
+    FieldList,                 // FixedPart?, VariantPart?
+    FixedPart,                 // RecordSection...
+    RecordSection,             // IdentifierList, type
+    VariantPart,               // VariantSelector, VariantList
+    VariantSelector,           // Identifier?, ordinal type
+    VariantList,               // Variant...
+    Variant,                   // CaseConstantList, FieldList?
+    CaseConstantList,          // constant...
+    VariableDeclarations,      // VariableDeclaration...
+    VariableDeclaration,       // IdentifierList, type
+    IdentifierList,            // Identifier...
+    Identifier,                // Leaf: symbol
+    IntegerLiteral,            // Leaf: literal
+    RealLiteral,               // Leaf: literal
+    CharLiteral,               // Leaf: literal
+    StringLiteral,             // Leaf: literal
+    RealType,                  // Leaf
+    BooleanType,               // Leaf
+    CharType,                  // Leaf
+    IntegerType,               // Leaf
+};
+
+[[nodiscard]] constexpr bool is_leaf(NodeKind const kind) {
+    switch (kind) {
+        case NodeKind::ConstantReference:
+        case NodeKind::ErrorConstant:
+        case NodeKind::ErrorType:
+        case NodeKind::Identifier:
+        case NodeKind::IntegerLiteral:
+        case NodeKind::RealLiteral:
+        case NodeKind::CharLiteral:
+        case NodeKind::StringLiteral:
+        case NodeKind::RealType:
+        case NodeKind::BooleanType:
+        case NodeKind::CharType:
+        case NodeKind::IntegerType:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// An alternative to `Ast` without pointers and virtual functions. The nodes are stored in parallel arrays, so a node
+// takes 13 bytes. Nodes are stored in post-order: Children come before their parents, and the root (the block) is the
+// last node. Therefore, every subtree is a contiguous range of nodes that ends with its root, and the children of a
+// node are found by walking backwards from it. Passes that do not depend on the structure of the tree, e.g., to find
+// all identifiers, can scan `kinds()` linearly.
+class FlatAst final {
+public:
+    // Walks backwards from the last child of a node to its first child.
+    class ReverseChildIterator final {
+    private:
+        FlatAst const* m_ast = nullptr;
+        u32 m_end_of_child = 0;  // One past the current child.
+
+    public:
+        using value_type = NodeIndex;
+        using difference_type = std::ptrdiff_t;
+
+        [[nodiscard]] ReverseChildIterator() = default;
+
+        [[nodiscard]] ReverseChildIterator(FlatAst const& ast, u32 const end_of_child)
+            : m_ast{ &ast }, m_end_of_child{ end_of_child } {}
+
+        [[nodiscard]] NodeIndex operator*() const {
+            return NodeIndex{ m_end_of_child - 1 };
+        }
+
+        ReverseChildIterator& operator++() {
+            m_end_of_child -= m_ast->subtree_size(**this);
+            return *this;
+        }
+
+        ReverseChildIterator operator++(int) {
+            auto const result = *this;
+            ++*this;
+            return result;
+        }
+
+        [[nodiscard]] bool operator==(ReverseChildIterator const& other) const {
+            return m_end_of_child == other.m_end_of_child;
+        }
+    };
+
+    struct ReverseChildren final {
+        ReverseChildIterator first;
+        ReverseChildIterator last;
+
+        [[nodiscard]] ReverseChildIterator begin() const {
+            return first;
+        }
+
+        [[nodiscard]] ReverseChildIterator end() const {
+            return last;
+        }
+    };
+
+    // Written at the start of every file that is created by `save()`. It is incremented whenever the format changes.
+    static constexpr auto file_version = u32{ 1 };
+
+private:
+    std::shared_ptr<SourceFile const> m_file;  // Keeps the source referenced by the spans valid.
+    std::shared_ptr<Interner const> m_interner;
+    std::shared_ptr<void const> m_storage;  // Owns the arrays, which are either vectors or the contents of a file.
+    std::span<NodeKind const> m_kinds;
+    std::span<SourceSpan const> m_spans;
+    std::span<u32 const> m_data;  // The payload of leaves, and the subtree size of all other nodes.
+
+public:
+    [[nodiscard]] explicit FlatAst(
+        std::shared_ptr<SourceFile const> file,
+        std::shared_ptr<Interner const> interner,
+        std::vector<NodeKind> kinds,
+        std::vector<SourceSpan> spans,
+        std::vector<u32> data
+    );
+
+    // Reads a file that has been written by `save()`. Regular files are memory-mapped, and the nodes and the source
+    // are used in place. The interner is rebuilt, and the nodes are validated in one pass, so loading takes time
+    // proportional to the number of nodes, symbols, and literals, but not to the size of the source. The source is not
+    // read until the line of a location is looked up. Throws `std::runtime_error` if the file cannot be read, if it
+    // has not been written by `save()` with the same `file_version` on a machine with the same byte order, or if its
+    // nodes are inconsistent, e.g., because the file has been truncated.
+    [[nodiscard]] static FlatAst load(std::filesystem::path const& path);
+
+    // Like `load()`, but for the contents of a file that have already been read.
+    [[nodiscard]] static FlatAst load(SourceBuffer buffer);
+
+    [[nodiscard]] Interner const& interner() const {
+        return *m_interner;
+    }
+
+    [[nodiscard]] usize size() const {
+        return m_kinds.size();
+    }
+
+    [[nodiscard]] NodeIndex root() const {
+        return NodeIndex{ static_cast<u32>(m_kinds.size() - 1) };
+    }
+
+    [[nodiscard]] std::span<NodeKind const> kinds() const {
+        return m_kinds;
+    }
+
+    [[nodiscard]] NodeKind kind(NodeIndex const node) const {
+        return m_kinds[static_cast<usize>(node)];
+    }
+
+    [[nodiscard]] SourceSpan span(NodeIndex const node) const {
+        return m_spans[static_cast<usize>(node)];
+    }
+
+    [[nodiscard]] SourceLocation source_location(NodeIndex const node) const {
+        return span(node).source_location(*m_file);
+    }
+
+    // The source text spanned by `node`.
+    [[nodiscard]] std::string_view text(NodeIndex const node) const {
+        return m_file->source().substr(span(node).offset, span(node).length);
+    }
+
+    // The number of nodes in the subtree of `node`, including `node` itself.
+    [[nodiscard]] u32 subtree_size(NodeIndex const node) const {
+        return is_leaf(kind(node)) ? 1 : m_data[static_cast<usize>(node)];
+    }
+
+    // Use `std::ranges::reverse()` on a copy to get the children in source order.
+    [[nodiscard]] ReverseChildren reverse_children(NodeIndex const node) const {
+        auto const end = static_cast<u32>(node);
+        auto const begin = end + 1 - subtree_size(node);
+        return ReverseChildren{ ReverseChildIterator{ *this, end }, ReverseChildIterator{ *this, begin } };
+    }
+
+    // Only valid for identifiers and constant references.
+    [[nodiscard]] Symbol symbol(NodeIndex const node) const {
+        assert(kind(node) == NodeKind::Identifier or kind(node) == NodeKind::ConstantReference);
+        return Symbol{ m_data[static_cast<usize>(node)] };
+    }
+
+    // Only valid for literals. Their values are stored in the literal pool of the interner.
+    [[nodiscard]] Literal literal(NodeIndex const node) const {
+        assert(
+            kind(node) == NodeKind::IntegerLiteral or kind(node) == NodeKind::RealLiteral
+            or kind(node) == NodeKind::CharLiteral or kind(node) == NodeKind::StringLiteral
+        );
+        return Literal{ m_data[static_cast<usize>(node)] };
+    }
+
+    // The sign of an integer constant, real constant, or constant reference, or an empty string if it has none.
+    [[nodiscard]] std::string_view sign(NodeIndex node) const;
+
+    // The name that a constant reference refers to.
+    [[nodiscard]] std::string_view referenced_constant(NodeIndex node) const;
+
+    // The keyword `packed` of a structured type definition, or an empty string if it is not packed.
+    [[nodiscard]] std::string_view packed(NodeIndex node) const;
+
+    // The number of bytes used by the arrays.
+    [[nodiscard]] usize memory_usage() const;
+
+    // Counts the nodes by kind. Every node occupies one element of each array.
+    [[nodiscard]] NodeStatistics node_statistics() const;
+
+    // Writes the tree, its source, and the symbols and literals of its interner in a binary format that does not
+    // contain any pointers. All integers are little endian, and every section starts at a multiple of eight bytes:
+    //     header    := "P2KA" version:u32 num_nodes:u32 num_symbols:u32 num_literals:u32 padding:u32 section{9}
+    //     section   := offset:u64 size:u64  (path, source, kinds, spans, data, symbols, spellings, literals, strings)
+    //     kinds     := u8 per node
+    //     spans     := (offset:u32 length:u32) per node
+    //     data      := u32 per node
+    //     symbols   := (offset:u32 length:u32) per symbol, into spellings
+    //     literals  := (kind:u32 length:u32 value:u64) per literal, where the value of a string is its offset into
+    //                  strings, and the value of a real is the bit pattern of the double
+    void save(DumpSink& sink) const;
+
+    // Writes the same output as `Ast::dump()`, and returns the number of nodes like it.
+    usize dump(DumpSink& sink, DumpFormat format) const;
+
+    // Prints the same tree as `Ast::print()`.
+    void print() const;
+
+private:
+    // The arrays are owned by `storage`.
+    [[nodiscard]] explicit FlatAst(
+        std::shared_ptr<SourceFile const> file,
+        std::shared_ptr<Interner const> interner,
+        std::shared_ptr<void const> storage,
+        std::span<NodeKind const> kinds,
+        std::span<SourceSpan const> spans,
+        std::span<u32 const> data
+    );
+};
@@ -5,25 +5,27 @@
 
 class Identifier final : public AstNode {
 private:
-    Token const* m_token;
+    Symbol m_symbol;
 
 public:
-    [[nodiscard]] explicit Identifier(std::same_as<Token const> auto& token)
-        : m_token{ &token } {
+    [[nodiscard]] explicit Identifier(Token const& token)
+        : AstNode{ token }, m_symbol{ token.symbol() } {
         if (token.type() != TokenType::Identifier) {
-            throw InternalCompilerError{ "Expected identifier token." };
+            throw_or_abort(InternalCompilerError{ "Expected identifier token." });
         }
     }
 
-    [[nodiscard]] Token const& token() const {
-        return *m_token;
+    // The token is not stored, since the node already knows where it is.
+    [[nodiscard]] Token token() const {
+        return Token{ TokenType::Identifier, source_file(), span().offset, span().length, m_symbol };
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_token->source_location();
+    // Identifiers that only differ in case have the same symbol.
+    [[nodiscard]] Symbol symbol() const {
+        return m_symbol;
     }
 
     void print(PrintContext& context) const override {
-        context.print(*this, "Identifier", m_token->lexeme());
+        context.print(*this, "Identifier", token().lexeme());
     }
 };
@@ -1,33 +1,22 @@
 #pragma once
 
-#include <lib2k/string_utils.hpp>
+#include <lexer/literal_pool.hpp>
 #include <lib2k/types.hpp>
-#include <sstream>
-#include "parser_error.hpp"
+#include <string_view>
 
 class IntegerLiteral final : public AstNode {
 private:
-    Token const* m_integer_token;
     i64 m_value;
 
 public:
-    [[nodiscard]] explicit IntegerLiteral(std::same_as<Token const> auto& integer_token)
-        : m_integer_token{ &integer_token } {
-        auto const parsed = c2k::parse<i64>(integer_token.lexeme());
-        if (not parsed.has_value()) {
-            throw ParserError{ "Integer literal out of range.", integer_token.source_location() };
-        }
-        m_value = parsed.value();
-    }
+    // The parser checks whether the value is in range.
+    [[nodiscard]] explicit IntegerLiteral(Token const& integer_token, i64 const value)
+        : AstNode{ integer_token }, m_value{ value } {}
 
     [[nodiscard]] i64 value() const {
         return m_value;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_integer_token->source_location();
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "IntegerLiteral", value());
     }
@@ -35,29 +24,17 @@ public:
 
 class RealLiteral final : public AstNode {
 private:
-    Token const* m_real_token;
     double m_value;
 
 public:
-    [[nodiscard]] explicit RealLiteral(std::same_as<Token const> auto& real_token)
-        : m_real_token{ &real_token } {
-        auto stream = std::istringstream{ std::string{ real_token.lexeme() } };
-        auto result = 0.0;
-        stream >> result;
-        if (not stream.eof()) {
-            throw InternalCompilerError{ "Failed to parse real number." };
-        }
-        m_value = result;
-    }
+    // The parser checks whether the value is in range.
+    [[nodiscard]] explicit RealLiteral(Token const& real_token, double const value)
+        : AstNode{ real_token }, m_value{ value } {}
 
     [[nodiscard]] double value() const {
         return m_value;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_real_token->source_location();
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "RealLiteral", value());
     }
@@ -65,34 +42,22 @@ public:
 
 class CharLiteral final : public AstNode {
 private:
-    Token const* m_char_token;
     char m_value;
 
 public:
-    [[nodiscard]] explicit CharLiteral(std::same_as<Token const> auto& char_token)
-        : m_char_token{ &char_token } {
-        if (char_token.lexeme().length() > 3) {
-            if (char_token.lexeme().at(1) != '\'' or char_token.lexeme().at(2) != '\''
-                or char_token.lexeme().length() != 4) {
-                throw InternalCompilerError{ "Invalid character literal." };
-            }
-            m_value = '\'';
-            return;
+    [[nodiscard]] explicit CharLiteral(Token const& char_token, LiteralPool const& literals)
+        : AstNode{ char_token } {
+        auto const value = literals.string(char_token.literal());
+        if (value.length() != 1) {
+            throw_or_abort(InternalCompilerError{ "Invalid character literal." });
         }
-        if (char_token.lexeme().length() != 3) {
-            throw InternalCompilerError{ "Invalid character literal." };
-        }
-        m_value = char_token.lexeme().at(1);
+        m_value = value.front();
     }
 
     [[nodiscard]] char value() const {
         return m_value;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_char_token->source_location();
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "CharLiteral", value());
     }
@@ -100,34 +65,17 @@ public:
 
 class StringLiteral final : public AstNode {
 private:
-    Token const* m_string_token;
-    std::string m_value;
+    std::string_view m_value;
 
 public:
-    explicit StringLiteral(std::same_as<Token const> auto& string_token)
-        : m_string_token{ &string_token } {
-        auto result = std::string{};
-        auto const lexeme = string_token.lexeme();
-        for (auto i = usize{ 1 }; i < lexeme.length() - 1;) {
-            if (lexeme.at(i) == '\'' and lexeme.at(i + 1) == '\'') {
-                result += '\'';
-                i += 2;
-            } else {
-                result += lexeme.at(i);
-                ++i;
-            }
-        }
-        m_value = std::move(result);
-    }
+    // The value is owned by `literals`, which must outlive this literal.
+    [[nodiscard]] explicit StringLiteral(Token const& string_token, LiteralPool const& literals)
+        : AstNode{ string_token }, m_value{ literals.string(string_token.literal()) } {}
 
-    [[nodiscard]] std::string const& value() const {
+    [[nodiscard]] std::string_view value() const {
         return m_value;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_string_token->source_location();
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "StringLiteral", value());
     }
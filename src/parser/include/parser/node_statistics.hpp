@@ -0,0 +1,36 @@
+#pragma once
+
+#include <lib2k/types.hpp>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// The number of nodes of every kind in a syntax tree, and the bytes they occupy.
+class NodeStatistics final {
+public:
+    struct Entry final {
+        std::string_view kind;  // The name of the class, or of the `NodeKind`.
+        u64 num_nodes;
+        u64 num_bytes;
+    };
+
+private:
+    std::vector<Entry> m_entries;  // In the order in which the kinds were seen first.
+
+public:
+    // There are only a few dozen kinds, so they are searched linearly. `kind` must outlive the statistics.
+    void add(std::string_view const kind, u64 const num_bytes) {
+        for (auto& entry : m_entries) {
+            if (entry.kind == kind) {
+                ++entry.num_nodes;
+                entry.num_bytes += num_bytes;
+                return;
+            }
+        }
+        m_entries.push_back(Entry{ kind, 1, num_bytes });
+    }
+
+    [[nodiscard]] std::span<Entry const> entries() const {
+        return m_entries;
+    }
+};
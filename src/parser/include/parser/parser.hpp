@@ -1,8 +1,38 @@
 #pragma once
 
-#include <lexer/token.hpp>
+#include <expected>
+#include <lexer/diagnostic.hpp>
+#include <lexer/token_buffer.hpp>
+#include <lexer/token_stream.hpp>
 #include <parser/parser_error.hpp>
 #include <vector>
 #include "ast.hpp"
+#include "flat_ast.hpp"
 
-[[nodiscard]] Ast parse(std::vector<Token>&& tokens);
+[[nodiscard]] Ast parse(TokenBuffer&& tokens);
+
+// Parses while lexing. Only the lookahead tokens the parser needs are kept in memory.
+[[nodiscard]] Ast parse(TokenStream&& tokens);
+
+// Like `parse()`, but instead of throwing, the first error is reported into `diagnostics`. With a `TokenStream`, this
+// may be a lexer error, which is reported in the same order as `parse()` would throw it. This is much cheaper for
+// inputs that are likely to be invalid, and it also works when exceptions are disabled.
+[[nodiscard]] std::expected<Ast, DiagnosticId> try_parse(Diagnostics& diagnostics, TokenBuffer&& tokens);
+[[nodiscard]] std::expected<Ast, DiagnosticId> try_parse(Diagnostics& diagnostics, TokenStream&& tokens);
+
+// Like `parse()` and `try_parse()`, but the nodes are stored in a `FlatAst`, which is much more compact.
+[[nodiscard]] FlatAst parse_flat(TokenBuffer&& tokens);
+[[nodiscard]] FlatAst parse_flat(TokenStream&& tokens);
+[[nodiscard]] std::expected<FlatAst, DiagnosticId> try_parse_flat(Diagnostics& diagnostics, TokenBuffer&& tokens);
+[[nodiscard]] std::expected<FlatAst, DiagnosticId> try_parse_flat(Diagnostics& diagnostics, TokenStream&& tokens);
+
+// Like `try_parse()`, but the parser recovers from syntax errors and returns an AST even if there have been errors.
+// After an error, it skips to the next `;`, `end`, or section keyword. Every error is reported into `diagnostics`. A
+// type or constant that could not be parsed is replaced by an `ErrorType` or `ErrorConstant` (`NodeKind::ErrorType`
+// or `NodeKind::ErrorConstant`), and missing identifiers and labels are empty. Errors that directly follow a previous
+// error are not reported. Parsing stops after a lexer error, or after `max_errors` errors, since later errors are
+// likely to be caused by the previous ones.
+[[nodiscard]] Ast parse_with_recovery(Diagnostics& diagnostics, TokenBuffer&& tokens, usize max_errors = 100);
+[[nodiscard]] Ast parse_with_recovery(Diagnostics& diagnostics, TokenStream&& tokens, usize max_errors = 100);
+[[nodiscard]] FlatAst parse_flat_with_recovery(Diagnostics& diagnostics, TokenBuffer&& tokens, usize max_errors = 100);
+[[nodiscard]] FlatAst parse_flat_with_recovery(Diagnostics& diagnostics, TokenStream&& tokens, usize max_errors = 100);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <lexer/diagnostic.hpp>
 #include <lexer/source_location.hpp>
 #include <stdexcept>
 #include <vector>
@@ -26,3 +27,6 @@ public:
         return m_notes;
     }
 };
+
+// Throws the exception that corresponds to an error reported by `try_parse()`, which may also be a lexer error.
+[[noreturn]] void throw_parser_error(Diagnostics const& diagnostics, DiagnosticId id);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <algorithm>
+#include <lexer/source_location.hpp>
+#include <lexer/token.hpp>
+#include <lib2k/types.hpp>
+
+// A range of characters within a source file. Unlike `SourceLocation`, it does not refer to the file, so it is only
+// eight bytes large.
+struct SourceSpan final {
+    u32 offset;
+    u32 length;
+
+    [[nodiscard]] static SourceSpan of(Token const& token) {
+        return SourceSpan{ token.offset(), token.length() };
+    }
+
+    [[nodiscard]] u32 end() const {
+        return offset + length;
+    }
+
+    // Like `SourceLocation::join()`.
+    [[nodiscard]] SourceSpan join(SourceSpan const other) const {
+        auto const begin = std::min(offset, other.offset);
+        return SourceSpan{ begin, std::max(end(), other.end()) - begin };
+    }
+
+    [[nodiscard]] SourceLocation source_location(SourceFile const& file) const {
+        return SourceLocation{ file.shared_from_this(), offset, length };
+    }
+
+    [[nodiscard]] constexpr bool operator==(SourceSpan const& other) const = default;
+};
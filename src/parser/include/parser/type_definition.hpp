@@ -1,33 +1,31 @@
 #pragma once
 
 #include <lexer/token.hpp>
-#include <memory>
 #include <variant>
+#include "arena.hpp"
 #include "ast_node.hpp"
 #include "constant_definition.hpp"
 #include "identifier_list.hpp"
 
-class Type : public AstNode {};
+class Type : public AstNode {
+protected:
+    using AstNode::AstNode;
+};
 
 namespace detail {
     template<typename Parent, TokenType token_type>
     class BuiltInType : public Parent {
     private:
-        Token const* m_token;
         std::string_view m_ast_node_name;
 
     public:
-        [[nodiscard]] explicit BuiltInType(std::same_as<Token const> auto& token, std::string_view const ast_node_name)
-            : m_token{ &token }, m_ast_node_name{ ast_node_name } {
-            if (m_token->type() != token_type) {
-                throw InternalCompilerError{ "Invalid token type for built-in type." };
+        [[nodiscard]] explicit BuiltInType(Token const& token, std::string_view const ast_node_name)
+            : Parent{ token }, m_ast_node_name{ ast_node_name } {
+            if (token.type() != token_type) {
+                throw_or_abort(InternalCompilerError{ "Invalid token type for built-in type." });
             }
         }
 
-        [[nodiscard]] SourceLocation source_location() const override {
-            return m_token->source_location();
-        }
-
         void print(AstNode::PrintContext& context) const override {
             context.print(*this, m_ast_node_name);
         }
@@ -40,7 +38,10 @@ public:
         : BuiltInType{ token, "RealType" } {}
 };
 
-class OrdinalType : public Type {};
+class OrdinalType : public Type {
+protected:
+    using Type::Type;
+};
 
 class BooleanType final : public detail::BuiltInType<OrdinalType, TokenType::Boolean> {
 public:
@@ -60,21 +61,32 @@ public:
         : BuiltInType{ token, "CharType" } {}
 };
 
+// Stands in for a type that could not be parsed. It spans the tokens that have been skipped.
+class ErrorType final : public Type {
+public:
+    [[nodiscard]] explicit ErrorType(SourceFile const& file, SourceSpan const span)
+        : Type{ file, span } {}
+
+    void print(PrintContext& context) const override {
+        context.print(*this, "ErrorType");
+    }
+};
+
 class TypeDefinition final : public AstNode {
 private:
     Identifier m_identifier;
-    std::unique_ptr<Type> m_type;
+    ArenaPtr<Type> m_type;
 
 public:
-    [[nodiscard]] explicit TypeDefinition(Identifier const& identifier, std::unique_ptr<Type> type)
-        : m_identifier{ identifier }, m_type{ std::move(type) } {}
+    [[nodiscard]] explicit TypeDefinition(Identifier const& identifier, ArenaPtr<Type> type)
+        : AstNode{ identifier, *type }, m_identifier{ identifier }, m_type{ type } {}
 
     [[nodiscard]] Identifier const& identifier() const {
         return m_identifier;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_identifier.source_location().join(m_type->source_location());
+    [[nodiscard]] Type const& type() const {
+        return *m_type;
     }
 
     void print(PrintContext& context) const override {
@@ -89,16 +101,12 @@ private:
 
 public:
     [[nodiscard]] explicit TypeAliasDefinition(Identifier const& referenced_type)
-        : m_referenced_type{ referenced_type } {}
+        : OrdinalType{ referenced_type }, m_referenced_type{ referenced_type } {}
 
     [[nodiscard]] Identifier const& referenced_type() const {
         return m_referenced_type;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_referenced_type.source_location();
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "TypeAliasDefinition");
         context.print_children(m_referenced_type);
@@ -107,28 +115,20 @@ public:
 
 class EnumeratedTypeDefinition final : public OrdinalType {
 private:
-    Token const* m_left_parenthesis;
     IdentifierList m_identifiers;
-    Token const* m_right_parenthesis;
 
 public:
     [[nodiscard]] explicit EnumeratedTypeDefinition(
-        std::same_as<Token const> auto& left_parenthesis,
+        Token const& left_parenthesis,
         IdentifierList identifiers,
-        std::same_as<Token const> auto& right_parenthesis
+        Token const& right_parenthesis
     )
-        : m_left_parenthesis{ &left_parenthesis },
-          m_identifiers{ std::move(identifiers) },
-          m_right_parenthesis{ &right_parenthesis } {}
+        : OrdinalType{ left_parenthesis, right_parenthesis }, m_identifiers{ std::move(identifiers) } {}
 
     [[nodiscard]] IdentifierList const& identifiers() const {
         return m_identifiers;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_left_parenthesis->source_location().join(m_right_parenthesis->source_location());
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "EnumeratedTypeDefinition");
         context.print_children(m_identifiers);
@@ -137,52 +137,45 @@ public:
 
 class SubrangeTypeDefinition final : public OrdinalType {
 private:
-    std::unique_ptr<Constant> m_from;
-    std::unique_ptr<Constant> m_to;
+    ArenaPtr<Constant> m_from;
+    ArenaPtr<Constant> m_to;
 
 public:
-    [[nodiscard]] explicit SubrangeTypeDefinition(std::unique_ptr<Constant> from, std::unique_ptr<Constant> to)
-        : m_from{ std::move(from) }, m_to{ std::move(to) } {}
+    [[nodiscard]] explicit SubrangeTypeDefinition(ArenaPtr<Constant> from, ArenaPtr<Constant> to)
+        : OrdinalType{ *from, *to }, m_from{ from }, m_to{ to } {}
 
-    [[nodiscard]] std::unique_ptr<Constant> const& from() const {
+    [[nodiscard]] ArenaPtr<Constant> const& from() const {
         return m_from;
     }
 
-    [[nodiscard]] std::unique_ptr<Constant> const& to() const {
+    [[nodiscard]] ArenaPtr<Constant> const& to() const {
         return m_to;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_from->source_location().join(m_to->source_location());
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "SubrangeTypeDefinition");
         context.print_children(*m_from, *m_to);
     }
 };
 
-class UnpackedStructuredTypeDefinition : public Type {};
+class UnpackedStructuredTypeDefinition : public Type {
+protected:
+    using Type::Type;
+};
 
 class StructuredTypeDefinition final : public Type {
 private:
-    tl::optional<Token const&> m_packed;
-    std::unique_ptr<UnpackedStructuredTypeDefinition> m_unpacked_structured_type_definition;
+    tl::optional<Token> m_packed;
+    ArenaPtr<UnpackedStructuredTypeDefinition> m_unpacked_structured_type_definition;
 
 public:
-    template<std::same_as<Token const> T>
     [[nodiscard]] explicit StructuredTypeDefinition(
-        tl::optional<T&> const& packed,
-        std::unique_ptr<UnpackedStructuredTypeDefinition> unpacked_structured_type_definition
+        tl::optional<Token> const& packed,
+        ArenaPtr<UnpackedStructuredTypeDefinition> unpacked_structured_type_definition
     )
-        : m_packed{ packed }, m_unpacked_structured_type_definition{ std::move(unpacked_structured_type_definition) } {}
-
-    [[nodiscard]] SourceLocation source_location() const override {
-        if (m_packed.has_value()) {
-            return m_packed.value().source_location().join(m_unpacked_structured_type_definition->source_location());
-        }
-        return m_unpacked_structured_type_definition->source_location();
-    }
+        : Type{ packed, *unpacked_structured_type_definition },
+          m_packed{ packed },
+          m_unpacked_structured_type_definition{ unpacked_structured_type_definition } {}
 
     void print(PrintContext& context) const override {
         if (m_packed) {
@@ -196,19 +189,20 @@ public:
 
 class ArrayTypeDefinition final : public UnpackedStructuredTypeDefinition {
 private:
-    Token const* m_array;
-    std::vector<std::unique_ptr<OrdinalType>> m_index_types;
-    std::unique_ptr<Type> m_component_type;
+    std::pmr::vector<ArenaPtr<OrdinalType>> m_index_types;
+    ArenaPtr<Type> m_component_type;
 
 public:
     [[nodiscard]] ArrayTypeDefinition(
-        std::same_as<Token const> auto& array,
-        std::vector<std::unique_ptr<OrdinalType>> index_types,
-        std::unique_ptr<Type> component_type
+        Token const& array,
+        std::pmr::vector<ArenaPtr<OrdinalType>> index_types,
+        ArenaPtr<Type> component_type
     )
-        : m_array{ &array }, m_index_types{ std::move(index_types) }, m_component_type{ std::move(component_type) } {}
+        : UnpackedStructuredTypeDefinition{ array, *component_type },
+          m_index_types{ std::move(index_types) },
+          m_component_type{ component_type } {}
 
-    [[nodiscard]] std::vector<std::unique_ptr<OrdinalType>> const& index_types() const {
+    [[nodiscard]] std::pmr::vector<ArenaPtr<OrdinalType>> const& index_types() const {
         return m_index_types;
     }
 
@@ -216,29 +210,26 @@ public:
         return *m_component_type;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_array->source_location().join(component_type().source_location());
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "ArrayTypeDefinition");
-        auto children = std::vector<AstNode const*>{};
-        for (auto const& index_type : m_index_types) {
-            children.push_back(index_type.get());
-        }
-        children.push_back(m_component_type.get());
-        context.print_children(children);
+        context.print_children(m_index_types.size() + 1, [&](usize const i) {
+            if (i < m_index_types.size()) {
+                m_index_types[i]->print(context);
+            } else {
+                m_component_type->print(context);
+            }
+        });
     }
 };
 
 class RecordSection final : public AstNode {
 private:
     IdentifierList m_identifiers;
-    std::unique_ptr<Type> m_type;
+    ArenaPtr<Type> m_type;
 
 public:
-    [[nodiscard]] explicit RecordSection(IdentifierList identifiers, std::unique_ptr<Type> type)
-        : m_identifiers{ std::move(identifiers) }, m_type{ std::move(type) } {}
+    [[nodiscard]] explicit RecordSection(IdentifierList identifiers, ArenaPtr<Type> type)
+        : AstNode{ identifiers, *type }, m_identifiers{ std::move(identifiers) }, m_type{ type } {}
 
     [[nodiscard]] IdentifierList const& identifiers() const {
         return m_identifiers;
@@ -248,10 +239,6 @@ public:
         return *m_type;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_identifiers.source_location().join(m_type->source_location());
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "RecordSection");
         context.print_children(m_identifiers, *m_type);
@@ -260,24 +247,20 @@ public:
 
 class FixedPart final : public AstNode {
 private:
-    std::vector<RecordSection> m_record_sections;
+    std::pmr::vector<RecordSection> m_record_sections;
 
 public:
-    [[nodiscard]] explicit FixedPart(std::vector<RecordSection> record_sections)
-        : m_record_sections{ std::move(record_sections) } {
-        if (m_record_sections.empty()) {
-            throw InternalCompilerError{ "RecordFixedPart must have at least one record section." };
-        }
-    }
-
-    [[nodiscard]] std::vector<RecordSection> const& record_sections() const {
+    [[nodiscard]] explicit FixedPart(std::pmr::vector<RecordSection> record_sections)
+        : AstNode{
+              expect_not_empty(record_sections, "RecordFixedPart must have at least one record section.").front(),
+              record_sections.back(),
+          },
+          m_record_sections{ std::move(record_sections) } {}
+
+    [[nodiscard]] std::pmr::vector<RecordSection> const& record_sections() const {
         return m_record_sections;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_record_sections.front().source_location().join(m_record_sections.back().source_location());
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "FixedPart");
         context.print_children(m_record_sections);
@@ -287,14 +270,16 @@ public:
 class VariantSelector final : public AstNode {
 private:
     tl::optional<Identifier> m_ordinal_type_identifier;
-    std::unique_ptr<OrdinalType> m_tag_type;  // Identifier of an ordinal type (not checked yet).
+    ArenaPtr<OrdinalType> m_tag_type;  // Identifier of an ordinal type (not checked yet).
 
 public:
     [[nodiscard]] explicit VariantSelector(
         tl::optional<Identifier> ordinal_type_identifier,
-        std::unique_ptr<OrdinalType> tag_type
+        ArenaPtr<OrdinalType> tag_type
     )
-        : m_ordinal_type_identifier{ std::move(ordinal_type_identifier) }, m_tag_type{ std::move(tag_type) } {}
+        : AstNode{ ordinal_type_identifier, *tag_type },
+          m_ordinal_type_identifier{ std::move(ordinal_type_identifier) },
+          m_tag_type{ tag_type } {}
 
     [[nodiscard]] tl::optional<Identifier const&> ordinal_type_identifier() const {
         return m_ordinal_type_identifier.map([](auto const& identifier) -> Identifier const& { return identifier; });
@@ -304,10 +289,6 @@ public:
         return *m_tag_type;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return join_source_locations(ordinal_type_identifier(), tag_type());
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "VariantSelector");
         context.print_children(ordinal_type_identifier(), tag_type());
@@ -316,34 +297,23 @@ public:
 
 class CaseConstantList final : public AstNode {
 private:
-    std::vector<std::unique_ptr<Constant>> m_constants;
+    std::pmr::vector<ArenaPtr<Constant>> m_constants;
 
 public:
-    [[nodiscard]] explicit CaseConstantList(std::vector<std::unique_ptr<Constant>> constants)
-        : m_constants{ std::move(constants) } {
-        if (m_constants.empty()) {
-            throw InternalCompilerError{ "CaseConstantList must have at least one constant." };
-        }
-    }
-
-    [[nodiscard]] std::vector<std::unique_ptr<Constant>> const& constants() const {
+    [[nodiscard]] explicit CaseConstantList(std::pmr::vector<ArenaPtr<Constant>> constants)
+        : AstNode{
+              *expect_not_empty(constants, "CaseConstantList must have at least one constant.").front(),
+              *constants.back(),
+          },
+          m_constants{ std::move(constants) } {}
+
+    [[nodiscard]] std::pmr::vector<ArenaPtr<Constant>> const& constants() const {
         return m_constants;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_constants.front()->source_location().join(m_constants.back()->source_location());
-    }
-
     void print(PrintContext& context) const override {
-        using std::views::transform, std::ranges::to;
         context.print(*this, "CaseConstantList");
-        // clang-format off
-        context.print_children(
-            m_constants
-                | transform([](auto const& constant) { return static_cast<AstNode const*>(constant.get()); })
-                | to<std::vector>()
-        );
-        // clang-format on
+        context.print_children(m_constants.size(), [&](usize const i) { m_constants[i]->print(context); });
     }
 };
 
@@ -353,30 +323,17 @@ class Variant final : public AstNode {
 private:
     CaseConstantList m_case_constant_list;
     // m_field_list is a pointer to avoid recursive type definition.
-    tl::optional<std::unique_ptr<FieldList>> m_field_list;
-    Token const* m_closing_parenthesis;
+    tl::optional<ArenaPtr<FieldList>> m_field_list;
 
 public:
     [[nodiscard]] explicit Variant(
         CaseConstantList case_constant_list,
-        tl::optional<std::unique_ptr<FieldList>> field_list,
-        std::same_as<Token const> auto& closing_parenthesis
+        tl::optional<ArenaPtr<FieldList>> field_list,
+        Token const& closing_parenthesis
     )
-        : m_case_constant_list{ std::move(case_constant_list) },
-          m_field_list{ std::move(field_list) },
-          m_closing_parenthesis{ &closing_parenthesis } {
-        if (m_field_list.has_value() and m_field_list.value() == nullptr) {
-            throw InternalCompilerError{ "FieldList must not be null." };
-        }
-    }
-
-    // Follow rule of five, since we have to define the (defaulted) destructor
-    // in the source file, because of the std::unique_ptr member.
-    Variant(Variant const& other) = delete;
-    Variant(Variant&& other) noexcept = default;
-    Variant& operator=(Variant const& other) = delete;
-    Variant& operator=(Variant&& other) noexcept = default;
-    ~Variant() noexcept override;
+        : AstNode{ case_constant_list, closing_parenthesis },
+          m_case_constant_list{ std::move(case_constant_list) },
+          m_field_list{ field_list } {}
 
     [[nodiscard]] CaseConstantList const& case_constant_list() const {
         return m_case_constant_list;
@@ -386,33 +343,25 @@ public:
         return m_field_list.map([](auto const& field_list) -> FieldList const& { return *field_list; });
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_case_constant_list.source_location().join(m_closing_parenthesis->source_location());
-    }
-
     void print(PrintContext& context) const override;
 };
 
 class VariantList final : public AstNode {
 private:
-    std::vector<Variant> m_variants;
+    std::pmr::vector<Variant> m_variants;
 
 public:
-    [[nodiscard]] explicit VariantList(std::vector<Variant> variants)
-        : m_variants{ std::move(variants) } {
-        if (m_variants.empty()) {
-            throw InternalCompilerError{ "VariantPart must have at least one variant." };
-        }
-    }
-
-    [[nodiscard]] std::vector<Variant> const& variants() const {
+    [[nodiscard]] explicit VariantList(std::pmr::vector<Variant> variants)
+        : AstNode{
+              expect_not_empty(variants, "VariantPart must have at least one variant.").front(),
+              variants.back(),
+          },
+          m_variants{ std::move(variants) } {}
+
+    [[nodiscard]] std::pmr::vector<Variant> const& variants() const {
         return m_variants;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_variants.front().source_location().join(m_variants.back().source_location());
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "VariantList");
         context.print_children(m_variants);
@@ -421,17 +370,16 @@ public:
 
 class VariantPart final : public AstNode {
 private:
-    Token const* m_case;
     VariantSelector m_record_variant_selector;
     VariantList m_variant_list;
 
 public:
     [[nodiscard]] VariantPart(
-        std::same_as<Token const> auto& case_,
+        Token const& case_,
         VariantSelector record_variant_selector,
         VariantList variant_list
     )
-        : m_case{ &case_ },
+        : AstNode{ case_, variant_list },
           m_record_variant_selector{ std::move(record_variant_selector) },
           m_variant_list{ std::move(variant_list) } {}
 
@@ -439,10 +387,6 @@ public:
         return m_record_variant_selector;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_case->source_location().join(m_variant_list.source_location());
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "VariantPart");
         context.print_children(m_record_variant_selector, m_variant_list);
@@ -456,16 +400,14 @@ private:
 
 public:
     [[nodiscard]] explicit FieldList(tl::optional<FixedPart> fixed_part, tl::optional<VariantPart> variant_part)
-        : m_fixed_part{ std::move(fixed_part) }, m_variant_part{ std::move(variant_part) } {}
+        : AstNode{ fixed_part, variant_part },
+          m_fixed_part{ std::move(fixed_part) },
+          m_variant_part{ std::move(variant_part) } {}
 
     [[nodiscard]] tl::optional<FixedPart> const& fixed_part() const {
         return m_fixed_part;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return join_source_locations(m_fixed_part, m_variant_part);
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "FieldList");
         context.print_children(m_fixed_part, m_variant_part);
@@ -481,30 +423,25 @@ inline void Variant::print(PrintContext& context) const {
 
 class RecordTypeDefinition final : public UnpackedStructuredTypeDefinition {
 private:
-    Token const* m_record;
+    Token m_record;
     tl::optional<FieldList> m_field_list;
-    Token const* m_end;
 
 public:
     [[nodiscard]] explicit RecordTypeDefinition(
-        std::same_as<Token const> auto& record,
+        Token const& record,
         tl::optional<FieldList> field_list,
-        std::same_as<Token const> auto& end
+        Token const& end
     )
-        : m_record{ &record }, m_field_list{ std::move(field_list) }, m_end{ &end } {}
+        : UnpackedStructuredTypeDefinition{ record, end }, m_record{ record }, m_field_list{ std::move(field_list) } {}
 
     [[nodiscard]] Token const& record() const {
-        return *m_record;
+        return m_record;
     }
 
     [[nodiscard]] tl::optional<FieldList> const& field_list() const {
         return m_field_list;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_record->source_location().join(m_end->source_location());
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "RecordTypeDefinition");
         context.print_children(m_field_list);
@@ -513,21 +450,16 @@ public:
 
 class SetTypeDefinition final : public UnpackedStructuredTypeDefinition {
 private:
-    Token const* m_set;
-    std::unique_ptr<OrdinalType> m_base_type;
+    ArenaPtr<OrdinalType> m_base_type;
 
 public:
-    [[nodiscard]] explicit SetTypeDefinition(std::same_as<Token const> auto& set, std::unique_ptr<OrdinalType>&& base_type)
-        : m_set{ &set }, m_base_type{ std::move(base_type) } {}
+    [[nodiscard]] explicit SetTypeDefinition(Token const& set, ArenaPtr<OrdinalType> base_type)
+        : UnpackedStructuredTypeDefinition{ set, *base_type }, m_base_type{ base_type } {}
 
     [[nodiscard]] OrdinalType const& base_type() const {
         return *m_base_type;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_set->source_location().join(m_base_type->source_location());
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "SetTypeDefinition");
         context.print_children(*m_base_type);
@@ -536,21 +468,16 @@ public:
 
 class FileTypeDefinition final : public UnpackedStructuredTypeDefinition {
 private:
-    Token const* m_file;
-    std::unique_ptr<Type> m_component_type;
+    ArenaPtr<Type> m_component_type;
 
 public:
-    [[nodiscard]] explicit FileTypeDefinition(std::same_as<Token const> auto& file, std::unique_ptr<Type>&& component_type)
-        : m_file{ &file }, m_component_type{ std::move(component_type) } {}
+    [[nodiscard]] explicit FileTypeDefinition(Token const& file, ArenaPtr<Type> component_type)
+        : UnpackedStructuredTypeDefinition{ file, *component_type }, m_component_type{ component_type } {}
 
     [[nodiscard]] Type const& component_type() const {
         return *m_component_type;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_file->source_location().join(m_component_type->source_location());
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "FileTypeDefinition");
         context.print_children(*m_component_type);
@@ -562,31 +489,23 @@ public:
     using ReferencedType = std::variant<Identifier, IntegerType, RealType, CharType, BooleanType>;
 
 private:
-    Token const* m_up_arrow;
     ReferencedType m_referenced_type;
 
 public:
-    [[nodiscard]] explicit PointerTypeDefinition(
-        std::same_as<Token const> auto& up_arrow,
-        ReferencedType const& referenced_type
-    )
-        : m_up_arrow{ &up_arrow }, m_referenced_type{ referenced_type } {}
+    [[nodiscard]] explicit PointerTypeDefinition(Token const& up_arrow, ReferencedType const& referenced_type)
+        : UnpackedStructuredTypeDefinition{ up_arrow, node(referenced_type) }, m_referenced_type{ referenced_type } {}
 
     [[nodiscard]] ReferencedType const& referenced_type() const {
         return m_referenced_type;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_up_arrow->source_location().join(
-            std::visit([](auto const& type) -> SourceLocation { return type.source_location(); }, m_referenced_type)
-        );
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "PointerTypeDefinition");
-        context.print_children(std::visit(
-            [](auto const& type) -> AstNode const& { return type; },
-            m_referenced_type
-        ));
+        context.print_children(node(m_referenced_type));
+    }
+
+private:
+    [[nodiscard]] static AstNode const& node(ReferencedType const& referenced_type) {
+        return std::visit([](auto const& type) -> AstNode const& { return type; }, referenced_type);
     }
 };
@@ -1,44 +1,28 @@
 #pragma once
 
 #include <lexer/token.hpp>
-#include <memory>
 #include <vector>
 #include "ast_node.hpp"
 #include "type_definition.hpp"
 
 class TypeDefinitions final : public AstNode {
 private:
-    Token const* m_type_token;
-    std::vector<TypeDefinition> m_type_definitions;
+    std::pmr::vector<TypeDefinition> m_type_definitions;
 
 public:
     [[nodiscard]] explicit TypeDefinitions(
-        std::same_as<Token const> auto& type_token,
-        std::vector<TypeDefinition> type_definitions
+        Token const& type_token,
+        std::pmr::vector<TypeDefinition> type_definitions
     )
-        : m_type_token{ &type_token }, m_type_definitions{ std::move(type_definitions) } {
-        if (m_type_definitions.empty()) {
-            throw InternalCompilerError{ "Empty type definitions." };
-        }
-    }
+        : AstNode{ type_token, expect_not_empty(type_definitions, "Empty type definitions.").back() },
+          m_type_definitions{ std::move(type_definitions) } {}
 
-    [[nodiscard]] std::vector<TypeDefinition> const& type_definitions() const {
+    [[nodiscard]] std::pmr::vector<TypeDefinition> const& type_definitions() const {
         return m_type_definitions;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_type_token->source_location().join(m_type_definitions.back().source_location());
-    }
-
     void print(PrintContext& context) const override {
-        using std::views::transform, std::ranges::to;
         context.print(*this, "TypeDefinitions");
-        // clang-format off
-        context.print_children(
-            m_type_definitions
-            | transform([](auto const& e) { return static_cast<AstNode const*>(&e); })
-            | to<std::vector>()
-        );
-        // clang-format on
+        context.print_children(m_type_definitions);
     }
 };
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <memory>
+#include "arena.hpp"
 #include "ast_node.hpp"
 #include "identifier_list.hpp"
 #include "type_definition.hpp"
@@ -8,11 +8,11 @@
 class VariableDeclaration final : public AstNode {
 private:
     IdentifierList m_identifiers;
-    std::unique_ptr<Type> m_type;
+    ArenaPtr<Type> m_type;
 
 public:
-    [[nodiscard]] explicit VariableDeclaration(IdentifierList&& identifiers, std::unique_ptr<Type>&& type)
-        : m_identifiers{ std::move(identifiers) }, m_type{ std::move(type) } {}
+    [[nodiscard]] explicit VariableDeclaration(IdentifierList&& identifiers, ArenaPtr<Type> type)
+        : AstNode{ identifiers, *type }, m_identifiers{ std::move(identifiers) }, m_type{ type } {}
 
     [[nodiscard]] IdentifierList const& identifiers() const {
         return m_identifiers;
@@ -22,10 +22,6 @@ public:
         return *m_type;
     }
 
-    [[nodiscard]] SourceLocation source_location() const override {
-        return m_identifiers.source_location().join(m_type->source_location());
-    }
-
     void print(PrintContext& context) const override {
         context.print(*this, "VariableDeclaration");
         context.print_children(m_identifiers, *m_type);
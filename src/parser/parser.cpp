@@ -1,41 +1,133 @@
+#include <array>
+#include <cstddef>
+#include <lexer/lexer_error.hpp>
 #include <lib2k/defer.hpp>
 #include <lib2k/string_utils.hpp>
 #include <lib2k/types.hpp>
-#include <parser/constant_definition.hpp>
+#include <limits>
+#include <memory_resource>
 #include <parser/parser.hpp>
 #include <parser/parser_note.hpp>
-#include <parser/type_definition.hpp>
-#include <parser/variable_declarations.hpp>
 #include <tl/optional.hpp>
+#include "ast_builder.hpp"
+#include "flat_ast_builder.hpp"
 
-class Parser final {
+// Provides the same interface as `TokenStream` for tokens that have already been lexed completely.
+class BufferedTokens final {
 private:
-    std::vector<Token> m_tokens;
+    TokenBuffer m_tokens;
     usize m_index = 0;
-    std::vector<ParserNote> m_notes_stack;
 
 public:
-    [[nodiscard]] explicit Parser(std::vector<Token>&& tokens)
+    [[nodiscard]] explicit BufferedTokens(TokenBuffer&& tokens)
         : m_tokens{ std::move(tokens) } {
         assert(not m_tokens.empty());
         assert(m_tokens.back().type() == TokenType::EndOfFile);
     }
 
-    [[nodiscard]] Ast parse() & = delete;
+    [[nodiscard]] std::shared_ptr<SourceFile const> const& file() const {
+        return m_tokens.file();
+    }
+
+    [[nodiscard]] std::shared_ptr<Interner> const& interner() const {
+        return m_tokens.interner();
+    }
+
+    [[nodiscard]] Token peek_or_end(usize const offset = 0) const {
+        return m_tokens[std::min(m_index + offset, m_tokens.size() - 1)];
+    }
+
+    void advance() {
+        if (m_tokens.type(m_index) != TokenType::EndOfFile) {
+            ++m_index;
+        }
+    }
+
+    // The tokens have been lexed successfully.
+    [[nodiscard]] tl::optional<Diagnostic> error() const {
+        return tl::nullopt;
+    }
+};
+
+// Errors are reported into a `Diagnostics` buffer instead of being thrown. After an error, the parser panics: It
+// continues without consuming any more tokens, so the current token is the end of file token, `match()` fails, and
+// `expect()` returns a placeholder token of the expected type. This way, every function returns quickly without
+// unwinding the stack. Errors are not reported while panicking.
+//
+// The parser stops after `max_errors` errors, and the placeholder nodes are discarded together with the AST. Otherwise,
+// it recovers at the end of the enclosing type or constant, or of the enclosing definition or declaration: It skips
+// to the next token that this construct can end at (see `skip_to_synchronizing_token()`), and stops panicking. A type
+// or constant that contains an error is replaced by an error node, which spans the tokens consumed for it.
+//
+// The nodes are created by the `Builder`, which is either an `AstBuilder` or a `FlatAstBuilder`. `Node<T>` is the type
+// that the builder uses for the node class `T` of the pointer-based AST, and `List<T>` the type for a list of them.
+// Lists always start with their first element.
+template<typename Tokens, typename Builder>
+class Parser final {
+private:
+    template<typename T>
+    using Node = typename Builder::template Node<T>;
+
+    // Notes are only nested as deeply as the declarations they describe. Up to this depth, the stack lives within the
+    // parser, so that entering a scope never allocates.
+    static constexpr auto inline_notes_capacity = usize{ 8 };
+
+    Tokens m_tokens;
+    Diagnostics& m_diagnostics;
+    usize m_max_errors;
+    usize m_num_errors = 0;
+    bool m_panicking = false;
+    bool m_stopped = false;       // After a lexer error, or after `m_max_errors` errors.
+    bool m_made_progress = true;  // Whether a token has been consumed since recovering from the last error.
+    u32 m_end_of_previous = 0;    // The end of the last token that has been consumed.
+    alignas(DiagnosticNote) std::array<std::byte, inline_notes_capacity * sizeof(DiagnosticNote)> m_notes_buffer;
+    std::pmr::monotonic_buffer_resource m_notes_resource{ m_notes_buffer.data(), m_notes_buffer.size() };
+    std::pmr::vector<DiagnosticNote> m_notes_stack{ &m_notes_resource };
+    tl::optional<DiagnosticId> m_error;
+    Builder m_builder;
+
+public:
+    [[nodiscard]] explicit Parser(Tokens&& tokens, Diagnostics& diagnostics, usize const max_errors)
+        : m_tokens{ std::move(tokens) }, m_diagnostics{ diagnostics }, m_max_errors{ max_errors } {
+        assert(max_errors > 0);
+        m_notes_stack.reserve(inline_notes_capacity);
+    }
 
-    [[nodiscard]] Ast parse() && {
-        auto block = this->block();
+    [[nodiscard]] std::expected<typename Builder::Result, DiagnosticId> parse() & = delete;
+
+    [[nodiscard]] std::expected<typename Builder::Result, DiagnosticId> parse() && {
+        auto const block = this->block();
+        expect(TokenType::EndOfFile, "Expected end of file.");
+        if (m_error.has_value()) {
+            return std::unexpected{ *m_error };
+        }
+        return m_builder.finish(m_tokens.file(), m_tokens.interner(), block);
+    }
+
+    // Returns the AST even if there have been errors.
+    [[nodiscard]] typename Builder::Result parse_with_recovery() && {
+        auto const block = this->block();
         expect(TokenType::EndOfFile, "Expected end of file.");
-        return Ast{ std::move(m_tokens), std::move(block) };
+        return m_builder.finish(m_tokens.file(), m_tokens.interner(), block);
     }
 
 private:
-    [[nodiscard]] auto scoped_note(SourceLocation const& location, std::string message) {
-        m_notes_stack.emplace_back(location, std::move(message));
+    [[nodiscard]] LiteralPool const& literals() const {
+        return m_tokens.interner()->literals();
+    }
+
+    // See `DiagnosticNote` for the meaning of `message` and `argument`. The message is only formatted if an error is
+    // reported within the scope.
+    [[nodiscard]] auto scoped_note(
+        SourceLocation const& location,
+        std::string_view const message,
+        std::string_view const argument = {}
+    ) {
+        m_notes_stack.emplace_back(location, message, argument);
         return c2k::Defer([this] { m_notes_stack.pop_back(); });
     }
 
-    [[nodiscard]] Block block() {
+    [[nodiscard]] Node<Block> block() {
         auto label_declarations =
             current_is(TokenType::Label) ? tl::optional{ this->label_declarations() } : tl::nullopt;
         auto constant_definitions =
@@ -43,64 +135,73 @@ private:
         auto type_definitions = current_is(TokenType::Type) ? tl::optional{ this->type_definitions() } : tl::nullopt;
         auto variable_declarations =
             current_is(TokenType::Var) ? tl::optional{ this->variable_declarations() } : tl::nullopt;
-        return Block{
+        return m_builder.block(
             std::move(label_declarations),
             std::move(constant_definitions),
             std::move(type_definitions),
-            std::move(variable_declarations),
-        };
+            std::move(variable_declarations)
+        );
     }
 
-    [[nodiscard]] LabelDeclarations label_declarations() {
-        auto const& label_token = expect(TokenType::Label, "Expected label.");
+    [[nodiscard]] Node<LabelDeclarations> label_declarations() {
+        auto const label_token = expect(TokenType::Label, "Expected label.");
 
         auto const _ = scoped_note(label_token.source_location(), "In label declarations starting from here.");
 
-        auto declarations = std::vector<LabelDeclaration>{};
-        declarations.push_back(label());
+        auto declarations = m_builder.list(label());
         while (match(TokenType::Comma)) {
-            declarations.push_back(label());
+            m_builder.append(declarations, label());
         }
-        expect(TokenType::Semicolon, "Expected semicolon after label declarations.");
-        return LabelDeclarations{ label_token, declarations };
+        expect_semicolon("Expected semicolon after label declarations.");
+        return m_builder.label_declarations(label_token, std::move(declarations));
     }
 
-    [[nodiscard]] LabelDeclaration label() {
+    [[nodiscard]] Node<LabelDeclaration> label() {
         // 6.1.6
-        auto const& token = expect(TokenType::IntegerNumber, "Expected label.");
-        if (not std::isdigit(static_cast<unsigned char>(token.lexeme().at(0)))) {
-            throw_parser_error("Expected label", token.source_location());
+        auto const token = expect(TokenType::IntegerNumber, "Expected label.");
+        if (not m_panicking and not std::isdigit(static_cast<unsigned char>(token.lexeme().at(0)))) {
+            report_error("Expected label", token.source_location());
         }
-        return LabelDeclaration{ IntegerLiteral{ token } };
+        return m_builder.label_declaration(integer_literal(token));
     }
 
-    [[nodiscard]] ConstantDefinitions constant_definitions() {
-        auto const& const_token = expect(TokenType::Const, "Expected const.");
+    [[nodiscard]] Node<ConstantDefinitions> constant_definitions() {
+        auto const const_token = expect(TokenType::Const, "Expected const.");
         auto const _ = scoped_note(const_token.source_location(), "In constant definitions starting from here.");
 
-        auto definitions = std::vector<ConstantDefinition>{};
-        definitions.push_back(constant_definition());
-        expect(TokenType::Semicolon, "Expected semicolon after constant definition.");
+        auto definitions = m_builder.list(constant_definition());
+        expect_semicolon("Expected semicolon after constant definition.");
         while (current_is(TokenType::Identifier)) {
-            definitions.push_back(constant_definition());
-            expect(TokenType::Semicolon, "Expected semicolon after constant definition.");
+            m_builder.append(definitions, constant_definition());
+            expect_semicolon("Expected semicolon after constant definition.");
         }
-        return ConstantDefinitions{ const_token, std::move(definitions) };
+        return m_builder.constant_definitions(const_token, std::move(definitions));
     }
 
-    [[nodiscard]] ConstantDefinition constant_definition() {
-        auto const& identifier = expect(TokenType::Identifier, "Expected identifier in constant definition.");
+    [[nodiscard]] Node<ConstantDefinition> constant_definition() {
+        auto const identifier =
+            m_builder.identifier(expect(TokenType::Identifier, "Expected identifier in constant definition."));
         expect(TokenType::Equals, "Expected equals sign in constant definition.");
-        return ConstantDefinition{ Identifier{ identifier }, constant() };
+        auto constant = this->constant();
+        return m_builder.constant_definition(identifier, std::move(constant));
+    }
+
+    [[nodiscard]] Node<Constant> constant() {
+        auto const start = position();
+        auto constant = unrecovered_constant();
+        if (auto const span = recover(start)) {
+            return m_builder.error_constant(std::move(constant), *m_tokens.file(), *span);
+        }
+        return constant;
     }
 
-    [[nodiscard]] std::unique_ptr<Constant> constant() {
-        auto const sign = [&]() -> tl::optional<Token const&> {
+    [[nodiscard]] Node<Constant> unrecovered_constant() {
+        auto const sign = [&]() -> tl::optional<Token> {
             if (auto const plus_token = match(TokenType::Plus)) {
-                return plus_token.value();
+                return *plus_token;
             }
             if (auto const minus_token = match(TokenType::Minus)) {
-                return minus_token.value();
+                return *minus_token;
             }
             return tl::nullopt;
         }();
@@ -113,59 +214,69 @@ private:
             and not current_is(TokenType::Identifier)
         ) {
             // clang-format on
-            throw_parser_error(
+            report_error(
                 "Expected integer, real, or identifier after sign in constant definition.",
                 current().source_location()
             );
         }
 
         if (auto const integer_token = match(TokenType::IntegerNumber)) {
-            return std::make_unique<IntegerConstant>(sign, IntegerLiteral{ integer_token.value() });
+            return m_builder.integer_constant(sign, integer_literal(*integer_token));
         }
         if (auto const real_token = match(TokenType::RealNumber)) {
-            return std::make_unique<RealConstant>(sign, RealLiteral{ real_token.value() });
+            return m_builder.real_constant(sign, real_literal(*real_token));
         }
         if (auto const identifier_token = match(TokenType::Identifier)) {
-            return std::make_unique<ConstantReference>(sign, identifier_token.value());
+            return m_builder.constant_reference(sign, *identifier_token);
         }
 
         if (auto const char_token = match(TokenType::CharValue)) {
-            return std::make_unique<CharConstant>(CharLiteral{ char_token.value() });
+            return m_builder.char_constant(*char_token, literals());
         }
         if (auto const string_token = match(TokenType::StringValue)) {
-            return std::make_unique<StringConstant>(StringLiteral{ string_token.value() });
+            return m_builder.string_constant(*string_token, literals());
         }
 
-        throw_parser_error("Expected constant value in constant definition.", current().source_location());
+        report_error("Expected constant value in constant definition.", current().source_location());
+        return m_builder.constant_reference(tl::nullopt, placeholder(TokenType::Identifier));
     }
 
-    [[nodiscard]] TypeDefinitions type_definitions() {
-        auto const& type_token = expect(TokenType::Type, "Expected `type`.");
+    [[nodiscard]] Node<TypeDefinitions> type_definitions() {
+        auto const type_token = expect(TokenType::Type, "Expected `type`.");
 
         auto const _ = scoped_note(type_token.source_location(), "In type definitions starting from here.");
 
-        auto definitions = std::vector<TypeDefinition>{};
-        definitions.push_back(type_definition());
-        expect(TokenType::Semicolon, "Expected semicolon after type definition.");
+        auto definitions = m_builder.list(type_definition());
+        expect_semicolon("Expected semicolon after type definition.");
         while (current_is(TokenType::Identifier)) {
-            definitions.push_back(type_definition());
-            expect(TokenType::Semicolon, "Expected semicolon after type definition.");
+            m_builder.append(definitions, type_definition());
+            expect_semicolon("Expected semicolon after type definition.");
         }
-        return TypeDefinitions{ type_token, std::move(definitions) };
+        return m_builder.type_definitions(type_token, std::move(definitions));
     }
 
-    [[nodiscard]] TypeDefinition type_definition() {
-        auto const& identifier = expect(TokenType::Identifier, "Expected identifier in type definition.");
+    [[nodiscard]] Node<TypeDefinition> type_definition() {
+        auto const identifier = expect(TokenType::Identifier, "Expected identifier in type definition.");
 
-        auto const _ =
-            scoped_note(identifier.source_location(), std::format("In type definition of `{}`.", identifier.lexeme()));
+        auto const _ = scoped_note(identifier.source_location(), "In type definition of `{}`.", identifier.lexeme());
 
         expect(TokenType::Equals, "Expected equals sign in type definition.");
 
-        return TypeDefinition{ Identifier{ identifier }, type() };
+        auto const identifier_node = m_builder.identifier(identifier);
+        auto type = this->type();
+        return m_builder.type_definition(identifier_node, std::move(type));
     }
 
-    [[nodiscard]] std::unique_ptr<Type> type() {
+    [[nodiscard]] Node<Type> type() {
+        auto const start = position();
+        auto type = unrecovered_type();
+        if (auto const span = recover(start)) {
+            return m_builder.error_type(std::move(type), *m_tokens.file(), *span);
+        }
+        return type;
+    }
+
+    [[nodiscard]] Node<Type> unrecovered_type() {
         // clang-format off
         if (
             current_is_any_of(
@@ -176,227 +287,212 @@ private:
                 TokenType::Packed
             )
         ) {
-            return std::make_unique<StructuredTypeDefinition>(structured_type_definition());
+            return structured_type_definition();
         }
         // clang-format on
 
         if (auto const up_arrow_token = match(TokenType::UpArrow)) {
-            return std::make_unique<PointerTypeDefinition>(pointer_type(up_arrow_token.value()));
+            return pointer_type(*up_arrow_token);
         }
 
         if (auto const real_token = match(TokenType::Real)) {
-            return std::make_unique<RealType>(real_token.value());
+            return m_builder.real_type(*real_token);
         }
         return ordinal_type();
     }
 
-    [[nodiscard]] PointerTypeDefinition pointer_type(std::same_as<Token const> auto& up_arrow_token) {
-        if (auto const identifier = match(TokenType::Identifier)) {
-            return PointerTypeDefinition{ up_arrow_token, Identifier{ identifier.value() } };
-        }
-        if (auto const integer = match(TokenType::Integer)) {
-            return PointerTypeDefinition{ up_arrow_token, IntegerType{ integer.value() } };
-        }
-        if (auto const real = match(TokenType::Real)) {
-            return PointerTypeDefinition{ up_arrow_token, RealType{ real.value() } };
-        }
-        if (auto const char_ = match(TokenType::Char)) {
-            return PointerTypeDefinition{ up_arrow_token, CharType{ char_.value() } };
-        }
-        if (auto const boolean = match(TokenType::Boolean)) {
-            return PointerTypeDefinition{ up_arrow_token, BooleanType{ boolean.value() } };
+    [[nodiscard]] Node<Type> pointer_type(Token const& up_arrow_token) {
+        // clang-format off
+        if (
+            current_is_any_of(
+                TokenType::Identifier,
+                TokenType::Integer,
+                TokenType::Real,
+                TokenType::Char,
+                TokenType::Boolean
+            )
+        ) {
+            // clang-format on
+            auto const referenced_type = consume();
+            return m_builder.pointer_type_definition(up_arrow_token, referenced_type);
         }
 
-        throw ParserError{ "Expected type reference after `^`.", up_arrow_token.source_location() };
+        report_error("Expected type reference after `^`.", up_arrow_token.source_location());
+        return m_builder.pointer_type_definition(up_arrow_token, placeholder(TokenType::Identifier));
     }
 
-    [[nodiscard]] StructuredTypeDefinition structured_type_definition() {
+    [[nodiscard]] Node<Type> structured_type_definition() {
         auto const packed = match(TokenType::Packed);
-        return StructuredTypeDefinition{ packed, unpacked_structured_type_definition() };
+        auto unpacked_structured_type_definition = this->unpacked_structured_type_definition();
+        return m_builder.structured_type_definition(packed, std::move(unpacked_structured_type_definition));
     }
 
-    [[nodiscard]] std::unique_ptr<UnpackedStructuredTypeDefinition> unpacked_structured_type_definition() {
+    [[nodiscard]] Node<UnpackedStructuredTypeDefinition> unpacked_structured_type_definition() {
         if (auto const array = match(TokenType::Array)) {
-            return std::make_unique<ArrayTypeDefinition>(array_type_definition(array.value()));
+            return array_type_definition(*array);
         }
         if (auto const record = match(TokenType::Record)) {
-            return std::make_unique<RecordTypeDefinition>(record_type_definition(record.value()));
+            return record_type_definition(*record);
         }
         if (auto const set = match(TokenType::Set)) {
-            return std::make_unique<SetTypeDefinition>(set_type_definition(set.value()));
+            return set_type_definition(*set);
         }
         if (auto const file = match(TokenType::File)) {
-            return std::make_unique<FileTypeDefinition>(file_type_definition(file.value()));
+            return file_type_definition(*file);
         }
         // TODO: File types.
         // TODO: Pointer types.
-        throw_parser_error("Expected structured type definition.", current().source_location());
+        report_error("Expected structured type definition.", current().source_location());
+        return set_type_definition(placeholder(TokenType::Set));
     }
 
-    [[nodiscard]] ArrayTypeDefinition array_type_definition(Token const& array_token) {
+    [[nodiscard]] Node<UnpackedStructuredTypeDefinition> array_type_definition(Token const& array_token) {
         expect(TokenType::LeftSquareBracket, "Expected `[` in array type definition.");
-        auto index_types = std::vector<std::unique_ptr<OrdinalType>>{};
-        index_types.push_back(ordinal_type());
+        auto index_types = m_builder.list(ordinal_type());
         while (match(TokenType::Comma)) {
-            index_types.push_back(ordinal_type());
+            m_builder.append(index_types, ordinal_type());
         }
         expect(TokenType::RightSquareBracket, "Expected `]` in array type definition.");
         expect(TokenType::Of, "Expected `of` in array type definition.");
         auto element_type = type();
-        return ArrayTypeDefinition{ array_token, std::move(index_types), std::move(element_type) };
+        return m_builder.array_type_definition(array_token, std::move(index_types), std::move(element_type));
     }
 
-    [[nodiscard]] RecordTypeDefinition record_type_definition(Token const& record_token) {
+    [[nodiscard]] Node<UnpackedStructuredTypeDefinition> record_type_definition(Token const& record_token) {
         if (auto const end = match(TokenType::End)) {
-            return RecordTypeDefinition{ record_token, tl::nullopt, end.value() };
+            return m_builder.record_type_definition(record_token, tl::nullopt, *end);
         }
 
         auto field_list = this->field_list();
-        auto const& end = expect(TokenType::End, "Expected `end`.");
-        return RecordTypeDefinition{
-            record_token,
-            std::move(field_list),
-            end,
-        };
+        auto const end = expect(TokenType::End, "Expected `end`.");
+        return m_builder.record_type_definition(record_token, std::move(field_list), end);
     }
 
-    [[nodiscard]] SetTypeDefinition set_type_definition(std::same_as<Token const> auto& set_token) {
+    [[nodiscard]] Node<UnpackedStructuredTypeDefinition> set_type_definition(Token const& set_token) {
         expect(TokenType::Of, "Expected `of` in set type definition.");
         auto base_type = ordinal_type();
-        return SetTypeDefinition{ set_token, std::move(base_type) };
+        return m_builder.set_type_definition(set_token, std::move(base_type));
     }
 
-    [[nodiscard]] FileTypeDefinition file_type_definition(std::same_as<Token const> auto& file_token) {
+    [[nodiscard]] Node<UnpackedStructuredTypeDefinition> file_type_definition(Token const& file_token) {
         expect(TokenType::Of, "Expected `of` in file type definition.");
         auto component_type = type();
-        return FileTypeDefinition{ file_token, std::move(component_type) };
+        return m_builder.file_type_definition(file_token, std::move(component_type));
     }
 
-    [[nodiscard]] VariableDeclarations variable_declarations() {
-        auto const& var_token = expect(TokenType::Var, "Expected `var`.");
-        auto declarations = std::vector<VariableDeclaration>{};
-        declarations.push_back(this->variable_declaration());
-        expect(TokenType::Semicolon, "Expected `;`.");
+    [[nodiscard]] Node<VariableDeclarations> variable_declarations() {
+        auto const var_token = expect(TokenType::Var, "Expected `var`.");
+        auto declarations = m_builder.list(this->variable_declaration());
+        expect_semicolon("Expected `;`.");
 
         while (current_is(TokenType::Identifier)) {
-            declarations.push_back(this->variable_declaration());
-            expect(TokenType::Semicolon, "Expected `;`.");
+            m_builder.append(declarations, this->variable_declaration());
+            expect_semicolon("Expected `;`.");
         }
 
-        return VariableDeclarations{ var_token, std::move(declarations) };
+        return m_builder.variable_declarations(var_token, std::move(declarations));
     }
 
-    [[nodiscard]] VariableDeclaration variable_declaration() {
+    [[nodiscard]] Node<VariableDeclaration> variable_declaration() {
         auto identifiers = identifier_list();
         expect(TokenType::Colon, "Expected `:`.");
         auto type = this->type();
-        return VariableDeclaration{ std::move(identifiers), std::move(type) };
+        return m_builder.variable_declaration(std::move(identifiers), std::move(type));
     }
 
-    [[nodiscard]] FieldList field_list() {
-        auto fixed_part = tl::optional<FixedPart>{};
-        auto variant_part = tl::optional<VariantPart>{};
+    [[nodiscard]] Node<FieldList> field_list() {
+        auto fixed_part = tl::optional<Node<FixedPart>>{};
+        auto variant_part = tl::optional<Node<VariantPart>>{};
 
         if (current_is(TokenType::Identifier)) {
             fixed_part = record_fixed_part();
             if (continues_with(TokenType::Semicolon, TokenType::Case)) {
                 expect(TokenType::Semicolon, "Expected `;`.");  // Should never fail.
-                auto const& case_ = expect(TokenType::Case, "Expected `case`.");  // Should never fail.
+                auto const case_ = expect(TokenType::Case, "Expected `case`.");  // Should never fail.
                 variant_part = this->variant_part(case_);
             }
         } else if (auto const case_ = match(TokenType::Case)) {
-            variant_part = this->variant_part(case_.value());
+            variant_part = this->variant_part(*case_);
         } else {
-            throw_parser_error("Expected field list.", current().source_location());
+            report_error("Expected field list.", current().source_location());
         }
 
         std::ignore = match(TokenType::Semicolon);
 
-        return FieldList{ std::move(fixed_part), std::move(variant_part) };
+        return m_builder.field_list(std::move(fixed_part), std::move(variant_part));
     }
 
-    [[nodiscard]] VariantPart variant_part(std::same_as<Token const> auto& case_token) {
+    [[nodiscard]] Node<VariantPart> variant_part(Token const& case_token) {
         auto variant_selector = this->variant_selector();
         expect(TokenType::Of, "Expected `of`.");
         auto variant_list = this->variant_list();
-        return VariantPart{ case_token, std::move(variant_selector), std::move(variant_list) };
+        return m_builder.variant_part(case_token, std::move(variant_selector), std::move(variant_list));
     }
 
-    [[nodiscard]] VariantSelector variant_selector() {
-        auto tag_field = tl::optional<Identifier>{};
+    [[nodiscard]] Node<VariantSelector> variant_selector() {
+        auto tag_field = tl::optional<Node<Identifier>>{};
         if (continues_with(TokenType::Identifier, TokenType::Colon)) {
             // The next two lines should never fail.
-            tag_field.emplace(expect(TokenType::Identifier, "Expected identifier."));
+            tag_field = m_builder.identifier(expect(TokenType::Identifier, "Expected identifier."));
             expect(TokenType::Colon, "Expected `:`.");
         }
         auto tag_type = ordinal_type();
-        return VariantSelector{ std::move(tag_field), std::move(tag_type) };
+        return m_builder.variant_selector(tag_field, std::move(tag_type));
     }
 
-    [[nodiscard]] VariantList variant_list() {
-        auto list = std::vector<Variant>{};
-        list.push_back(variant());
+    [[nodiscard]] Node<VariantList> variant_list() {
+        auto list = m_builder.list(variant());
         while (match(TokenType::Semicolon) and current_is_none_of(TokenType::End, TokenType::RightParenthesis)) {
-            list.push_back(variant());
+            m_builder.append(list, variant());
         }
-        return VariantList{ std::move(list) };
+        return m_builder.variant_list(std::move(list));
     }
 
-    [[nodiscard]] Variant variant() {
+    [[nodiscard]] Node<Variant> variant() {
         auto case_constant_list = this->case_constant_list();
         expect(TokenType::Colon, "Expected `:`.");
         expect(TokenType::LeftParenthesis, "Expected `(`.");
-        if (auto const& closing_parenthesis = match(TokenType::RightParenthesis)) {
-            return Variant{
-                std::move(case_constant_list),
-                tl::nullopt,
-                closing_parenthesis.value(),
-            };
+        if (auto const closing_parenthesis = match(TokenType::RightParenthesis)) {
+            return m_builder.variant(std::move(case_constant_list), tl::nullopt, *closing_parenthesis);
         }
         auto field_list = this->field_list();
-        auto const& closing_parenthesis = expect(TokenType::RightParenthesis, "Expected `)`.");
-        return Variant{
-            std::move(case_constant_list),
-            std::make_unique<FieldList>(std::move(field_list)),
-            closing_parenthesis,
-        };
+        auto const closing_parenthesis = expect(TokenType::RightParenthesis, "Expected `)`.");
+        return m_builder.variant(std::move(case_constant_list), std::move(field_list), closing_parenthesis);
     }
 
-    [[nodiscard]] CaseConstantList case_constant_list() {
-        auto constants = std::vector<std::unique_ptr<Constant>>{};
-        constants.push_back(constant());
+    [[nodiscard]] Node<CaseConstantList> case_constant_list() {
+        auto constants = m_builder.list(constant());
         while (match(TokenType::Comma)) {
-            constants.push_back(constant());
+            m_builder.append(constants, constant());
         }
-        return CaseConstantList{ std::move(constants) };
+        return m_builder.case_constant_list(std::move(constants));
     }
 
-    [[nodiscard]] FixedPart record_fixed_part() {
-        auto record_sections = std::vector<RecordSection>{};
-        record_sections.push_back(record_section());
+    [[nodiscard]] Node<FixedPart> record_fixed_part() {
+        auto record_sections = m_builder.list(record_section());
         while (continues_with(TokenType::Semicolon, TokenType::Identifier)) {
             std::ignore = match(TokenType::Semicolon);
-            record_sections.push_back(record_section());
+            m_builder.append(record_sections, record_section());
         }
-        return FixedPart{ std::move(record_sections) };
+        return m_builder.fixed_part(std::move(record_sections));
     }
 
-    [[nodiscard]] RecordSection record_section() {
+    [[nodiscard]] Node<RecordSection> record_section() {
         auto identifiers = identifier_list();
         expect(TokenType::Colon, "Expected `:` in record section.");
         auto type = this->type();
-        return RecordSection{ std::move(identifiers), std::move(type) };
+        return m_builder.record_section(std::move(identifiers), std::move(type));
     }
 
-    [[nodiscard]] std::unique_ptr<OrdinalType> ordinal_type() {
+    [[nodiscard]] Node<OrdinalType> ordinal_type() {
         if (auto const boolean_token = match(TokenType::Boolean)) {
-            return std::make_unique<BooleanType>(boolean_token.value());
+            return m_builder.boolean_type(*boolean_token);
         }
         if (auto const char_token = match(TokenType::Char)) {
-            return std::make_unique<CharType>(char_token.value());
+            return m_builder.char_type(*char_token);
         }
         if (auto const integer_token = match(TokenType::Integer)) {
-            return std::make_unique<IntegerType>(integer_token.value());
+            return m_builder.integer_type(*integer_token);
         }
 
         if (current_is(TokenType::LeftParenthesis)) {
@@ -408,17 +504,17 @@ private:
             or continues_with(TokenType::Identifier, TokenType::DotDot);
 
         if (is_subrange_type) {
-            return std::make_unique<SubrangeTypeDefinition>(subrange_type());
+            return subrange_type();
         }
 
         // We don't really know whether a type alias is an ordinal type. This will be
         // resolved during semantic analysis. For now, we treat it as an ordinal type.
-        return std::make_unique<TypeAliasDefinition>(Identifier{
-            expect(TokenType::Identifier, "Expected identifier in type definition."),
-        });
+        return m_builder.type_alias_definition(
+            m_builder.identifier(expect(TokenType::Identifier, "Expected identifier in type definition."))
+        );
     }
 
-    [[nodiscard]] SubrangeTypeDefinition subrange_type() {
+    [[nodiscard]] Node<OrdinalType> subrange_type() {
         // clang-format off
         if (
             current_is_any_of(TokenType::Plus, TokenType::Minus, TokenType::CharValue, TokenType::IntegerNumber)
@@ -428,61 +524,92 @@ private:
             auto from = constant();
             expect(TokenType::DotDot, "Expected `..` in subrange type definition.");
             auto to = constant();
-            return SubrangeTypeDefinition(std::move(from), std::move(to));
+            return m_builder.subrange_type_definition(std::move(from), std::move(to));
         }
 
-        throw_parser_error("Expected type definition.", current().source_location());
+        report_error("Expected type definition.", current().source_location());
+        auto from = constant();
+        auto to = constant();
+        return m_builder.subrange_type_definition(std::move(from), std::move(to));
     }
 
-    [[nodiscard]] std::unique_ptr<EnumeratedTypeDefinition> enumerated_type_definition() {
-        auto const& left_parenthesis = expect(TokenType::LeftParenthesis, "Expected `(` in enumerated type definition.");
+    [[nodiscard]] Node<OrdinalType> enumerated_type_definition() {
+        auto const left_parenthesis = expect(TokenType::LeftParenthesis, "Expected `(` in enumerated type definition.");
         auto identifiers = identifier_list();
-        auto const& right_parenthesis =
+        auto const right_parenthesis =
             expect(TokenType::RightParenthesis, "Expected `)` in enumerated type definition.");
-        return std::make_unique<EnumeratedTypeDefinition>(left_parenthesis, std::move(identifiers), right_parenthesis);
+        return m_builder.enumerated_type_definition(left_parenthesis, std::move(identifiers), right_parenthesis);
     }
 
-    [[nodiscard]] IdentifierList identifier_list() {
-        auto identifiers = std::vector<Identifier>{};
-        identifiers.emplace_back(expect(TokenType::Identifier, "Expected identifier."));
+    [[nodiscard]] Node<IdentifierList> identifier_list() {
+        auto identifiers = m_builder.list(m_builder.identifier(expect(TokenType::Identifier, "Expected identifier.")));
         while (match(TokenType::Comma)) {
-            identifiers.emplace_back(expect(TokenType::Identifier, "Expected identifier."));
+            m_builder.append(identifiers, m_builder.identifier(expect(TokenType::Identifier, "Expected identifier.")));
         }
-        return IdentifierList{ std::move(identifiers) };
+        return m_builder.identifier_list(std::move(identifiers));
     }
 
-    [[nodiscard]] bool is_at_end() const {
-        return m_index >= m_tokens.size() or m_tokens.at(m_index).type() == TokenType::EndOfFile;
+    // 6.4.2.2: Integers greater than maxint are only an error once they are used.
+    [[nodiscard]] Node<IntegerLiteral> integer_literal(Token const& token) {
+        if (token.literal() == Literal::None) {
+            report_error("Integer literal out of range.", token.source_location());
+            return m_builder.integer_literal(token, 0);
+        }
+        return m_builder.integer_literal(token, literals().integer(token.literal()));
     }
 
-    [[nodiscard]] Token const& current() const {
-        if (not is_at_end()) {
-            return m_tokens.at(m_index);
+    [[nodiscard]] Node<RealLiteral> real_literal(Token const& token) {
+        if (token.literal() == Literal::None) {
+            report_error("Real literal out of range.", token.source_location());
+            return m_builder.real_literal(token, 0.0);
         }
-        return m_tokens.back();
+        return m_builder.real_literal(token, literals().real(token.literal()));
+    }
+
+    // The following functions are not `const` because peeking at a `TokenStream` may have to lex new tokens.
+
+    [[nodiscard]] Token current() {
+        return peek(0);
     }
 
-    [[nodiscard]] Token const& peek(usize const offset = 1) const {
-        auto const position = m_index + offset;
-        if (position < m_tokens.size()) {
-            return m_tokens.at(position);
+    [[nodiscard]] Token peek(usize const offset = 1) {
+        if (m_panicking) {
+            return placeholder(TokenType::EndOfFile);
         }
-        return m_tokens.back();
+        return next_token(offset);
     }
 
-    [[nodiscard]] bool current_is(TokenType const type) const {
+    // Like `peek()`, but also while panicking.
+    [[nodiscard]] Token next_token(usize const offset = 0) {
+        auto const token = m_tokens.peek_or_end(offset);
+        // A lexer error ends the token stream. It takes the place of the parser error that the end of file token
+        // would cause.
+        if (auto const& error = m_tokens.error(); error.has_value()) {
+            if (not m_stopped) {
+                auto const id = m_diagnostics.report(*error);
+                m_error = m_error.value_or(id);
+                m_panicking = true;
+                m_stopped = true;
+            }
+            return placeholder(TokenType::EndOfFile);
+        }
+        return token;
+    }
+
+    [[nodiscard]] bool current_is(TokenType const type) {
         return current().type() == type;
     }
 
-    [[nodiscard]] bool current_is_any_of(std::same_as<TokenType> auto const... types) const {
-        return ((current().type() == types) or ...);
+    [[nodiscard]] bool current_is_any_of(std::same_as<TokenType> auto const... types) {
+        auto const current_type = current().type();
+        return ((current_type == types) or ...);
     }
 
-    [[nodiscard]] bool current_is_none_of(std::same_as<TokenType> auto const... types) const {
+    [[nodiscard]] bool current_is_none_of(std::same_as<TokenType> auto const... types) {
         return not current_is_any_of(types...);
     }
 
-    [[nodiscard]] bool continues_with(std::same_as<TokenType> auto const... types) const {
+    [[nodiscard]] bool continues_with(std::same_as<TokenType> auto const... types) {
         auto offset = usize{ 0 };
         return ([&] {
             auto const actual_type = peek(offset).type();
@@ -492,33 +619,181 @@ private:
         }() and ...);
     }
 
-    [[nodiscard]] tl::optional<Token const&> match(TokenType const type) {
+    [[nodiscard]] tl::optional<Token> match(TokenType const type) {
         if (current_is(type)) {
-            auto const& result = current();
-            advance();
-            return result;
+            return consume();
         }
         return tl::nullopt;
     }
 
-    Token const& expect(TokenType const type, std::string const& error_message) {
-        if (auto const& token = match(type)) {
-            return token.value();
+    // `error_message` must be a string literal.
+    Token expect(TokenType const type, std::string_view const error_message) {
+        if (auto const token = match(type)) {
+            return *token;
         }
-        throw_parser_error(error_message, current().source_location());
+        report_error(error_message, current().source_location());
+        return placeholder(type);
     }
 
-    void advance() {
-        if (not is_at_end()) {
-            m_index++;
+    Token consume() {
+        auto const token = current();
+        m_tokens.advance();
+        m_end_of_previous = token.offset() + token.length();
+        m_made_progress = true;
+        return token;
+    }
+
+    // Errors are not reported while panicking, or before a token has been consumed after recovering, because they are
+    // most likely caused by the previous error. `message` must be a string literal.
+    void report_error(std::string_view const message, SourceLocation const& location) {
+        if (m_panicking) {
+            return;
+        }
+        m_panicking = true;
+        if (not m_made_progress) {
+            return;
+        }
+        auto const id = m_diagnostics.report(Diagnostic::parser_error(message, location), m_notes_stack);
+        m_error = m_error.value_or(id);
+        ++m_num_errors;
+        if (m_num_errors == m_max_errors) {
+            m_stopped = true;
+        }
+    }
+
+    // Stands in for a missing token after an error. It is empty and located after the last token that has been
+    // consumed.
+    [[nodiscard]] Token placeholder(TokenType const type) const {
+        return Token{ type, *m_tokens.file(), m_end_of_previous, 0 };
+    }
+
+    // The offset of the next token, which is where an error node for the following construct starts.
+    [[nodiscard]] u32 position() {
+        return m_stopped ? 0 : next_token().offset();
+    }
+
+    // Skips the tokens up to the next `;`, `end`, or section keyword, and stops panicking. Returns the span from
+    // `start` to the end of the last token that has been consumed since then, which is empty if there is none.
+    [[nodiscard]] tl::optional<SourceSpan> recover(u32 const start) {
+        if (not m_panicking or m_stopped) {
+            return tl::nullopt;
+        }
+        skip_to_synchronizing_token(true);
+        if (m_end_of_previous <= start) {
+            return SourceSpan{ start, 0 };
         }
+        return SourceSpan{ start, m_end_of_previous - start };
     }
 
-    [[noreturn]] void throw_parser_error(std::string const& message, SourceLocation const& location) const {
-        throw ParserError{ message, location, m_notes_stack };
+    // Expects the semicolon after a definition or declaration. After an error, skips the rest of the definition, up to
+    // and including the next `;`, or up to the next section of the block.
+    void expect_semicolon(std::string_view const error_message) {
+        if (not m_panicking and match(TokenType::Semicolon)) {
+            return;
+        }
+        report_error(error_message, current().source_location());
+        if (m_stopped) {
+            return;
+        }
+        skip_to_synchronizing_token(false);
+        std::ignore = match(TokenType::Semicolon);
+    }
+
+    // A type or constant can end at `end` (in a record), but a definition cannot.
+    void skip_to_synchronizing_token(bool const stop_at_end) {
+        m_panicking = false;
+        // clang-format off
+        while (
+            current_is_none_of(
+                TokenType::Semicolon,
+                TokenType::Label,
+                TokenType::Const,
+                TokenType::Type,
+                TokenType::Var,
+                TokenType::EndOfFile
+            )
+            and not (stop_at_end and current_is(TokenType::End))
+        ) {
+            // clang-format on
+            std::ignore = consume();
+        }
+        m_made_progress = false;
     }
 };
 
-[[nodiscard]] Ast parse(std::vector<Token>&& tokens) {
-    return Parser{ std::move(tokens) }.parse();
+[[noreturn]] void throw_parser_error(Diagnostics const& diagnostics, DiagnosticId const id) {
+    auto const& diagnostic = diagnostics[id];
+    if (diagnostic.kind() != DiagnosticKind::ParserError) {
+        throw_lexer_error(diagnostic);
+    }
+    auto notes = std::vector<ParserNote>{};
+    notes.reserve(diagnostics.notes(id).size());
+    for (auto const& note : diagnostics.notes(id)) {
+        notes.emplace_back(note.source_location(), note.message());
+    }
+    throw_or_abort(ParserError{ diagnostic.message(), diagnostic.source_location(), std::move(notes) });
+}
+
+// Implements the throwing functions in terms of the `try_` functions.
+template<typename Result>
+[[nodiscard]] static Result value_or_throw(Diagnostics const& diagnostics, std::expected<Result, DiagnosticId>&& ast) {
+    if (not ast.has_value()) {
+        throw_parser_error(diagnostics, ast.error());
+    }
+    return std::move(*ast);
+}
+
+[[nodiscard]] Ast parse(TokenBuffer&& tokens) {
+    auto diagnostics = Diagnostics{};
+    return value_or_throw(diagnostics, try_parse(diagnostics, std::move(tokens)));
+}
+
+[[nodiscard]] Ast parse(TokenStream&& tokens) {
+    auto diagnostics = Diagnostics{};
+    return value_or_throw(diagnostics, try_parse(diagnostics, std::move(tokens)));
+}
+
+[[nodiscard]] std::expected<Ast, DiagnosticId> try_parse(Diagnostics& diagnostics, TokenBuffer&& tokens) {
+    return Parser<BufferedTokens, AstBuilder>{ BufferedTokens{ std::move(tokens) }, diagnostics, 1 }.parse();
+}
+
+[[nodiscard]] std::expected<Ast, DiagnosticId> try_parse(Diagnostics& diagnostics, TokenStream&& tokens) {
+    return Parser<TokenStream, AstBuilder>{ std::move(tokens), diagnostics, 1 }.parse();
+}
+
+[[nodiscard]] FlatAst parse_flat(TokenBuffer&& tokens) {
+    auto diagnostics = Diagnostics{};
+    return value_or_throw(diagnostics, try_parse_flat(diagnostics, std::move(tokens)));
+}
+
+[[nodiscard]] FlatAst parse_flat(TokenStream&& tokens) {
+    auto diagnostics = Diagnostics{};
+    return value_or_throw(diagnostics, try_parse_flat(diagnostics, std::move(tokens)));
+}
+
+[[nodiscard]] std::expected<FlatAst, DiagnosticId> try_parse_flat(Diagnostics& diagnostics, TokenBuffer&& tokens) {
+    return Parser<BufferedTokens, FlatAstBuilder>{ BufferedTokens{ std::move(tokens) }, diagnostics, 1 }.parse();
+}
+
+[[nodiscard]] std::expected<FlatAst, DiagnosticId> try_parse_flat(Diagnostics& diagnostics, TokenStream&& tokens) {
+    return Parser<TokenStream, FlatAstBuilder>{ std::move(tokens), diagnostics, 1 }.parse();
+}
+
+[[nodiscard]] Ast parse_with_recovery(Diagnostics& diagnostics, TokenBuffer&& tokens, usize const max_errors) {
+    auto parser = Parser<BufferedTokens, AstBuilder>{ BufferedTokens{ std::move(tokens) }, diagnostics, max_errors };
+    return std::move(parser).parse_with_recovery();
+}
+
+[[nodiscard]] Ast parse_with_recovery(Diagnostics& diagnostics, TokenStream&& tokens, usize const max_errors) {
+    return Parser<TokenStream, AstBuilder>{ std::move(tokens), diagnostics, max_errors }.parse_with_recovery();
+}
+
+[[nodiscard]] FlatAst parse_flat_with_recovery(Diagnostics& diagnostics, TokenBuffer&& tokens, usize const max_errors) {
+    auto parser =
+        Parser<BufferedTokens, FlatAstBuilder>{ BufferedTokens{ std::move(tokens) }, diagnostics, max_errors };
+    return std::move(parser).parse_with_recovery();
+}
+
+[[nodiscard]] FlatAst parse_flat_with_recovery(Diagnostics& diagnostics, TokenStream&& tokens, usize const max_errors) {
+    return Parser<TokenStream, FlatAstBuilder>{ std::move(tokens), diagnostics, max_errors }.parse_with_recovery();
 }
@@ -1,3 +0,0 @@
-#include <parser/type_definition.hpp>
-
-Variant::~Variant() noexcept = default;
@@ -0,0 +1,33 @@
+#include <atomic>
+#include <profiling/allocation_counter.hpp>
+
+// Constant-initialized, since allocations may happen during the dynamic initialization of other translation units.
+static constinit auto live_bytes = std::atomic<u64>{ 0 };
+static constinit auto peak_bytes = std::atomic<u64>{ 0 };
+static constinit auto num_allocations = std::atomic<u64>{ 0 };
+
+void raise_peak_bytes(u64 const bytes) {
+    auto peak = peak_bytes.load(std::memory_order_relaxed);
+    while (bytes > peak and not peak_bytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {}
+}
+
+AllocationCounts allocation_counts() {
+    return AllocationCounts{
+        live_bytes.load(std::memory_order_relaxed),
+        peak_bytes.load(std::memory_order_relaxed),
+        num_allocations.load(std::memory_order_relaxed),
+    };
+}
+
+u64 reset_peak_bytes() {
+    return peak_bytes.exchange(live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void detail::count_allocation(u64 const num_bytes) {
+    raise_peak_bytes(live_bytes.fetch_add(num_bytes, std::memory_order_relaxed) + num_bytes);
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void detail::count_deallocation(u64 const num_bytes) {
+    live_bytes.fetch_sub(num_bytes, std::memory_order_relaxed);
+}
@@ -0,0 +1,45 @@
+#include <common/common.hpp>
+#include <cstdlib>
+#include <new>
+#include <profiling/allocation_counter.hpp>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+[[nodiscard]] static usize usable_size(void* const pointer) {
+#if defined(_WIN32)
+    return _msize(pointer);
+#elif defined(__APPLE__)
+    return malloc_size(pointer);
+#else
+    return malloc_usable_size(pointer);
+#endif
+}
+
+// The other forms of `operator new` and `operator delete` without an alignment, i.e., the array and nothrow ones, call
+// these by default.
+
+void* operator new(std::size_t const size) {
+    // `malloc(0)` may return null, but `operator new` has to return a unique pointer.
+    auto const pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr) {
+        throw_or_abort(std::bad_alloc{});
+    }
+    detail::count_allocation(u64{ usable_size(pointer) });
+    return pointer;
+}
+
+void operator delete(void* const pointer) noexcept {
+    if (pointer == nullptr) {
+        return;
+    }
+    detail::count_deallocation(u64{ usable_size(pointer) });
+    std::free(pointer);
+}
+
+void operator delete(void* const pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
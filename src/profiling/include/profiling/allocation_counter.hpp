@@ -0,0 +1,34 @@
+#pragma once
+
+#include <lib2k/types.hpp>
+
+// Counts the memory that is allocated through the global `operator new`. This covers every standard container that
+// uses the default allocator, and the blocks of the arenas. Memory that is allocated with an extended alignment, by
+// `malloc()`, or by mapping files is not counted. The sizes are the usable sizes reported by the system allocator, so
+// they include its rounding, but not its bookkeeping.
+//
+// The counting `operator new` is not part of the profiling library, but of the object library `allocation_counter`,
+// so that only the executables that link it pay a few atomic operations per allocation. In all other programs, the
+// counts stay zero. Once linked, counting cannot be disabled, since memory that has been allocated before enabling it
+// could not be told apart when it is freed.
+
+struct AllocationCounts final {
+    u64 live_bytes;  // Allocated and not yet freed.
+    u64 peak_bytes;  // The maximum of the live bytes since the peak has been reset.
+    u64 num_allocations;  // Since the start of the process.
+};
+
+[[nodiscard]] AllocationCounts allocation_counts();
+
+// Sets the peak to the number of live bytes and returns the previous peak. Together with `raise_peak_bytes()`, this
+// measures the peak of a section of the program without losing the peak of the enclosing section.
+u64 reset_peak_bytes();
+
+// Sets the peak to `peak_bytes` unless it is already higher.
+void raise_peak_bytes(u64 peak_bytes);
+
+namespace detail {
+    // Called by the replaced `operator new` and `operator delete`.
+    void count_allocation(u64 num_bytes);
+    void count_deallocation(u64 num_bytes);
+}  // namespace detail
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <lib2k/types.hpp>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tracing/trace.hpp>
+#include <vector>
+
+// Measures the phases of a compilation. A phase is measured by a `Scope` from its creation until its destruction.
+// Scopes may be nested, e.g., to measure the phases of each file within the compilation of all files.
+//
+// Every phase records its wall and CPU time, and the memory allocated through `operator new` (see
+// `allocation_counter.hpp`). Wall time is measured with a monotonic clock, and CPU time is the time spent by all
+// threads of the process. Measuring a phase reads both clocks and the allocation counters twice. A disabled profiler
+// does not measure anything. Independently of the profiler, phases are recorded as trace events while tracing (see
+// `trace.hpp`).
+class Profiler final {
+public:
+    using Duration = std::chrono::nanoseconds;
+
+    // What the report contains. The profiler is disabled if it contains nothing.
+    struct Options final {
+        bool time = false;  // The times and the throughput of the phases.
+        bool memory = false;  // The allocations of the phases, and the sizes of the data structures.
+    };
+
+    struct Phase final {
+        std::string_view name;
+        usize depth;  // The number of enclosing phases.
+        Duration wall_time{};
+        Duration cpu_time{};
+        // The amount of work done by the phase, which is used to compute its throughput. Zero if unknown.
+        u64 num_bytes = 0;
+        u64 num_tokens = 0;
+        u64 num_nodes = 0;
+        u64 live_bytes_before = 0;
+        u64 live_bytes_after = 0;
+        u64 peak_bytes = 0;  // The maximum of the live bytes during the phase.
+        u64 num_allocations = 0;
+    };
+
+    // The memory used by a data structure, or by a part of it.
+    struct Structure final {
+        std::string name;
+        usize depth;  // The number of enclosing structures.
+        u64 num_elements;  // Zero if the structure does not consist of elements.
+        u64 num_bytes;
+    };
+
+    class [[nodiscard]] Scope final {
+        friend class Profiler;
+
+    private:
+        Profiler* m_profiler;  // Null if the profiler is disabled.
+        usize m_phase;
+        u64 m_outer_peak_bytes;
+        u64 m_num_allocations_start;
+        std::chrono::steady_clock::time_point m_wall_start;
+        std::clock_t m_cpu_start;
+        TraceScope m_trace;
+
+        explicit Scope(Profiler* profiler, usize phase, std::string_view name);
+
+    public:
+        Scope(Scope const& other) = delete;
+        Scope(Scope&& other) noexcept = delete;
+        Scope& operator=(Scope const& other) = delete;
+        Scope& operator=(Scope&& other) noexcept = delete;
+        ~Scope();
+
+        void count_bytes(u64 num_bytes);
+        void count_tokens(u64 num_tokens);
+        void count_nodes(u64 num_nodes);
+    };
+
+private:
+    Options m_options;
+    std::vector<Phase> m_phases;  // In the order in which they started.
+    std::vector<Structure> m_structures;  // In the order in which they were added.
+    usize m_depth = 0;
+
+public:
+    [[nodiscard]] explicit Profiler(Options const& options)
+        : m_options{ options } {}
+
+    [[nodiscard]] bool is_enabled() const {
+        return m_options.time or m_options.memory;
+    }
+
+    // Whether data structures have to be measured (see `add_structure()`).
+    [[nodiscard]] bool measures_memory() const {
+        return m_options.memory;
+    }
+
+    // `name` must outlive the profiler.
+    [[nodiscard]] Scope measure(std::string_view name);
+
+    // Records the size of a data structure for the memory report. Does nothing if there is no memory report.
+    void add_structure(std::string name, usize depth, u64 num_elements, u64 num_bytes);
+
+    [[nodiscard]] std::span<Phase const> phases() const {
+        return m_phases;
+    }
+
+    [[nodiscard]] std::span<Structure const> structures() const {
+        return m_structures;
+    }
+
+    // Writes a table with the times and the throughput of every phase, a table with the allocations of every phase,
+    // and a table with the sizes of the data structures, depending on the options. Nested phases are indented.
+    void format_report_to(std::ostream& stream) const;
+
+private:
+    void format_time_report_to(std::ostream& stream) const;
+    void format_memory_report_to(std::ostream& stream) const;
+};
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <array>
+#include <format>
+#include <print>
+#include <profiling/allocation_counter.hpp>
+#include <profiling/profiler.hpp>
+#include <string>
+#include <utility>
+
+Profiler::Scope::Scope(Profiler* const profiler, usize const phase, std::string_view const name)
+    : m_profiler{ profiler },
+      m_phase{ phase },
+      m_outer_peak_bytes{ 0 },
+      m_num_allocations_start{ 0 },
+      m_wall_start{},
+      m_cpu_start{},
+      m_trace{ name } {
+    if (m_profiler != nullptr) {
+        m_outer_peak_bytes = reset_peak_bytes();
+        auto const counts = allocation_counts();
+        m_profiler->m_phases[m_phase].live_bytes_before = counts.live_bytes;
+        m_num_allocations_start = counts.num_allocations;
+        m_cpu_start = std::clock();
+        m_wall_start = std::chrono::steady_clock::now();
+    }
+}
+
+Profiler::Scope::~Scope() {
+    if (m_profiler == nullptr) {
+        return;
+    }
+    auto const wall_end = std::chrono::steady_clock::now();
+    auto const cpu_end = std::clock();
+    auto const counts = allocation_counts();
+    auto& phase = m_profiler->m_phases[m_phase];
+    phase.wall_time = std::chrono::duration_cast<Duration>(wall_end - m_wall_start);
+    auto const cpu_seconds = static_cast<double>(cpu_end - m_cpu_start) / static_cast<double>(CLOCKS_PER_SEC);
+    phase.cpu_time = std::chrono::duration_cast<Duration>(std::chrono::duration<double>{ cpu_seconds });
+    phase.live_bytes_after = counts.live_bytes;
+    phase.peak_bytes = counts.peak_bytes;
+    phase.num_allocations = counts.num_allocations - m_num_allocations_start;
+    // The enclosing phase has to see the peak of this phase as well as its own peak before this phase.
+    raise_peak_bytes(m_outer_peak_bytes);
+    --m_profiler->m_depth;
+}
+
+void Profiler::Scope::count_bytes(u64 const num_bytes) {
+    if (m_profiler != nullptr) {
+        m_profiler->m_phases[m_phase].num_bytes += num_bytes;
+    }
+}
+
+void Profiler::Scope::count_tokens(u64 const num_tokens) {
+    if (m_profiler != nullptr) {
+        m_profiler->m_phases[m_phase].num_tokens += num_tokens;
+    }
+}
+
+void Profiler::Scope::count_nodes(u64 const num_nodes) {
+    if (m_profiler != nullptr) {
+        m_profiler->m_phases[m_phase].num_nodes += num_nodes;
+    }
+}
+
+Profiler::Scope Profiler::measure(std::string_view const name) {
+    if (not is_enabled()) {
+        return Scope{ nullptr, 0, name };
+    }
+    m_phases.push_back(Phase{ name, m_depth });
+    ++m_depth;
+    return Scope{ this, m_phases.size() - 1, name };
+}
+
+void Profiler::add_structure(std::string name, usize const depth, u64 const num_elements, u64 const num_bytes) {
+    if (m_options.memory) {
+        m_structures.push_back(Structure{ std::move(name), depth, num_elements, num_bytes });
+    }
+}
+
+[[nodiscard]] static std::string format_duration(Profiler::Duration const duration) {
+    return std::format("{:.3f} ms", std::chrono::duration<double, std::milli>{ duration }.count());
+}
+
+// Formats `amount` per second with a metric prefix, e.g., "1.50 MB/s" or "1.50 M tokens/s".
+[[nodiscard]] static std::string format_rate(
+    u64 const amount,
+    std::string_view const unit,
+    Profiler::Duration const duration
+) {
+    static constexpr auto prefixes = std::array<std::string_view, 5>{ "", "k", "M", "G", "T" };
+    auto const seconds = std::chrono::duration<double>{ duration }.count();
+    auto rate = static_cast<double>(amount) / seconds;
+    auto prefix = usize{ 0 };
+    while (rate >= 1000.0 and prefix + 1 < prefixes.size()) {
+        rate /= 1000.0;
+        ++prefix;
+    }
+    auto const separator = prefix == 0 or unit == "B" ? "" : " ";
+    return std::format("{:.2f} {}{}{}/s", rate, prefixes[prefix], separator, unit);
+}
+
+// Formats a number of bytes with a binary prefix, e.g., "1.50 MiB". Differences are signed.
+[[nodiscard]] static std::string format_bytes(u64 const num_bytes, bool const is_negative = false) {
+    static constexpr auto prefixes = std::array<std::string_view, 5>{ "", "Ki", "Mi", "Gi", "Ti" };
+    auto const sign = is_negative ? "-" : "";
+    if (num_bytes < 1024) {
+        return std::format("{}{} B", sign, num_bytes);
+    }
+    auto amount = static_cast<double>(num_bytes);
+    auto prefix = usize{ 0 };
+    while (amount >= 1024.0 and prefix + 1 < prefixes.size()) {
+        amount /= 1024.0;
+        ++prefix;
+    }
+    return std::format("{}{:.2f} {}B", sign, amount, prefixes[prefix]);
+}
+
+[[nodiscard]] static std::string indent(std::string_view const name, usize const depth) {
+    return std::string(2 * depth, ' ') + std::string{ name };
+}
+
+static constexpr auto name_width = usize{ 24 };
+static constexpr auto column_width = usize{ 14 };
+
+void Profiler::format_report_to(std::ostream& stream) const {
+    if (m_options.time) {
+        format_time_report_to(stream);
+    }
+    if (m_options.time and m_options.memory) {
+        std::println(stream);
+    }
+    if (m_options.memory) {
+        format_memory_report_to(stream);
+    }
+}
+
+void Profiler::format_time_report_to(std::ostream& stream) const {
+    std::println(
+        stream,
+        "{:{}}{:>{}}{:>{}}  {}",
+        "Phase",
+        name_width,
+        "Wall",
+        column_width,
+        "CPU",
+        column_width,
+        "Throughput"
+    );
+    for (auto const& phase : m_phases) {
+        auto throughput = std::string{};
+        auto const add_rate = [&](u64 const amount, std::string_view const unit) {
+            if (amount == 0 or phase.wall_time <= Duration::zero()) {
+                return;
+            }
+            if (not throughput.empty()) {
+                throughput += ", ";
+            }
+            throughput += format_rate(amount, unit, phase.wall_time);
+        };
+        add_rate(phase.num_bytes, "B");
+        add_rate(phase.num_tokens, "tokens");
+        add_rate(phase.num_nodes, "nodes");
+        std::println(
+            stream,
+            "{:{}}{:>{}}{:>{}}  {}",
+            indent(phase.name, phase.depth),
+            name_width,
+            format_duration(phase.wall_time),
+            column_width,
+            format_duration(phase.cpu_time),
+            column_width,
+            throughput
+        );
+    }
+}
+
+void Profiler::format_memory_report_to(std::ostream& stream) const {
+    std::println(
+        stream,
+        "{:{}}{:>{}}{:>{}}{:>{}}{:>{}}",
+        "Phase",
+        name_width,
+        "Live",
+        column_width,
+        "Growth",
+        column_width,
+        "Peak",
+        column_width,
+        "Allocations",
+        column_width
+    );
+    for (auto const& phase : m_phases) {
+        auto const is_shrinking = phase.live_bytes_after < phase.live_bytes_before;
+        auto const growth = is_shrinking ? phase.live_bytes_before - phase.live_bytes_after
+                                         : phase.live_bytes_after - phase.live_bytes_before;
+        std::println(
+            stream,
+            "{:{}}{:>{}}{:>{}}{:>{}}{:>{}}",
+            indent(phase.name, phase.depth),
+            name_width,
+            format_bytes(phase.live_bytes_after),
+            column_width,
+            format_bytes(growth, is_shrinking),
+            column_width,
+            format_bytes(phase.peak_bytes),
+            column_width,
+            phase.num_allocations,
+            column_width
+        );
+    }
+    std::println(stream, "Allocations with an extended alignment are not counted.");
+    if (m_structures.empty()) {
+        return;
+    }
+
+    // Structures may have long names, e.g., the classes of the nodes.
+    auto structure_width = name_width;
+    for (auto const& structure : m_structures) {
+        structure_width = std::max(structure_width, 2 * structure.depth + structure.name.size() + 2);
+    }
+    std::println(stream);
+    std::println(
+        stream,
+        "{:{}}{:>{}}{:>{}}",
+        "Structure",
+        structure_width,
+        "Elements",
+        column_width,
+        "Size",
+        column_width
+    );
+    for (auto const& structure : m_structures) {
+        auto const num_elements = structure.num_elements == 0 ? std::string{} : std::to_string(structure.num_elements);
+        std::println(
+            stream,
+            "{:{}}{:>{}}{:>{}}",
+            indent(structure.name, structure.depth),
+            structure_width,
+            num_elements,
+            column_width,
+            format_bytes(structure.num_bytes),
+            column_width
+        );
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <lib2k/types.hpp>
+#include <string_view>
+
+// Records what every thread does as events in the Trace Event Format, which Perfetto (https://ui.perfetto.dev) and
+// chrome://tracing show as one timeline per thread. An event is recorded by a `TraceScope` from its creation until its
+// destruction.
+//
+// Every thread records into its own ring buffer, which is allocated when the thread records its first event. Only that
+// thread writes to it, so recording takes neither locks nor allocations. When a buffer is full, its oldest events are
+// overwritten. The buffers are kept until `write_trace()` writes them, so that the events of threads that have ended
+// are not lost. While tracing is stopped, a `TraceScope` only checks whether it is started.
+
+namespace detail {
+    inline constinit auto is_tracing = std::atomic<bool>{ false };
+
+    // Nanoseconds since tracing started.
+    [[nodiscard]] i64 trace_time();
+
+    void record_trace_event(std::string_view name, std::string_view detail, i64 start, i64 end);
+}  // namespace detail
+
+// The number of events that each thread keeps.
+inline constexpr auto trace_events_per_thread = usize{ 1 } << 14;
+
+// Starts recording events. Events that have been recorded before are discarded, so no other thread may record events
+// at the same time.
+void start_tracing();
+
+[[nodiscard]] inline bool is_tracing() {
+    return detail::is_tracing.load(std::memory_order_acquire);
+}
+
+// Stops recording and writes the events of all threads to a JSON file. No other thread may record events at the same
+// time. Throws `std::runtime_error` if the file cannot be written.
+void write_trace(std::filesystem::path const& path);
+
+class [[nodiscard]] TraceScope final {
+private:
+    std::string_view m_name;
+    std::string_view m_detail;
+    i64 m_start;  // Negative if tracing is stopped.
+
+public:
+    // `name` must be valid until the trace is written, while `detail` is copied (and may be truncated).
+    [[nodiscard]] explicit TraceScope(std::string_view const name, std::string_view const detail = {})
+        : m_name{ name }, m_detail{ detail }, m_start{ is_tracing() ? detail::trace_time() : -1 } {}
+
+    TraceScope(TraceScope const& other) = delete;
+    TraceScope(TraceScope&& other) noexcept = delete;
+    TraceScope& operator=(TraceScope const& other) = delete;
+    TraceScope& operator=(TraceScope&& other) noexcept = delete;
+
+    ~TraceScope() {
+        if (m_start >= 0) {
+            detail::record_trace_event(m_name, m_detail, m_start, detail::trace_time());
+        }
+    }
+};
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <common/common.hpp>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <tracing/trace.hpp>
+
+namespace {
+    struct Event final {
+        std::string_view name;
+        i64 start;
+        i64 duration;
+        usize detail_length;
+        std::array<char, 40> detail;
+    };
+
+    struct ThreadBuffer final {
+        std::unique_ptr<Event[]> events = std::make_unique_for_overwrite<Event[]>(trace_events_per_thread);
+        usize num_recorded = 0;  // Including the events that have been overwritten.
+        u32 thread_id = 0;
+        ThreadBuffer* next = nullptr;
+    };
+
+    // The buffers of all threads that have ever recorded an event, as a list to which threads add their buffers
+    // without locking. Buffers are never freed, since threads may end before the trace is written.
+    constinit auto buffers = std::atomic<ThreadBuffer*>{ nullptr };
+    constinit auto num_threads = std::atomic<u32>{ 0 };
+    constinit auto main_thread_id = std::atomic<u32>{ 0 };  // Of the thread that started tracing.
+    constinit auto epoch = std::atomic<i64>{ 0 };
+    thread_local constinit ThreadBuffer* this_thread_buffer = nullptr;
+}  // namespace
+
+[[nodiscard]] static i64 now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+[[nodiscard]] static ThreadBuffer& buffer_of_this_thread() {
+    if (this_thread_buffer == nullptr) {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->thread_id = num_threads.fetch_add(1, std::memory_order_relaxed) + 1;
+        buffer->next = buffers.load(std::memory_order_relaxed);
+        while (not buffers.compare_exchange_weak(
+            buffer->next,
+            buffer.get(),
+            std::memory_order_release,
+            std::memory_order_relaxed
+        )) {}
+        this_thread_buffer = buffer.release();
+    }
+    return *this_thread_buffer;
+}
+
+i64 detail::trace_time() {
+    return now() - epoch.load(std::memory_order_relaxed);
+}
+
+void detail::record_trace_event(
+    std::string_view const name,
+    std::string_view const detail,
+    i64 const start,
+    i64 const end
+) {
+    auto& buffer = buffer_of_this_thread();
+    auto& event = buffer.events[buffer.num_recorded % trace_events_per_thread];
+    event.name = name;
+    event.start = start;
+    event.duration = end - start;
+    // The end of a detail is more specific than its beginning, e.g., the name of a file compared to its directory. A
+    // truncated detail must not start in the middle of a UTF-8 sequence, since the trace would not be valid JSON.
+    auto kept = detail.substr(detail.size() - std::min(detail.size(), event.detail.size()));
+    while (kept.size() < detail.size() and not kept.empty() and (static_cast<u8>(kept.front()) & 0xC0) == 0x80) {
+        kept.remove_prefix(1);
+    }
+    event.detail_length = kept.size();
+    std::ranges::copy(kept, event.detail.begin());
+    ++buffer.num_recorded;
+}
+
+void start_tracing() {
+    for (auto buffer = buffers.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+        buffer->num_recorded = 0;
+    }
+    main_thread_id.store(buffer_of_this_thread().thread_id, std::memory_order_relaxed);
+    epoch.store(now(), std::memory_order_relaxed);
+    detail::is_tracing.store(true, std::memory_order_release);
+}
+
+[[nodiscard]] static std::string escape_json(std::string_view const text) {
+    auto result = std::string{};
+    result.reserve(text.size());
+    for (auto const c : text) {
+        if (c == '"' or c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            result += std::format("\\u{:04x}", static_cast<unsigned char>(c));
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+// Timestamps are in microseconds.
+[[nodiscard]] static std::string format_microseconds(i64 const nanoseconds) {
+    return std::format("{:.3f}", static_cast<double>(nanoseconds) / 1000.0);
+}
+
+void write_trace(std::filesystem::path const& path) {
+    detail::is_tracing.store(false, std::memory_order_release);
+    auto file = std::ofstream{ path, std::ios::binary };
+    if (not file) {
+        throw_or_abort(std::runtime_error{ std::format("Failed to create file '{}'.", path.string()) });
+    }
+
+    // All events are complete events, which have a start and a duration, so that an overwritten start cannot leave an
+    // unmatched end behind.
+    std::print(file, R"({{"displayTimeUnit":"ms","traceEvents":[)");
+    std::print(file, R"({{"name":"process_name","ph":"M","pid":1,"tid":0,"args":{{"name":"pasc2k"}}}})");
+    auto num_dropped = usize{ 0 };
+    for (auto buffer = buffers.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+        auto const thread_id = buffer->thread_id;
+        auto const thread_name = thread_id == main_thread_id.load(std::memory_order_relaxed)
+                                     ? std::string{ "main" }
+                                     : std::format("worker {}", thread_id);
+        std::print(
+            file,
+            R"(,{{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})",
+            thread_id,
+            thread_name
+        );
+        auto const num_kept = std::min(buffer->num_recorded, trace_events_per_thread);
+        num_dropped += buffer->num_recorded - num_kept;
+        for (auto i = buffer->num_recorded - num_kept; i < buffer->num_recorded; ++i) {
+            auto const& event = buffer->events[i % trace_events_per_thread];
+            std::print(
+                file,
+                R"(,{{"name":"{}","cat":"pasc2k","ph":"X","ts":{},"dur":{},"pid":1,"tid":{})",
+                escape_json(event.name),
+                format_microseconds(event.start),
+                format_microseconds(event.duration),
+                thread_id
+            );
+            if (event.detail_length > 0) {
+                auto const detail = std::string_view{ event.detail.data(), event.detail_length };
+                std::print(file, R"(,"args":{{"detail":"{}"}})", escape_json(detail));
+            }
+            std::print(file, "}}");
+        }
+        buffer->num_recorded = 0;
+    }
+    std::println(file, R"(],"otherData":{{"dropped_events":{}}}}})", num_dropped);
+
+    file.close();
+    if (not file) {
+        throw_or_abort(std::runtime_error{ std::format("Failed to write file '{}'.", path.string()) });
+    }
+}
@@ -0,0 +1,150 @@
+#include <cache/cached_compilation.hpp>
+#include <cache/compilation_cache.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <lexer/lexer.hpp>
+#include <parser/parser.hpp>
+#include <string>
+
+// A cache in a new temporary directory, which is removed afterwards.
+class CacheTests : public testing::Test {
+protected:
+    std::filesystem::path directory;
+
+    void SetUp() override {
+        auto const test_name = testing::UnitTest::GetInstance()->current_test_info()->name();
+        directory = std::filesystem::temp_directory_path() / std::format("pasc2k_{}", hash_128(test_name).to_string());
+        std::filesystem::remove_all(directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    [[nodiscard]] static std::string read(std::filesystem::path const& path) {
+        auto file = std::ifstream{ path, std::ios::binary };
+        return std::string{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    }
+
+    static void store(
+        CompilationCache& cache,
+        Hash128 const key,
+        std::string_view const artifact,
+        std::string_view const contents
+    ) {
+        cache.store(key, artifact, [&](DumpSink& sink) { sink.write(contents); });
+    }
+};
+
+TEST(ContentHashTests, DependsOnEveryByteAndTheSeed) {
+    EXPECT_EQ(hash_128(""), (Hash128{ 0, 0 }));
+    // The same as MurmurHash3_x64_128 with seed 0.
+    EXPECT_EQ(hash_128("abc"), (Hash128{ 0xB496'3F3F'3FAD'7867, 0x3BA2'7441'26CA'2D52 }));
+    auto const text = std::string{ "program p; begin end." };
+    EXPECT_EQ(hash_128(text), hash_128(text));
+    EXPECT_NE(hash_128(text), hash_128(text, 1));
+    for (auto i = usize{ 0 }; i < text.size(); ++i) {
+        auto changed = text;
+        changed[i] = static_cast<char>(changed[i] ^ 1);
+        EXPECT_NE(hash_128(changed), hash_128(text));
+    }
+    EXPECT_EQ(hash_128(text).to_string().size(), 32);
+}
+
+TEST_F(CacheTests, FindsStoredArtifacts) {
+    auto cache = CompilationCache{ directory, 1024 };
+    auto const key = hash_128("key");
+    EXPECT_FALSE(cache.find(key, "ast").has_value());
+    store(cache, key, "ast", "first");
+    store(cache, key, "ast", "second");
+    auto const path = cache.find(key, "ast");
+    ASSERT_TRUE(path.has_value());
+    EXPECT_EQ(read(*path), "second");
+    EXPECT_FALSE(cache.find(key, "result").has_value());
+    EXPECT_FALSE(cache.find(hash_128("other key"), "ast").has_value());
+}
+
+TEST_F(CacheTests, RemovesLeastRecentlyUsedEntries) {
+    auto cache = CompilationCache{ directory, 25 };
+    auto const first = hash_128("first");
+    auto const second = hash_128("second");
+    store(cache, first, "ast", "0123456789");
+    store(cache, first, "result", "0");
+    store(cache, second, "ast", "0123456789");
+    // Make sure that the first entry is used last, even if the file times are coarse.
+    auto const an_hour_ago = std::filesystem::file_time_type::clock::now() - std::chrono::hours{ 1 };
+    std::filesystem::last_write_time(*cache.find(second, "ast"), an_hour_ago);
+    ASSERT_TRUE(cache.find(first, "ast").has_value());
+
+    store(cache, hash_128("third"), "ast", "0123456789");
+    EXPECT_TRUE(cache.find(first, "ast").has_value());
+    EXPECT_TRUE(cache.find(first, "result").has_value());
+    EXPECT_FALSE(cache.find(second, "ast").has_value());
+    EXPECT_TRUE(cache.find(hash_128("third"), "ast").has_value());
+}
+
+TEST_F(CacheTests, RemovesStaleTemporaries) {
+    auto cache = CompilationCache{ directory, 1024 };
+    auto const stale = directory / "tmp-stale";
+    auto const recent = directory / "tmp-recent";
+    std::ofstream{ stale } << "left behind";
+    std::ofstream{ recent } << "still being written";
+    std::filesystem::last_write_time(stale, std::filesystem::file_time_type::clock::now() - std::chrono::hours{ 2 });
+
+    // The first store scans the directory, since there is no index yet.
+    store(cache, hash_128("key"), "ast", "abc");
+    EXPECT_FALSE(std::filesystem::exists(stale));
+    EXPECT_TRUE(std::filesystem::exists(recent));
+    EXPECT_EQ(cache.statistics().num_entries, 1);
+}
+
+TEST_F(CacheTests, CountsHitsAndMisses) {
+    auto cache = CompilationCache{ directory, 1024 };
+    store(cache, hash_128("key"), "ast", "abc");
+    store(cache, hash_128("key"), "result", "de");
+    cache.record_miss();
+    cache.record_hit();
+    cache.record_hit();
+    auto const [num_hits, num_misses, num_entries, size] = cache.statistics();
+    EXPECT_EQ(num_hits, 2);
+    EXPECT_EQ(num_misses, 1);
+    EXPECT_EQ(num_entries, 1);
+    EXPECT_EQ(size, 5);
+}
+
+#if PASC2K_EXCEPTIONS
+TEST_F(CacheTests, DiscardsUnusableCompilations) {
+    auto cache = CompilationCache{ directory, 1024 * 1024 };
+    auto const key = hash_128("key");
+    auto const compile = [] {
+        return CachedCompilation{ EXIT_SUCCESS, "", parse_flat(tokenize("test", "var x: integer;")) };
+    };
+    store_compilation(cache, key, compile());
+    auto const ast_path = *cache.find(key, "ast");
+    auto const contents = read(ast_path);
+    {
+        auto file = std::ofstream{ ast_path, std::ios::binary | std::ios::trunc };
+        file << contents.substr(0, contents.size() / 2);
+    }
+    EXPECT_FALSE(load_compilation(cache, key).has_value());
+    EXPECT_FALSE(cache.find(key, "result").has_value());
+    EXPECT_FALSE(cache.find(key, "ast").has_value());
+
+    // Compiling again replaces the entry.
+    store_compilation(cache, key, compile());
+    auto const compilation = load_compilation(cache, key);
+    ASSERT_TRUE(compilation.has_value());
+    EXPECT_EQ(compilation->exit_code, EXIT_SUCCESS);
+    ASSERT_TRUE(compilation->ast.has_value());
+    EXPECT_EQ(compilation->ast->size(), 6);
+
+    store(cache, key, "result", "not a result");
+    EXPECT_FALSE(load_compilation(cache, key).has_value());
+    EXPECT_FALSE(cache.find(key, "ast").has_value());
+}
+#endif
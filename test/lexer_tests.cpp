@@ -1,10 +1,16 @@
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <limits>
 #include <gtest/gtest.h>
 #include <lexer/lexer.hpp>
 #include <lexer/lexer_error.hpp>
+#include <lexer/source_buffer.hpp>
+#include <tuple>
 
 using namespace std::string_view_literals;
 
-static std::vector<Token> tokenize(std::string_view const source) {
+static TokenBuffer tokenize(std::string_view const source) {
     return tokenize("test.pas", source);
 }
 
@@ -237,6 +243,7 @@ InquireWorkstationTransformation InquireWorkstationIdentification)"sv;
     EXPECT_EQ(tokens.at(7).type(), TokenType::EndOfFile);
 }
 
+#if PASC2K_EXCEPTIONS
 TEST(LexerTests, NonAsciiCharacter_Throws) {
     static constexpr auto source = "🦀"sv;
     EXPECT_THROW(
@@ -266,6 +273,7 @@ TEST(LexerTests, InvalidCharacter_Throws) {
         UnexpectedCharacter
     );
 }
+#endif
 
 TEST(LexerTests, Numbers_TokenizesCorrectly) {
     static constexpr auto source = "1e10 1 100 0.1 5e-3 87.35E+8"sv;
@@ -289,6 +297,7 @@ TEST(LexerTests, Numbers_TokenizesCorrectly) {
     EXPECT_EQ(tokens.at(6).type(), TokenType::EndOfFile);
 }
 
+#if PASC2K_EXCEPTIONS
 TEST(LexerTests, InvalidNumbers_Throws) {
     EXPECT_THROW(
         {
@@ -324,6 +333,7 @@ TEST(LexerTests, InvalidNumbers_Throws) {
         UnexpectedCharacter
     );
 }
+#endif
 
 TEST(LexerTests, CharLiteral_TokenizesCorrectly) {
     auto const tokens = tokenize("'a' 'b' '!' '_' ' ' '@' ''''");
@@ -347,6 +357,7 @@ TEST(LexerTests, CharLiteral_TokenizesCorrectly) {
     EXPECT_EQ(tokens.at(7).type(), TokenType::EndOfFile);
 }
 
+#if PASC2K_EXCEPTIONS
 TEST(LexerTests, InvalidCharLiteral_Throws) {
     EXPECT_THROW(
         {
@@ -360,6 +371,7 @@ TEST(LexerTests, InvalidCharLiteral_Throws) {
         UnexpectedCharacter
     );
 }
+#endif
 
 TEST(LexerTests, StringLiteral_TokenizesCorrectly) {
     auto const tokens = tokenize("'Abc' 'Pascal' 'THIS IS A STRING' 'The name is ''Pascal''!'");
@@ -377,6 +389,7 @@ TEST(LexerTests, StringLiteral_TokenizesCorrectly) {
     EXPECT_EQ(tokens.at(4).type(), TokenType::EndOfFile);
 }
 
+#if PASC2K_EXCEPTIONS
 TEST(LexerTests, StringLiteral_Throws) {
     EXPECT_THROW(
         {
@@ -390,6 +403,7 @@ TEST(LexerTests, StringLiteral_Throws) {
         UnexpectedCharacter
     );
 }
+#endif
 
 TEST(LexerTests, Comments_GetIgnored) {
     static constexpr auto source = R"({This is a comment and everything is allowed, even ferris 🦀
@@ -401,6 +415,7 @@ other way around*) (*or use parentheses on both ends*))"sv;
     EXPECT_EQ(tokens.at(0).type(), TokenType::EndOfFile);
 }
 
+#if PASC2K_EXCEPTIONS
 TEST(LexerTests, MissingTokenSeparator_Throws) {
     EXPECT_THROW(
         {
@@ -415,6 +430,39 @@ TEST(LexerTests, MissingTokenSeparator_Throws) {
     );
 }
 
+TEST(LexerTests, MissingTokenSeparatorBeforeRequiredType_Throws) {
+    for (auto const source : { "3integer"sv, "1.5real"sv, "42Char"sv }) {
+        EXPECT_THROW(
+            {
+                try {
+                    tokenize(source);
+                } catch (UnexpectedCharacter const& e) {
+                    EXPECT_EQ(e.source_location().text(), source.substr(source.find_first_of("irC"), 1));
+                    throw;
+                }
+            },
+            UnexpectedCharacter
+        ) << source;
+    }
+}
+
+TEST(LexerTests, EveryByte_IsClassified) {
+    for (auto i = 0; i < 256; ++i) {
+        auto const c = static_cast<char>(i);
+        auto const source = std::string{ c };
+        if (i >= 128) {
+            EXPECT_THROW(std::ignore = tokenize(source), NonAsciiCharacter) << i;
+        } else if (std::isalnum(i) or std::isspace(i) or "+-*/=<>[].,:;^@()"sv.contains(c)) {
+            EXPECT_NO_THROW(std::ignore = tokenize(source)) << i;
+        } else if (c == '{' or c == '\'') {
+            EXPECT_ANY_THROW(std::ignore = tokenize(source)) << i;
+        } else {
+            EXPECT_THROW(std::ignore = tokenize(source), UnexpectedCharacter) << i;
+        }
+    }
+}
+#endif
+
 TEST(LexerTests, AlternativeTokens_TokenizesCorrectly) {
     auto const tokens = tokenize("^@(..)");
     EXPECT_EQ(tokens.size(), 5);
@@ -426,6 +474,7 @@ TEST(LexerTests, AlternativeTokens_TokenizesCorrectly) {
     EXPECT_EQ(tokens.at(4).type(), TokenType::EndOfFile);
 }
 
+#if PASC2K_EXCEPTIONS
 TEST(LexerTests, UnterminatedComment_Throws) {
     EXPECT_THROW(
         {
@@ -439,6 +488,7 @@ TEST(LexerTests, UnterminatedComment_Throws) {
         UnterminatedComment
     );
 }
+#endif
 
 TEST(LexerTests, ValidTokens_CorrectSourceLocations) {
     static constexpr auto source = R"(begin
@@ -482,3 +532,508 @@ end.)"sv;
     EXPECT_EQ(tokens.at(7).source_location().position(), SourceLocation::Position(3, 4, 3, 5));
     EXPECT_EQ(tokens.at(7).source_location().length(), 1);
 }
+
+TEST(LexerTests, MultiLineSourceLocation_ReportsPositionAndSurroundingLines) {
+    static constexpr auto source = "const\n  a = 1;\n\n  b = 2;\nvar"sv;
+
+    auto const tokens = tokenize(source);
+    EXPECT_EQ(tokens.size(), 11);
+
+    EXPECT_EQ(tokens.at(5).type(), TokenType::Identifier);
+    EXPECT_EQ(tokens.at(5).lexeme(), "b");
+    EXPECT_EQ(tokens.at(5).source_location().position(), SourceLocation::Position(4, 3, 4, 4));
+
+    EXPECT_EQ(tokens.at(9).type(), TokenType::Var);
+    EXPECT_EQ(tokens.at(9).source_location().position(), SourceLocation::Position(5, 1, 5, 4));
+    EXPECT_EQ(tokens.at(9).source_location().surrounding_lines(), std::vector{ "var"sv });
+
+    auto const joined = tokens.at(1).source_location().join(tokens.at(8).source_location());
+    EXPECT_EQ(joined.position(), SourceLocation::Position(2, 3, 4, 9));
+    EXPECT_EQ(joined.surrounding_lines(), (std::vector{ "  a = 1;"sv, ""sv, "  b = 2;"sv }));
+}
+
+TEST(LexerTests, WordSymbolLookalikes_TokenizeAsIdentifiers) {
+    static constexpr auto source = "an ands arr arrays beginning ends do1 downt integers reals chars Bool x iF2 TOs"sv;
+    auto const tokens = tokenize(source);
+
+    EXPECT_EQ(tokens.size(), 16);
+    for (auto i = usize{ 0 }; i < tokens.size() - 1; ++i) {
+        EXPECT_EQ(tokens.at(i).type(), TokenType::Identifier) << tokens.at(i).lexeme();
+    }
+    EXPECT_EQ(tokens.back().type(), TokenType::EndOfFile);
+}
+
+TEST(LexerTests, LongRuns_TokenizeAcrossBlockBoundaries) {
+    // The lexer scans whitespace, identifiers, comments, and strings in blocks of up to 32 characters, so all
+    // lengths around the block sizes are covered here.
+    for (auto length = usize{ 1 }; length <= 70; ++length) {
+        auto const identifier = std::string(length, 'a') + "Z9";
+        auto const whitespace = std::string(length, ' ') + "\t\n";
+        auto const comment = "{" + std::string(length, '*') + ")(*" + std::string(length, 'x') + "*)";
+        auto const string = "'" + std::string(length, 'b') + "'''";
+        auto const source = identifier + whitespace + comment + string + whitespace + identifier;
+
+        auto const tokens = tokenize(source);
+        ASSERT_EQ(tokens.size(), 4);
+        EXPECT_EQ(tokens.at(0).type(), TokenType::Identifier);
+        EXPECT_EQ(tokens.at(0).lexeme(), identifier);
+        EXPECT_EQ(tokens.at(1).type(), TokenType::StringValue);
+        EXPECT_EQ(tokens.at(1).lexeme(), string);
+        EXPECT_EQ(tokens.at(2).type(), TokenType::Identifier);
+        EXPECT_EQ(tokens.at(2).lexeme(), identifier);
+        EXPECT_EQ(tokens.at(3).type(), TokenType::EndOfFile);
+    }
+}
+
+#if PASC2K_EXCEPTIONS
+TEST(LexerTests, InvalidCharacterInLongString_Throws) {
+    auto const source = "'" + std::string(40, 'a') + "\x7F'";
+    EXPECT_THROW(
+        {
+            try {
+                tokenize(source);
+            } catch (UnexpectedCharacter const& e) {
+                EXPECT_EQ(e.source_location().position(), SourceLocation::Position(1, 42, 1, 43));
+                throw;
+            }
+        },
+        UnexpectedCharacter
+    );
+}
+#endif
+
+TEST(LexerTests, TokenBuffer_StoresTypesOffsetsAndLengths) {
+    static constexpr auto source = "x := 'it''s' + 42"sv;
+    auto const tokens = tokenize(source);
+    ASSERT_EQ(tokens.size(), 6);
+
+    EXPECT_EQ(
+        std::vector(tokens.types().begin(), tokens.types().end()),
+        (std::vector{
+            TokenType::Identifier,
+            TokenType::ColonEquals,
+            TokenType::StringValue,
+            TokenType::Plus,
+            TokenType::IntegerNumber,
+            TokenType::EndOfFile,
+        })
+    );
+    EXPECT_EQ(tokens.offset(2), 5);
+    EXPECT_EQ(tokens.length(2), 7);
+    EXPECT_EQ(tokens.offset(5), source.length());
+    EXPECT_EQ(tokens.length(5), 1);
+
+    auto const token = tokens.at(4);
+    EXPECT_EQ(token.lexeme(), "42");
+    EXPECT_EQ(token.source_location().position(), SourceLocation::Position(1, 16, 1, 18));
+    EXPECT_EQ(tokens.file()->source(), source);
+#if PASC2K_EXCEPTIONS
+    EXPECT_THROW(std::ignore = tokens.at(6), std::out_of_range);
+#endif
+}
+
+TEST(LexerTests, TokenStream_LexesOnDemand) {
+    auto stream = TokenStream{ "test.pas", "a := b; !" };
+    EXPECT_EQ(stream.peek().type(), TokenType::Identifier);
+    EXPECT_EQ(stream.peek(2).type(), TokenType::Identifier);
+    EXPECT_EQ(stream.peek(2).lexeme(), "b");
+    stream.advance();
+    EXPECT_EQ(stream.peek().type(), TokenType::ColonEquals);
+    stream.advance();
+    stream.advance();
+    EXPECT_EQ(stream.peek().type(), TokenType::Semicolon);
+    // The invalid character is only reached when looking past the semicolon.
+#if PASC2K_EXCEPTIONS
+    EXPECT_THROW(std::ignore = stream.peek(1), UnexpectedCharacter);
+#endif
+}
+
+TEST(LexerTests, TokenStream_RepeatsEndOfFileToken) {
+    auto stream = TokenStream{ "test.pas", "x" };
+    EXPECT_EQ(stream.peek(5).type(), TokenType::EndOfFile);
+    stream.advance();
+    stream.advance();
+    stream.advance();
+    EXPECT_EQ(stream.peek().type(), TokenType::EndOfFile);
+    EXPECT_EQ(stream.peek().source_location().position(), SourceLocation::Position(1, 2, 1, 2));
+}
+
+TEST(LexerTests, SourceBuffer_MapsFilesAndOwnsStrings) {
+    auto const path = std::filesystem::temp_directory_path() / "pasc2k_source_buffer_test.pas";
+    {
+        auto file = std::ofstream{ path, std::ios::binary };
+        file << "var x: integer;\n";
+    }
+    {
+        auto const source_file = std::make_shared<SourceFile const>("mapped.pas", SourceBuffer::from_file(path));
+        auto const tokens = tokenize(source_file);
+        ASSERT_EQ(tokens.size(), 6);
+        EXPECT_EQ(tokens.at(1).lexeme(), "x");
+        EXPECT_EQ(tokens.at(1).source_location().path(), "mapped.pas");
+    }
+    std::filesystem::remove(path);
+
+    auto buffer = SourceBuffer::from_string("begin end");
+    EXPECT_FALSE(buffer.is_memory_mapped());
+    auto const source_file = std::make_shared<SourceFile const>("owned.pas", std::move(buffer));
+    EXPECT_EQ(tokenize(source_file).size(), 3);
+    EXPECT_EQ(source_file->source(), "begin end");
+
+#if PASC2K_EXCEPTIONS
+    EXPECT_THROW(std::ignore = SourceBuffer::from_file(path), std::runtime_error);
+#endif
+}
+
+TEST(LexerTests, Identifiers_AreInternedCaseInsensitively) {
+    auto const tokens = tokenize("Foo foo FOO bar Bar foo1 begin");
+    ASSERT_EQ(tokens.size(), 8);
+
+    EXPECT_EQ(tokens.symbol(0), tokens.symbol(1));
+    EXPECT_EQ(tokens.symbol(0), tokens.symbol(2));
+    EXPECT_EQ(tokens.symbol(3), tokens.symbol(4));
+    EXPECT_NE(tokens.symbol(0), tokens.symbol(3));
+    EXPECT_NE(tokens.symbol(0), tokens.symbol(5));
+    EXPECT_EQ(tokens.at(6).symbol(), Symbol::None);
+    EXPECT_EQ(tokens.at(7).symbol(), Symbol::None);
+
+    EXPECT_EQ(tokens.interner()->size(), 3);
+    EXPECT_EQ(tokens.interner()->spelling(tokens.at(2).symbol()), "foo");
+    EXPECT_EQ(tokens.interner()->spelling(tokens.at(4).symbol()), "bar");
+}
+
+TEST(LexerTests, Interner_SharedBetweenSourceFiles) {
+    auto const interner = std::make_shared<Interner>();
+    auto const first = tokenize(std::make_shared<SourceFile const>("a.pas", "Counter"), interner);
+    auto const second = tokenize(std::make_shared<SourceFile const>("b.pas", "x COUNTER"), interner);
+    EXPECT_EQ(first.symbol(0), second.symbol(1));
+    EXPECT_EQ(interner->size(), 2);
+}
+
+TEST(LexerTests, Interner_KeepsSymbolsStableWhileGrowing) {
+    auto interner = Interner{};
+    auto symbols = std::vector<Symbol>{};
+    for (auto i = 0; i < 5000; ++i) {
+        symbols.push_back(interner.intern(std::format("Name{}", i)));
+    }
+    EXPECT_EQ(interner.size(), 5000);
+    for (auto i = 0; i < 5000; ++i) {
+        EXPECT_EQ(interner.intern(std::format("NAME{}", i)), symbols.at(static_cast<usize>(i)));
+    }
+    EXPECT_EQ(interner.spelling(symbols.at(4321)), "name4321");
+}
+
+// Lexes `source` serially and in parallel with tiny chunks, so that many chunk starts fall within comments.
+static void expect_parallel_tokenize_matches_serial(std::string const& source) {
+    auto const file = std::make_shared<SourceFile const>("test.pas", source);
+    auto diagnostics = Diagnostics{};
+    auto const serial_tokens = try_tokenize(diagnostics, file);
+
+    for (auto const min_chunk_size : { usize{ 1 }, usize{ 5 }, usize{ 64 } }) {
+        for (auto const num_threads : { usize{ 2 }, usize{ 3 }, usize{ 16 } }) {
+            auto const options = ParallelLexingOptions{ num_threads, min_chunk_size };
+            auto const tokens = try_tokenize_parallel(diagnostics, file, std::make_shared<Interner>(), options);
+            ASSERT_EQ(tokens.has_value(), serial_tokens.has_value());
+            if (not tokens.has_value()) {
+                auto const& error = diagnostics[tokens.error()];
+                auto const& serial_error = diagnostics[serial_tokens.error()];
+                EXPECT_EQ(error.message(), serial_error.message());
+                EXPECT_EQ(error.source_location().position(), serial_error.source_location().position());
+                continue;
+            }
+            ASSERT_EQ(tokens->size(), serial_tokens->size());
+            for (auto i = usize{ 0 }; i < tokens->size(); ++i) {
+                EXPECT_EQ(tokens->type(i), serial_tokens->type(i)) << i;
+                EXPECT_EQ(tokens->offset(i), serial_tokens->offset(i)) << i;
+                EXPECT_EQ(tokens->length(i), serial_tokens->length(i)) << i;
+                EXPECT_EQ(tokens->symbol(i), serial_tokens->symbol(i)) << i;
+                EXPECT_EQ(tokens->literal(i), serial_tokens->literal(i)) << i;
+            }
+            EXPECT_EQ(tokens->interner()->size(), serial_tokens->interner()->size());
+            auto const& literals = tokens->interner()->literals();
+            EXPECT_EQ(literals.size(), serial_tokens->interner()->literals().size());
+        }
+    }
+}
+
+TEST(LexerTests, TokenizeParallel_MatchesSerialTokenize) {
+    auto source = std::string{};
+    for (auto i = 0; i < 40; ++i) {
+        source += std::format("Value{} := 'it''s' + {}.5E-3 * count;\n", i % 7, i);
+        source += (i % 3 == 0) ? "{ a comment\nspanning\nlines (* *) }\n" : "(* another\n{ comment }\n*)\n";
+        source += (i % 5 == 0) ? "x[1..2] := (.a, b.)\n" : "\n";
+    }
+    expect_parallel_tokenize_matches_serial(source);
+    expect_parallel_tokenize_matches_serial(source + "{ unterminated\ncomment\n");
+}
+
+TEST(LexerTests, TokenizeParallel_ReportsSameErrorAsSerial) {
+    auto const lines = std::string{ "a := b;\n{\n\n\n}\n" } + std::string(20, '\n');
+    expect_parallel_tokenize_matches_serial(lines + "{\n\n}3abc\n" + lines);
+    expect_parallel_tokenize_matches_serial(lines + "x := 'no\nstring';\n" + lines);
+    expect_parallel_tokenize_matches_serial(lines + "!" + lines + "{ later unterminated comment");
+}
+
+TEST(LexerTests, Literals_AreDecodedOnce) {
+    static constexpr auto source =
+        "42 9223372036854775807 9223372036854775808 2.5E-3 1e400 'x' '''' 'it''s' 'it''s' x"sv;
+    auto const tokens = tokenize(source);
+    ASSERT_EQ(tokens.size(), 11);
+    auto const& literals = tokens.interner()->literals();
+
+    EXPECT_EQ(literals.integer(tokens.literal(0)), 42);
+    EXPECT_EQ(literals.integer(tokens.literal(1)), std::numeric_limits<i64>::max());
+    EXPECT_EQ(tokens.literal(2), Literal::None);  // Greater than maxint.
+    EXPECT_EQ(literals.real(tokens.literal(3)), 2.5E-3);
+    EXPECT_EQ(tokens.literal(4), Literal::None);
+    EXPECT_EQ(literals.string(tokens.literal(5)), "x");
+    EXPECT_EQ(literals.string(tokens.literal(6)), "'");
+    EXPECT_EQ(literals.string(tokens.literal(7)), "it's");
+    EXPECT_EQ(tokens.literal(7), tokens.literal(8));
+    EXPECT_EQ(tokens.literal(9), Literal::None);
+    EXPECT_EQ(tokens.at(7).literal(), tokens.literal(7));
+    EXPECT_EQ(tokens.at(7).symbol(), Symbol::None);
+    EXPECT_EQ(tokens.at(9).literal(), Literal::None);
+}
+
+TEST(LexerTests, Literals_AreStoredOnce) {
+    auto const tokens = tokenize("42 2.5 'a' 42 2.5 'a'"sv);
+    ASSERT_EQ(tokens.size(), 7);
+    EXPECT_EQ(tokens.literal(0), tokens.literal(3));
+    EXPECT_EQ(tokens.literal(1), tokens.literal(4));
+    EXPECT_EQ(tokens.literal(2), tokens.literal(5));
+    EXPECT_EQ(tokens.interner()->literals().size(), 3);
+}
+
+static void expect_relex_matches_tokenize(std::string const& source, SourceEdit const& edit) {
+    auto const previous = tokenize(std::make_shared<SourceFile const>("test.pas", source));
+    auto const edited = std::string{ source }.replace(edit.offset, edit.removed_length, edit.inserted_text);
+    auto diagnostics = Diagnostics{};
+    auto const edited_file = std::make_shared<SourceFile const>("test.pas", edited);
+    auto const expected = try_tokenize(diagnostics, edited_file, previous.interner());
+
+    auto const tokens = try_relex(diagnostics, previous, edit);
+    ASSERT_EQ(tokens.has_value(), expected.has_value());
+    if (not tokens.has_value()) {
+        auto const& error = diagnostics[tokens.error()];
+        auto const& expected_error = diagnostics[expected.error()];
+        EXPECT_EQ(error.message(), expected_error.message());
+        EXPECT_EQ(error.source_location().position(), expected_error.source_location().position());
+        return;
+    }
+    EXPECT_EQ(tokens->file()->source(), edited);
+    ASSERT_EQ(tokens->size(), expected->size());
+    for (auto i = usize{ 0 }; i < tokens->size(); ++i) {
+        EXPECT_EQ(tokens->type(i), expected->type(i)) << i;
+        EXPECT_EQ(tokens->offset(i), expected->offset(i)) << i;
+        EXPECT_EQ(tokens->length(i), expected->length(i)) << i;
+        EXPECT_EQ(tokens->symbol(i), expected->symbol(i)) << i;
+        // Both share the interner, which stores every value once.
+        EXPECT_EQ(tokens->literal(i), expected->literal(i)) << i;
+    }
+}
+
+TEST(LexerTests, Relex_MatchesTokenizingEditedSource) {
+    static constexpr auto source =
+        "program p(output);\n"
+        "var x: integer; { comment } y: real;\n"
+        "begin\n"
+        "    x := 42; (* another comment *)\n"
+        "    y := 1.5E3 + x;\n"
+        "    writeln('ab', x..y)\n"
+        "end.\n"sv;
+    auto const source_string = std::string{ source };
+    auto const offset_of = [&](std::string_view const needle) {
+        return source.find(needle);
+    };
+
+    // Every single-character insertion and deletion. Apostrophes are only inserted below, since they could form the
+    // invalid empty string `''`.
+    for (auto offset = usize{ 0 }; offset <= source.size(); ++offset) {
+        for (auto const inserted : { ""sv, "a"sv, "1"sv, " "sv, "."sv, "{"sv, "}"sv, "*"sv, ")"sv }) {
+            expect_relex_matches_tokenize(source_string, SourceEdit{ offset, 0, inserted });
+        }
+        if (offset < source.size()) {
+            expect_relex_matches_tokenize(source_string, SourceEdit{ offset, 1, ""sv });
+        }
+    }
+
+    // Opening and closing comments and strings.
+    expect_relex_matches_tokenize(source_string, SourceEdit{ offset_of("begin"), 0, "{"sv });
+    expect_relex_matches_tokenize(source_string, SourceEdit{ offset_of("begin"), 0, "(*"sv });
+    expect_relex_matches_tokenize(source_string, SourceEdit{ offset_of("{ comment }"), 1, ""sv });
+    expect_relex_matches_tokenize(source_string, SourceEdit{ offset_of(" comment *)"), 0, "*)"sv });
+    expect_relex_matches_tokenize(source_string, SourceEdit{ offset_of("y: real"), 0, "} {"sv });
+    expect_relex_matches_tokenize(source_string, SourceEdit{ offset_of("ab'"), 2, "it''s"sv });
+    expect_relex_matches_tokenize(source_string, SourceEdit{ offset_of("ab'"), 0, "x', 'y"sv });
+    expect_relex_matches_tokenize(source_string, SourceEdit{ offset_of("x := 42"), 0, "'"sv });
+    expect_relex_matches_tokenize(source_string, SourceEdit{ offset_of("42;"), 0, "'"sv });
+
+    // Larger edits, including replacing everything.
+    expect_relex_matches_tokenize(source_string, SourceEdit{ offset_of("begin"), 10, "begin\n  z := 'x'; "sv });
+    expect_relex_matches_tokenize(source_string, SourceEdit{ 0, source.size(), "begin end."sv });
+    expect_relex_matches_tokenize("", SourceEdit{ 0, 0, "x := 1"sv });
+}
+
+TEST(LexerTests, Relex_OnlyRelexesAroundTheEdit) {
+    auto source = std::string{};
+    for (auto i = 0; i < 1000; ++i) {
+        source += std::format("x := {} + 'text{}';\n", i, i);
+    }
+    auto const previous = tokenize(std::make_shared<SourceFile const>("test.pas", source));
+    auto const num_literals = previous.interner()->literals().size();
+
+    auto const edit = SourceEdit{ source.find("500 "), 3, "12345"sv };
+    auto const tokens = relex(previous, edit);
+    ASSERT_EQ(tokens.size(), previous.size());
+    // Re-lexing the whole source would have added a value for every number literal.
+    EXPECT_LE(tokens.interner()->literals().size(), num_literals + 2);
+    auto const token = tokens.at(6 * 500 + 2);
+    EXPECT_EQ(token.offset(), edit.offset);
+    EXPECT_EQ(tokens.interner()->literals().integer(token.literal()), 12345);
+    EXPECT_EQ(tokens.offset(tokens.size() - 1), previous.offset(previous.size() - 1) + 2);
+}
+
+#if PASC2K_EXCEPTIONS
+TEST(LexerTests, Relex_EditOutOfRange_Throws) {
+    auto const previous = tokenize(std::make_shared<SourceFile const>("test.pas", "x := 1"));
+    EXPECT_THROW(std::ignore = relex(previous, SourceEdit{ 7, 0, ""sv }), std::out_of_range);
+    EXPECT_THROW(std::ignore = relex(previous, SourceEdit{ 3, 4, ""sv }), std::out_of_range);
+}
+
+static TokenBuffer tokenize(std::string_view const source, Utf8Mode const utf8_mode) {
+    auto const file = std::make_shared<SourceFile const>("test.pas", source);
+    return tokenize(file, std::make_shared<Interner>(), LexerOptions{ utf8_mode });
+}
+
+TEST(LexerTests, Utf8InComments_IsValidatedWhenEnabled) {
+    auto const tokens = tokenize("{ Jürgen Müßig 🦀 } x (* Ørsted, 東京 *)"sv, Utf8Mode::Comments);
+    ASSERT_EQ(tokens.size(), 2);
+    EXPECT_EQ(tokens.at(0).lexeme(), "x");
+    EXPECT_EQ(tokens.at(1).type(), TokenType::EndOfFile);
+
+    // Stray continuation byte, overlong encodings, surrogate, beyond U+10FFFF, invalid lead byte, truncated sequences.
+    for (auto const invalid : { "\x80"sv,
+                                "\xC0\x80"sv,
+                                "\xE0\x80\x80"sv,
+                                "\xF0\x80\x80\x80"sv,
+                                "\xED\xA0\x80"sv,
+                                "\xF4\x90\x80\x80"sv,
+                                "\xFF"sv,
+                                "\xC3"sv,
+                                "\xE2\x82"sv,
+                                "\xF0\x9F\xA6"sv }) {
+        // Different amounts of padding move the sequence across the blocks of the vectorized scanners.
+        for (auto const padding : { usize{ 0 }, usize{ 13 }, usize{ 31 }, usize{ 70 } }) {
+            auto const source = std::format("{{ {}ä{} }}", std::string(padding, 'a'), invalid);
+            EXPECT_NO_THROW(std::ignore = tokenize(source, Utf8Mode::Off));
+            EXPECT_THROW(
+                {
+                    try {
+                        std::ignore = tokenize(source, Utf8Mode::Comments);
+                    } catch (InvalidUtf8 const& e) {
+                        EXPECT_EQ(e.source_location().text(), invalid.substr(0, 1));
+                        // The umlaut is a single column.
+                        EXPECT_EQ(e.source_location().position().start_column, padding + 4);
+                        throw;
+                    }
+                },
+                InvalidUtf8
+            ) << padding;
+        }
+    }
+}
+
+TEST(LexerTests, Utf8InStrings_IsOnlyAcceptedWhenEnabled) {
+    static constexpr auto source = "'Grüße' 'ä' 'it''s 🦀'"sv;
+    EXPECT_THROW(std::ignore = tokenize(source, Utf8Mode::Comments), UnexpectedCharacter);
+
+    auto const tokens = tokenize(source, Utf8Mode::CommentsAndStrings);
+    ASSERT_EQ(tokens.size(), 4);
+    auto const& literals = tokens.interner()->literals();
+    EXPECT_EQ(tokens.type(0), TokenType::StringValue);
+    EXPECT_EQ(literals.string(tokens.literal(0)), "Grüße");
+    EXPECT_EQ(tokens.type(1), TokenType::StringValue);
+    EXPECT_EQ(literals.string(tokens.literal(1)), "ä");
+    EXPECT_EQ(literals.string(tokens.literal(2)), "it's 🦀");
+
+    EXPECT_THROW(std::ignore = tokenize("'\xC3'"sv, Utf8Mode::CommentsAndStrings), InvalidUtf8);
+    EXPECT_THROW(std::ignore = tokenize("äx"sv, Utf8Mode::CommentsAndStrings), NonAsciiCharacter);
+}
+
+TEST(LexerTests, Columns_CountCodePoints) {
+    static constexpr auto source = "x { äöü 🦀 } !"sv;
+    for (auto const utf8_mode : { Utf8Mode::Off, Utf8Mode::Comments }) {
+        try {
+            std::ignore = tokenize(source, utf8_mode);
+            FAIL();
+        } catch (UnexpectedCharacter const& e) {
+            EXPECT_EQ(e.source_location().text(), "!");
+            EXPECT_EQ(e.source_location().position().start_column, 13);
+        }
+    }
+}
+#endif
+
+static void expect_try_tokenize_error(
+    Diagnostics& diagnostics,
+    std::string_view const source,
+    DiagnosticKind const kind,
+    std::string_view const message,
+    usize const column
+) {
+    auto const tokens = try_tokenize(diagnostics, std::make_shared<SourceFile const>("test.pas", source));
+    ASSERT_FALSE(tokens.has_value()) << source;
+    auto const& error = diagnostics[tokens.error()];
+    EXPECT_EQ(error.kind(), kind) << source;
+    EXPECT_EQ(error.message(), message) << source;
+    EXPECT_EQ(error.source_location().position().start_column, column) << source;
+}
+
+TEST(LexerTests, TryTokenize_ReportsErrorsWithoutThrowing) {
+    auto diagnostics = Diagnostics{ 4 };
+    expect_try_tokenize_error(diagnostics, "🦀"sv, DiagnosticKind::NonAsciiCharacter, "Non-ASCII character", 1);
+    expect_try_tokenize_error(
+        diagnostics,
+        "x := !"sv,
+        DiagnosticKind::UnexpectedCharacter,
+        "Unexpected character: Got '!', expected number, word symbol, or identifier",
+        6
+    );
+    expect_try_tokenize_error(
+        diagnostics,
+        "1e"sv,
+        DiagnosticKind::UnexpectedCharacter,
+        "Unexpected character: Got non-printable character #0, expected digit",
+        3
+    );
+    expect_try_tokenize_error(diagnostics, "x { abc"sv, DiagnosticKind::UnterminatedComment, "Unterminated comment", 8);
+    EXPECT_EQ(diagnostics.size(), 4);
+    EXPECT_TRUE(diagnostics.notes(DiagnosticId{ 0 }).empty());
+
+    diagnostics.clear();
+    EXPECT_TRUE(diagnostics.empty());
+    auto const file = std::make_shared<SourceFile const>("test.pas", "x { äöü 🦀 } !"sv);
+    auto const options = LexerOptions{ Utf8Mode::Comments };
+    auto const tokens = try_tokenize(diagnostics, file, std::make_shared<Interner>(), options);
+    ASSERT_FALSE(tokens.has_value());
+    EXPECT_EQ(tokens.error(), DiagnosticId{ 0 });
+    EXPECT_EQ(diagnostics[tokens.error()].source_location().position().start_column, 13);
+
+    auto const valid = try_tokenize(diagnostics, std::make_shared<SourceFile const>("test.pas", "x := 1"sv));
+    ASSERT_TRUE(valid.has_value());
+    EXPECT_EQ(valid->size(), 4);
+    EXPECT_EQ(diagnostics.size(), 1);
+}
+
+TEST(LexerTests, TokenStream_PeekOrEnd_StopsAtError) {
+    auto stream = TokenStream{ "test.pas", "a ! b" };
+    EXPECT_EQ(stream.peek_or_end().type(), TokenType::Identifier);
+    EXPECT_FALSE(stream.error().has_value());
+    EXPECT_EQ(stream.peek_or_end(1).type(), TokenType::EndOfFile);
+    ASSERT_TRUE(stream.error().has_value());
+    EXPECT_EQ(stream.error()->kind(), DiagnosticKind::UnexpectedCharacter);
+    EXPECT_EQ(stream.error()->source_location().text(), "!");
+    stream.advance();
+    stream.advance();
+    EXPECT_EQ(stream.peek_or_end().type(), TokenType::EndOfFile);
+}
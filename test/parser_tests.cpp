@@ -1,7 +1,13 @@
+#include <algorithm>
+#include <cstring>
 #include <gtest/gtest.h>
 #include <lexer/lexer.hpp>
+#include <memory_resource>
 #include <parser/block.hpp>
 #include <parser/parser.hpp>
+#include <string>
+#include <utility>
+#include <vector>
 
 [[nodiscard]] static Ast parse(std::string_view const source) {
     auto tokens = tokenize("test", source);
@@ -12,3 +18,344 @@
 TEST(ParserTests, Test) {
     auto ast = parse("");
 }
+
+TEST(ParserTests, TokenStream_ProducesSameAstAsTokenBuffer) {
+    static constexpr auto source = "label 1, 2; const a = -3; b = 'xy'; type t = array[1..10] of ^integer; var x, y: t;";
+    auto const streamed = parse(TokenStream{ "test", source });
+    auto const buffered = parse(source);
+    EXPECT_EQ(streamed.block().source_location().position(), buffered.block().source_location().position());
+    EXPECT_EQ(streamed.block().source_location().text(), buffered.block().source_location().text());
+}
+
+#if PASC2K_EXCEPTIONS
+TEST(ParserTests, TokenStream_ReportsParserErrorBeforeLaterLexerError) {
+    static constexpr auto source = "const = 1; !";
+    EXPECT_THROW(std::ignore = parse(TokenStream{ "test", source }), ParserError);
+    EXPECT_THROW(std::ignore = parse(source), UnexpectedCharacter);
+}
+#endif
+
+TEST(ParserTests, TryParse_ReportsErrorWithNotes) {
+    auto diagnostics = Diagnostics{};
+    auto const ast = try_parse(diagnostics, TokenStream{ "test", "type t = ^;" });
+    ASSERT_FALSE(ast.has_value());
+    EXPECT_EQ(diagnostics.size(), 1);
+    auto const& error = diagnostics[ast.error()];
+    EXPECT_EQ(error.kind(), DiagnosticKind::ParserError);
+    EXPECT_EQ(error.message(), "Expected type reference after `^`.");
+    EXPECT_EQ(error.source_location().text(), "^");
+
+    auto const notes = diagnostics.notes(ast.error());
+    ASSERT_EQ(notes.size(), 2);
+    EXPECT_EQ(notes[0].message(), "In type definitions starting from here.");
+    EXPECT_EQ(notes[0].source_location().text(), "type");
+    EXPECT_EQ(notes[1].message(), "In type definition of `t`.");
+    EXPECT_EQ(notes[1].source_location().text(), "t");
+}
+
+TEST(ParserTests, TryParse_TokenStreamReportsParserErrorBeforeLaterLexerError) {
+    static constexpr auto source = "const = 1; !";
+    auto diagnostics = Diagnostics{};
+    auto const streamed = try_parse(diagnostics, TokenStream{ "test", source });
+    ASSERT_FALSE(streamed.has_value());
+    EXPECT_EQ(diagnostics[streamed.error()].kind(), DiagnosticKind::ParserError);
+
+    // The buffer is lexed completely before parsing, so its lexer error comes first.
+    auto tokens = try_tokenize(diagnostics, std::make_shared<SourceFile const>("test", source));
+    ASSERT_FALSE(tokens.has_value());
+    EXPECT_EQ(diagnostics[tokens.error()].kind(), DiagnosticKind::UnexpectedCharacter);
+    EXPECT_EQ(diagnostics.size(), 2);
+}
+
+TEST(ParserTests, TryParse_ReportsLiteralsOutOfRange) {
+    auto diagnostics = Diagnostics{};
+    auto const integer = try_parse(diagnostics, TokenStream{ "test", "const big = 9223372036854775808;" });
+    ASSERT_FALSE(integer.has_value());
+    EXPECT_EQ(diagnostics[integer.error()].message(), "Integer literal out of range.");
+    EXPECT_EQ(diagnostics.notes(integer.error()).size(), 1);
+
+    auto const real = try_parse(diagnostics, tokenize("test", "const huge = 1e400;"));
+    ASSERT_FALSE(real.has_value());
+    EXPECT_EQ(diagnostics[real.error()].message(), "Real literal out of range.");
+
+    EXPECT_TRUE(try_parse(diagnostics, TokenStream{ "test", "const small = 9223372036854775807;" }).has_value());
+    EXPECT_EQ(diagnostics.size(), 2);
+}
+
+TEST(ParserTests, TypeAlias_SharesSymbolWithDefinition) {
+    auto const ast = parse("type Celsius = integer; var t: CELSIUS;");
+    auto const& type_definition = ast.block().type_definitions()->type_definitions().at(0);
+    auto const& variable_declaration = ast.block().variable_declarations()->declarations().at(0);
+    auto const& alias = dynamic_cast<TypeAliasDefinition const&>(variable_declaration.type());
+
+    EXPECT_EQ(alias.referenced_type().symbol(), type_definition.identifier().symbol());
+    EXPECT_NE(variable_declaration.identifiers().identifiers().at(0).symbol(), type_definition.identifier().symbol());
+    EXPECT_EQ(ast.interner().spelling(alias.referenced_type().symbol()), "celsius");
+}
+
+TEST(ParserTests, AstNodes_SpanTheirTokens) {
+    static constexpr auto source =
+        std::string_view{ "type r = packed record x: char; case integer of 1: () end; var v, w: -1..+n; s: r;" };
+    auto const ast = parse(source);
+    auto const& type_definitions = *ast.block().type_definitions();
+    auto const& declarations = ast.block().variable_declarations()->declarations();
+    auto const& subrange = dynamic_cast<SubrangeTypeDefinition const&>(declarations.at(0).type());
+
+    EXPECT_EQ(type_definitions.source_location().text(), "type r = packed record x: char; case integer of 1: () end");
+    EXPECT_EQ(declarations.at(0).source_location().text(), "v, w: -1..+n");
+    EXPECT_EQ(declarations.at(0).identifiers().source_location().text(), "v, w");
+    EXPECT_EQ(subrange.source_location().text(), "-1..+n");
+    EXPECT_EQ(subrange.to()->source_location().text(), "+n");
+    EXPECT_EQ(declarations.at(1).type().source_location().text(), "r");
+    EXPECT_EQ(declarations.at(1).identifiers().identifiers().at(0).token().lexeme(), "s");
+    EXPECT_EQ(ast.block().source_location().text(), source.substr(0, source.size() - 1));
+}
+
+TEST(ParserTests, Ast_AllocatesAllNodesFromItsArena) {
+    static constexpr auto source =
+        "label 1, 2; const a = -3; b = 'xy'; "
+        "type e = (red, green); r = packed record x, y: integer; case t: e of red, green: (z: ^r) end; "
+        "f = file of array[1..10, char] of set of e; var x, y: r;";
+    // Containers that do not use the arena would fall back to the default resource.
+    auto const previous_resource = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+    auto const ast = parse(source);
+    std::pmr::set_default_resource(previous_resource);
+
+    auto const& type_definitions = ast.block().type_definitions()->type_definitions();
+    ASSERT_EQ(type_definitions.size(), 3);
+    EXPECT_EQ(type_definitions.get_allocator().resource(), &ast.arena());
+    EXPECT_GT(ast.arena().bytes_allocated(), 3 * sizeof(TypeDefinition));
+}
+
+TEST(ParserTests, FlatAst_PrintsSameTreeAsAst) {
+    static constexpr auto source =
+        "label 1, 2; const a = -3; b = 'xy'; c = 'z'; d = +2.5; e = - a; "
+        "type e = (red, green); r = packed record x, y: integer; case t: e of red, green: (z: ^r) end; "
+        "f = file of array[1..10, char] of set of e; p = ^boolean; s = -5..+5; var x, y: r; z: real;";
+    testing::internal::CaptureStdout();
+    parse(source).print();
+    auto const tree = testing::internal::GetCapturedStdout();
+
+    testing::internal::CaptureStdout();
+    parse_flat(TokenStream{ "test", source }).print();
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), tree);
+}
+
+TEST(ParserTests, NodeStatistics_CountSameKindsForBothAsts) {
+    static constexpr auto source =
+        "label 1, 2; const a = -3; b = 'xy'; "
+        "type e = (red, green); r = packed record x, y: integer; case t: e of red, green: (z: ^r) end; "
+        "f = file of array[1..10, char] of set of e; var x, y: r;";
+    auto const ast = parse(source);
+    auto const flat_ast = parse_flat(tokenize("test", source));
+    auto const counts = [](NodeStatistics const& statistics) {
+        auto result = std::vector<std::pair<std::string_view, u64>>{};
+        for (auto const& entry : statistics.entries()) {
+            result.emplace_back(entry.kind, entry.num_nodes);
+        }
+        std::ranges::sort(result);
+        return result;
+    };
+    auto const statistics = ast.node_statistics();
+    auto const flat_statistics = flat_ast.node_statistics();
+    EXPECT_EQ(counts(statistics), counts(flat_statistics));
+
+    auto const identifiers = std::ranges::find(statistics.entries(), std::string_view{ "Identifier" }, &NodeStatistics::Entry::kind);
+    ASSERT_NE(identifiers, statistics.entries().end());
+    EXPECT_GT(identifiers->num_nodes, 0);
+    EXPECT_EQ(identifiers->num_bytes, identifiers->num_nodes * sizeof(Identifier));
+    auto num_bytes = u64{ 0 };
+    for (auto const& entry : flat_statistics.entries()) {
+        num_bytes += entry.num_bytes;
+    }
+    EXPECT_EQ(num_bytes, flat_ast.memory_usage());
+}
+
+TEST(ParserTests, FlatAst_StoresNodesInPostOrder) {
+    static constexpr auto source =
+        std::string_view{ "const n = - {sign} limit; type t = packed array [boolean] of real;" };
+    auto const ast = parse_flat(tokenize("test", source));
+    ASSERT_EQ(ast.kind(ast.root()), NodeKind::Block);
+    EXPECT_EQ(ast.subtree_size(ast.root()), ast.size());
+    EXPECT_EQ(ast.source_location(ast.root()).text(), source.substr(0, source.size() - 1));
+
+    auto const sections = ast.reverse_children(ast.root());
+    auto const definitions = std::vector(sections.begin(), sections.end());
+    ASSERT_EQ(definitions.size(), 2);
+    EXPECT_EQ(ast.kind(definitions[0]), NodeKind::TypeDefinitions);
+    EXPECT_EQ(ast.kind(definitions[1]), NodeKind::ConstantDefinitions);
+
+    for (auto i = usize{ 0 }; i < ast.size(); ++i) {
+        auto const node = NodeIndex{ static_cast<u32>(i) };
+        for (auto const child : ast.reverse_children(node)) {
+            EXPECT_LT(child, node);
+            EXPECT_GE(static_cast<usize>(child) + 1, static_cast<usize>(node) + 1 - ast.subtree_size(node));
+        }
+    }
+
+    auto const kinds = ast.kinds();
+    auto const find = [&](NodeKind const kind) {
+        return NodeIndex{ static_cast<u32>(std::ranges::find(kinds, kind) - kinds.begin()) };
+    };
+    auto const reference = find(NodeKind::ConstantReference);
+    EXPECT_EQ(ast.sign(reference), "-");
+    EXPECT_EQ(ast.referenced_constant(reference), "limit");
+    EXPECT_EQ(ast.interner().spelling(ast.symbol(reference)), "limit");
+
+    auto const structured = find(NodeKind::StructuredTypeDefinition);
+    EXPECT_EQ(ast.packed(structured), "packed");
+    EXPECT_EQ(ast.source_location(structured).text(), "packed array [boolean] of real");
+    EXPECT_EQ(std::ranges::count_if(kinds, is_leaf), 5);
+}
+
+TEST(ParserTests, ParseWithRecovery_ReportsAllSyntaxErrors) {
+    static constexpr auto source = "const a = ; b = 5; type t = ^; u = integer; var x: array [1..] of u; y: t;";
+    auto diagnostics = Diagnostics{};
+    auto const ast = parse_with_recovery(diagnostics, TokenStream{ "test", source });
+    ASSERT_EQ(diagnostics.size(), 3);
+    EXPECT_EQ(diagnostics[DiagnosticId{ 0 }].message(), "Expected constant value in constant definition.");
+    EXPECT_EQ(diagnostics[DiagnosticId{ 1 }].message(), "Expected type reference after `^`.");
+    EXPECT_EQ(diagnostics[DiagnosticId{ 2 }].message(), "Expected constant value in constant definition.");
+    EXPECT_EQ(diagnostics.notes(DiagnosticId{ 1 }).size(), 2);
+
+    auto const& constants = ast.block().constant_definitions()->constant_definitions();
+    ASSERT_EQ(constants.size(), 2);
+    EXPECT_NE(dynamic_cast<ErrorConstant const*>(&constants.at(0).constant()), nullptr);
+    EXPECT_NE(dynamic_cast<IntegerConstant const*>(&constants.at(1).constant()), nullptr);
+    auto const& types = ast.block().type_definitions()->type_definitions();
+    ASSERT_EQ(types.size(), 2);
+    EXPECT_EQ(types.at(0).type().source_location().text(), "^");
+    EXPECT_NE(dynamic_cast<ErrorType const*>(&types.at(0).type()), nullptr);
+    EXPECT_EQ(ast.block().variable_declarations()->declarations().size(), 2);
+
+    testing::internal::CaptureStdout();
+    ast.print();
+    auto const tree = testing::internal::GetCapturedStdout();
+    testing::internal::CaptureStdout();
+    parse_flat_with_recovery(diagnostics, tokenize("test", source)).print();
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), tree);
+    EXPECT_EQ(diagnostics.size(), 6);
+}
+
+TEST(ParserTests, ParseWithRecovery_StopsAfterMaxErrors) {
+    static constexpr auto source = "const a = ; b = ; c = ; d = ;";
+    auto diagnostics = Diagnostics{};
+    auto const ast = parse_with_recovery(diagnostics, TokenStream{ "test", source }, 2);
+    EXPECT_EQ(diagnostics.size(), 2);
+    EXPECT_TRUE(ast.block().constant_definitions().has_value());
+
+    // A single error reports the same diagnostic as `try_parse()`.
+    auto const single = try_parse(diagnostics, TokenStream{ "test", source });
+    ASSERT_FALSE(single.has_value());
+    EXPECT_EQ(diagnostics[single.error()].message(), diagnostics[DiagnosticId{ 0 }].message());
+}
+
+[[nodiscard]] static std::string dump(auto const& ast, DumpFormat const format) {
+    auto result = std::string{};
+    auto sink = StringSink{ result };
+    ast.dump(sink, format);
+    return result;
+}
+
+TEST(ParserTests, AstDumper_WritesAllFormatsForBothAsts) {
+    static constexpr auto source = "const a = -3; s = 'x\"y'; type t = array [1..a] of real; var v: t;";
+    auto const ast = parse(source);
+    auto const flat_ast = parse_flat(tokenize("test", source));
+    testing::internal::CaptureStdout();
+    ast.print();
+    EXPECT_EQ(dump(ast, DumpFormat::Tree), testing::internal::GetCapturedStdout());
+    for (auto const format : { DumpFormat::Tree, DumpFormat::Json, DumpFormat::Binary }) {
+        EXPECT_EQ(dump(ast, format), dump(flat_ast, format));
+    }
+
+    auto const json = dump(parse("var s: (a);"), DumpFormat::Json);
+    EXPECT_EQ(
+        json,
+        R"({"file":"test","root":{"kind":"Block","offset":0,"length":10,"begin":[1,1],"end":[1,11],"values":[],"children":[)"
+        R"({"kind":"VariableDeclarations","offset":0,"length":10,"begin":[1,1],"end":[1,11],"values":[],"children":[)"
+        R"({"kind":"VariableDeclaration","offset":4,"length":6,"begin":[1,5],"end":[1,11],"values":[],"children":[)"
+        R"({"kind":"IdentifierList","offset":4,"length":1,"begin":[1,5],"end":[1,6],"values":[],"children":[)"
+        R"({"kind":"Identifier","offset":4,"length":1,"begin":[1,5],"end":[1,6],"values":["s"],"children":[]}]},)"
+        R"({"kind":"EnumeratedTypeDefinition","offset":7,"length":3,"begin":[1,8],"end":[1,11],"values":[],"children":[)"
+        R"({"kind":"IdentifierList","offset":8,"length":1,"begin":[1,9],"end":[1,10],"values":[],"children":[)"
+        R"({"kind":"Identifier","offset":8,"length":1,"begin":[1,9],"end":[1,10],"values":["a"],"children":[]}]}]}]}]}]}})"
+        "\n"
+    );
+    EXPECT_NE(dump(ast, DumpFormat::Json).find(R"("values":["x\"y"])"), std::string::npos);
+
+    auto const binary = dump(parse("label 7;"), DumpFormat::Binary);
+    using namespace std::string_literals;
+    EXPECT_EQ(
+        binary,
+        "P2KD\x01\x04test"s                                 // Header.
+        "\x01\x05" "Block\x00\x07\x00"s                     // Block, offset 0, length 7, no values.
+        "\x02\x11LabelDeclarations\x00\x07\x00"s            // LabelDeclarations
+        "\x03\x10LabelDeclaration\x06\x01\x00"s             // LabelDeclaration, offset 6, length 1
+        "\x04\x0EIntegerLiteral\x06\x01i\x0E\x00\x00"s      // IntegerLiteral with value 7, no children
+        "\x00\x00\x00"s                                     // End of the children of the remaining nodes.
+    );
+}
+
+TEST(ParserTests, FlatAst_SaveAndLoadRoundTrip) {
+    static constexpr auto source = "label 7; const a = -3.5; s = 'xy'; c = 'z'; type t = packed array [1..a] of ^x;";
+    auto const ast = parse_flat(tokenize("test", source));
+    auto file = std::string{};
+    auto sink = StringSink{ file };
+    ast.save(sink);
+    EXPECT_EQ(file.substr(0, 4), "P2KA");
+    EXPECT_EQ(file.size() % 8, 0);
+
+    auto const loaded = FlatAst::load(SourceBuffer::from_string(file));
+    ASSERT_EQ(loaded.size(), ast.size());
+    EXPECT_TRUE(std::ranges::equal(loaded.kinds(), ast.kinds()));
+    EXPECT_EQ(loaded.interner().size(), ast.interner().size());
+    EXPECT_EQ(loaded.interner().literals().size(), ast.interner().literals().size());
+    for (auto const format : { DumpFormat::Tree, DumpFormat::Json, DumpFormat::Binary }) {
+        EXPECT_EQ(dump(loaded, format), dump(ast, format));
+    }
+}
+
+#if PASC2K_EXCEPTIONS
+TEST(ParserTests, FlatAst_LoadRejectsInvalidFiles) {
+    auto file = std::string{};
+    auto sink = StringSink{ file };
+    parse_flat(tokenize("test", "var x: integer;")).save(sink);
+
+    auto const truncated = file.substr(0, file.size() - 8);
+    EXPECT_THROW(std::ignore = FlatAst::load(SourceBuffer::from_string(truncated)), std::runtime_error);
+    auto wrong_version = file;
+    wrong_version[4] = static_cast<char>(FlatAst::file_version + 1);
+    EXPECT_THROW(std::ignore = FlatAst::load(SourceBuffer::from_string(wrong_version)), std::runtime_error);
+    EXPECT_THROW(std::ignore = FlatAst::load(SourceBuffer::from_string("P2KD")), std::runtime_error);
+}
+
+TEST(ParserTests, FlatAst_LoadRejectsInconsistentNodes) {
+    auto file = std::string{};
+    auto sink = StringSink{ file };
+    // Identifier, IdentifierList, IntegerType, VariableDeclaration, VariableDeclarations, Block.
+    parse_flat(tokenize("test", "var x: integer;")).save(sink);
+    // The offset of a section is stored after the first 24 bytes of the header, in entries of 16 bytes.
+    auto const section_offset = [&](usize const section) {
+        auto offset = u64{ 0 };
+        std::memcpy(&offset, file.data() + 24 + 16 * section, sizeof(offset));
+        return offset;
+    };
+    auto const load_with = [&](u64 const offset, u32 const value) {
+        auto changed = file;
+        std::memcpy(changed.data() + offset, &value, sizeof(value));
+        return FlatAst::load(SourceBuffer::from_string(std::move(changed)));
+    };
+    auto const spans = section_offset(3);
+    auto const data = section_offset(4);
+
+    EXPECT_NO_THROW(std::ignore = load_with(data + 4 * 3, 4));
+    // A span that ends after the source.
+    EXPECT_THROW(std::ignore = load_with(spans, 1000), std::runtime_error);
+    // A subtree that starts before the first node.
+    EXPECT_THROW(std::ignore = load_with(data + 4 * 1, 3), std::runtime_error);
+    // A subtree that starts within the subtree of one of its children.
+    EXPECT_THROW(std::ignore = load_with(data + 4 * 3, 3), std::runtime_error);
+    // An identifier whose symbol does not exist.
+    EXPECT_THROW(std::ignore = load_with(data, 1000), std::runtime_error);
+}
+#endif
@@ -0,0 +1,149 @@
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <memory>
+#include <profiling/allocation_counter.hpp>
+#include <profiling/profiler.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tracing/trace.hpp>
+
+TEST(ProfilerTests, DisabledProfilerRecordsNothing) {
+    auto profiler = Profiler{ Profiler::Options{} };
+    {
+        auto phase = profiler.measure("parse");
+        phase.count_tokens(42);
+    }
+    profiler.add_structure("tokens", 0, 1, 2);
+    EXPECT_TRUE(profiler.phases().empty());
+    EXPECT_TRUE(profiler.structures().empty());
+}
+
+TEST(ProfilerTests, RecordsNestedPhasesInTheOrderInWhichTheyStarted) {
+    auto profiler = Profiler{ Profiler::Options{ .time = true } };
+    {
+        auto const total = profiler.measure("total");
+        {
+            auto lex = profiler.measure("lex");
+            lex.count_bytes(100);
+            lex.count_tokens(20);
+        }
+        auto parse = profiler.measure("parse");
+        parse.count_nodes(7);
+    }
+    auto const phases = profiler.phases();
+    ASSERT_EQ(phases.size(), 3);
+    EXPECT_EQ(phases[0].name, "total");
+    EXPECT_EQ(phases[0].depth, 0);
+    EXPECT_EQ(phases[1].name, "lex");
+    EXPECT_EQ(phases[1].depth, 1);
+    EXPECT_EQ(phases[1].num_bytes, 100);
+    EXPECT_EQ(phases[1].num_tokens, 20);
+    EXPECT_EQ(phases[2].name, "parse");
+    EXPECT_EQ(phases[2].depth, 1);
+    EXPECT_EQ(phases[2].num_nodes, 7);
+    EXPECT_GE(phases[0].wall_time, phases[1].wall_time);
+}
+
+TEST(ProfilerTests, ReportIndentsNestedPhases) {
+    auto profiler = Profiler{ Profiler::Options{ .time = true } };
+    {
+        auto const total = profiler.measure("total");
+        auto const dump = profiler.measure("dump");
+    }
+    auto stream = std::ostringstream{};
+    profiler.format_report_to(stream);
+    auto const report = stream.str();
+    EXPECT_TRUE(report.starts_with("Phase"));
+    EXPECT_NE(report.find("\ntotal "), std::string::npos);
+    EXPECT_NE(report.find("\n  dump "), std::string::npos);
+}
+
+TEST(ProfilerTests, CountsAllocationsAndPeaksOfNestedPhases) {
+    // Allocations that do not escape could be optimized away.
+    static char* volatile escaped = nullptr;
+    auto profiler = Profiler{ Profiler::Options{ .memory = true } };
+    auto kept = std::unique_ptr<char[]>{};
+    {
+        auto const outer = profiler.measure("outer");
+        {
+            auto const inner = profiler.measure("inner");
+            auto const temporary = std::make_unique<char[]>(1 << 20);
+            escaped = temporary.get();
+            kept = std::make_unique<char[]>(1000);
+            escaped = kept.get();
+        }
+        auto const last = profiler.measure("last");
+    }
+    auto const phases = profiler.phases();
+    ASSERT_EQ(phases.size(), 3);
+    auto const& outer = phases[0];
+    auto const& inner = phases[1];
+    auto const& last = phases[2];
+    EXPECT_GE(inner.num_allocations, 2);
+    EXPECT_GE(inner.peak_bytes, inner.live_bytes_before + (1 << 20) + 1000);
+    EXPECT_GE(inner.live_bytes_after, inner.live_bytes_before + 1000);
+    EXPECT_LT(inner.live_bytes_after, inner.live_bytes_before + (1 << 20));
+    // The peak of the outer phase includes the peak of the inner one, but the later phase does not.
+    EXPECT_GE(outer.peak_bytes, inner.peak_bytes);
+    EXPECT_LT(last.peak_bytes, inner.peak_bytes);
+    EXPECT_LE(allocation_counts().live_bytes, allocation_counts().peak_bytes);
+}
+
+TEST(ProfilerTests, MemoryReportContainsStructures) {
+    auto profiler = Profiler{ Profiler::Options{ .memory = true } };
+    {
+        auto const total = profiler.measure("total");
+    }
+    profiler.add_structure("tokens", 0, 10, 130);
+    profiler.add_structure("as Token objects", 1, 10, 200 * 1024);
+    auto stream = std::ostringstream{};
+    profiler.format_report_to(stream);
+    auto const report = stream.str();
+    EXPECT_TRUE(report.starts_with("Phase"));
+    EXPECT_EQ(report.find("Wall"), std::string::npos);
+    EXPECT_NE(report.find("extended alignment"), std::string::npos);
+    EXPECT_NE(report.find("\ntokens "), std::string::npos);
+    EXPECT_NE(report.find("130 B"), std::string::npos);
+    EXPECT_NE(report.find("\n  as Token objects "), std::string::npos);
+    EXPECT_NE(report.find("200.00 KiB"), std::string::npos);
+}
+
+TEST(TraceTests, WritesCompleteEventsOfAllThreads) {
+    auto const path = std::filesystem::temp_directory_path() / "pasc2k_trace_tests.json";
+    {
+        auto const before = TraceScope{ "before" };
+    }
+    start_tracing();
+    EXPECT_TRUE(is_tracing());
+    {
+        auto const outer = TraceScope{ "compile", "a/very/long/directory/name/that/does/not/fit/block.pas" };
+        auto profiler = Profiler{ Profiler::Options{} };
+        auto const phase = profiler.measure("parse");
+        std::jthread{ [] { auto const inner = TraceScope{ "lex \"chunk\"" }; } }.join();
+        auto const multibyte = TraceScope{ "multibyte", "\xC3\xBC" "123456789012345678901234567890123456789" };
+    }
+    write_trace(path);
+    EXPECT_FALSE(is_tracing());
+
+    auto file = std::ifstream{ path, std::ios::binary };
+    auto const json = std::string{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    file.close();
+    std::filesystem::remove(path);
+    EXPECT_TRUE(json.starts_with(R"({"displayTimeUnit":"ms","traceEvents":[)"));
+    EXPECT_TRUE(json.ends_with(R"(],"otherData":{"dropped_events":0}})" "\n"));
+    EXPECT_EQ(json.find(R"("name":"before")"), std::string::npos);
+    EXPECT_NE(json.find(R"("name":"compile","cat":"pasc2k","ph":"X")"), std::string::npos);
+    // Details keep their end.
+    EXPECT_NE(json.find(R"("args":{"detail":"rectory/name/that/does/not/fit/block.pas"})"), std::string::npos);
+    EXPECT_EQ(json.find("a/very"), std::string::npos);
+    // Truncated details do not start in the middle of a character.
+    EXPECT_NE(json.find(R"("args":{"detail":"123456789012345678901234567890123456789"})"), std::string::npos);
+    // Phases of a disabled profiler are traced anyway.
+    EXPECT_NE(json.find(R"("name":"parse")"), std::string::npos);
+    EXPECT_NE(json.find(R"("name":"lex \"chunk\"")"), std::string::npos);
+    EXPECT_NE(json.find(R"("args":{"name":"main"})"), std::string::npos);
+    EXPECT_NE(json.find(R"("args":{"name":"worker )"), std::string::npos);
+}